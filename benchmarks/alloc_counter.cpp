@@ -0,0 +1,94 @@
+// Counts every heap allocation of the process, C++ and C alike, for bench::alloc_counts.
+// wampproto allocates with malloc, so on glibc the malloc family itself is replaced and
+// forwards to glibc's implementation; operator new ends up there too. Elsewhere only
+// operator new is counted. XCONN_ALLOC_ACCOUNTING builds of the library already install
+// such hooks, and their totals are reported instead.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+#include "xconn_cpp/alloc_accounting.hpp"
+
+#include "bench.hpp"
+
+#if defined(XCONN_ALLOC_ACCOUNTING)
+
+namespace {
+
+const bool installed = [] {
+    xconn::bench::alloc_counts = [] {
+        xconn::AllocStats stats = xconn::process_alloc_stats();
+        return xconn::bench::AllocCounts{stats.allocations, stats.bytes};
+    };
+    return true;
+}();
+
+}  // namespace
+
+#else
+
+namespace {
+
+std::atomic<uint64_t> allocations{0};
+std::atomic<uint64_t> allocated_bytes{0};
+
+void count(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+xconn::bench::AllocCounts current_counts() {
+    return {allocations.load(std::memory_order_relaxed), allocated_bytes.load(std::memory_order_relaxed)};
+}
+
+const bool installed = [] {
+    xconn::bench::alloc_counts = current_counts;
+    return true;
+}();
+
+}  // namespace
+
+#if defined(__GLIBC__)
+
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void __libc_free(void* pointer);
+
+void* malloc(size_t size) {
+    count(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    count(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    count(size);
+    return __libc_realloc(pointer, size);
+}
+
+void free(void* pointer) { __libc_free(pointer); }
+}
+
+#else
+
+void* operator new(size_t size) {
+    count(size);
+    if (void* pointer = std::malloc(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { std::free(pointer); }
+
+#endif
+
+#endif  // XCONN_ALLOC_ACCOUNTING
@@ -0,0 +1,80 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "xconn_cpp/types.hpp"
+
+namespace xconn::bench {
+
+inline const char* format_name(SerializerType type) {
+    switch (type) {
+        case SerializerType::JSON:
+            return "json";
+        case SerializerType::MSGPACK:
+            return "msgpack";
+        case SerializerType::CBOR:
+            return "cbor";
+    }
+    return "";
+}
+
+// Keeps the compiler from optimizing away a value computed by a benchmark body.
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double ns_per_op = 0;
+    // Heap allocations and allocated bytes per call, when allocations are counted.
+    double allocs_per_op = 0;
+    double bytes_per_op = 0;
+};
+
+struct AllocCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Process-wide allocation totals. Set by alloc_counter.cpp; benchmarks linking it report
+// B/op and allocs/op next to ns/op.
+inline AllocCounts (*alloc_counts)() = nullptr;
+
+// Runs `body` in growing batches until a batch takes at least `budget`, then reports the
+// time per call of that batch.
+template <typename F>
+BenchResult run(const std::string& name, F&& body,
+                std::chrono::nanoseconds budget = std::chrono::milliseconds(200)) {
+    using clock = std::chrono::steady_clock;
+
+    for (uint64_t iterations = 1;; iterations *= 2) {
+        AllocCounts before = alloc_counts ? alloc_counts() : AllocCounts();
+        auto start = clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) body();
+        auto elapsed = clock::now() - start;
+        AllocCounts after = alloc_counts ? alloc_counts() : AllocCounts();
+
+        if (elapsed >= budget || iterations >= (uint64_t{1} << 40)) {
+            BenchResult result{name, iterations,
+                               std::chrono::duration<double, std::nano>(elapsed).count() / double(iterations)};
+            result.allocs_per_op = double(after.allocations - before.allocations) / double(iterations);
+            result.bytes_per_op = double(after.bytes - before.bytes) / double(iterations);
+
+            if (alloc_counts) {
+                std::printf("%-40s %12llu iterations %12.1f ns/op %12.1f B/op %10.2f allocs/op\n", name.c_str(),
+                            static_cast<unsigned long long>(iterations), result.ns_per_op, result.bytes_per_op,
+                            result.allocs_per_op);
+            } else {
+                std::printf("%-40s %12llu iterations %12.1f ns/op\n", name.c_str(),
+                            static_cast<unsigned long long>(iterations), result.ns_per_op);
+            }
+            return result;
+        }
+    }
+}
+
+}  // namespace xconn::bench
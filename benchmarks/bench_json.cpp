@@ -0,0 +1,93 @@
+// JSON throughput of the native encoder and decoder at every SIMD level this CPU supports,
+// next to wampproto's JSON serializer.
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wampproto.h>
+
+#include "xconn_cpp/internal/json_scan.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+#include "bench.hpp"
+
+namespace bench = xconn::bench;
+
+using xconn::SerializerType;
+using xconn::SimdLevel;
+using xconn::WireFrame;
+using xconn::WireWriter;
+
+// A RESULT carrying a few kilobytes of text, with the odd character that needs escaping.
+static xconn::Value build_result() {
+    std::string text;
+    for (int i = 0; i < 64; ++i) text += "sensor reading " + std::to_string(i) + " is within \"normal\" range\n";
+
+    return xconn::make_list({
+        int64_t(50),
+        int64_t(1),
+        xconn::make_dict({}),
+        xconn::make_list({text, text.substr(0, 512), int64_t(42)}),
+        xconn::make_dict({{"description", text}, {"status", "ok"}}),
+    });
+}
+
+static void report(const bench::BenchResult& result, size_t bytes) {
+    std::printf("%-40s %12.1f MB/s\n", "", double(bytes) / result.ns_per_op * 1e3);
+}
+
+int main() {
+    const xconn::Value message = build_result();
+
+    std::vector<uint8_t> encoded;
+    WireWriter(SerializerType::JSON, encoded).write_value(message);
+    std::printf("message size: %zu bytes, best level: %s\n", encoded.size(),
+                xconn::simd_level_name(xconn::json_simd_supported()));
+
+    std::vector<SimdLevel> levels{SimdLevel::Scalar};
+    if (xconn::json_simd_supported() >= SimdLevel::SSE42) levels.push_back(SimdLevel::SSE42);
+    if (xconn::json_simd_supported() >= SimdLevel::AVX2) levels.push_back(SimdLevel::AVX2);
+
+    for (SimdLevel level : levels) {
+        xconn::set_json_simd_level(level);
+        std::string name = xconn::simd_level_name(level);
+
+        std::vector<uint8_t> out;
+        auto encode = bench::run("encode/" + name, [&] {
+            out.clear();
+            WireWriter(SerializerType::JSON, out).write_value(message);
+            bench::do_not_optimize(out);
+        });
+        report(encode, encoded.size());
+
+        // Walks the whole message once, as reading every field would.
+        WireFrame frame(SerializerType::JSON, encoded);
+        auto skip = bench::run("decode/skip/" + name, [&] { bench::do_not_optimize(frame.root().at(4).isValid()); });
+        report(skip, encoded.size());
+
+        auto decode = bench::run("decode/values/" + name, [&] {
+            auto frame = std::make_shared<WireFrame>(SerializerType::JSON, encoded);
+            bench::do_not_optimize(xconn::ResultView(frame).toResult());
+        });
+        report(decode, encoded.size());
+    }
+    xconn::set_json_simd_level(xconn::json_simd_supported());
+
+    Serializer* serializer = json_serializer_new();
+    auto wampproto = bench::run("decode/wampproto", [&] {
+        ::Bytes bytes;
+        bytes.data = encoded.data();
+        bytes.len = encoded.size();
+        Message* msg = serializer->deserialize(serializer, bytes);
+        if (msg) msg->free(msg);
+    });
+    report(wampproto, encoded.size());
+
+    return 0;
+}
@@ -0,0 +1,146 @@
+// Cost of converting Values to and from wampproto and of encoding and decoding a CALL with
+// each serializer, for payload shapes seen in practice. Every line reports heap traffic next
+// to time: B/op and allocs/op count all allocations, wampproto's malloc calls included.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <wampproto.h>
+
+#include "xconn_cpp/internal/types.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+#include "bench.hpp"
+
+namespace bench = xconn::bench;
+
+using xconn::WireFrame;
+using xconn::WireWriter;
+
+struct Shape {
+    std::string name;
+    xconn::List args;
+    xconn::Dict kwargs;
+};
+
+static std::vector<Shape> build_shapes() {
+    std::vector<Shape> shapes;
+
+    shapes.push_back({"scalars", {int64_t(42), 3.5, true, "hello"}, {{"id", int64_t(7)}}});
+
+    xconn::Dict wide;
+    for (int i = 0; i < 64; ++i) wide["field_" + std::to_string(i)] = i % 2 ? xconn::Value(int64_t(i)) : "value";
+    shapes.push_back({"wide_dict", {}, wide});
+
+    xconn::Value nested = int64_t(0);
+    for (int i = 0; i < 32; ++i) {
+        nested = i % 2 ? xconn::Value(xconn::make_list({nested})) : xconn::Value(xconn::make_dict({{"n", nested}}));
+    }
+    shapes.push_back({"deep_nesting", {nested}, {}});
+
+    xconn::Bytes blob(64 * 1024);
+    for (size_t i = 0; i < blob.size(); ++i) blob[i] = uint8_t(i * 31);
+    shapes.push_back({"bytes_64k", {blob}, {}});
+
+    auto ints = std::make_shared<xconn::List>();
+    auto doubles = std::make_shared<xconn::List>();
+    for (int i = 0; i < 1024; ++i) {
+        ints->emplace_back(int64_t(i * 1000));
+        doubles->emplace_back(i * 0.25);
+    }
+    shapes.push_back({"numeric_arrays", {ints, doubles}, {}});
+
+    return shapes;
+}
+
+static Serializer* wampproto_serializer(xconn::SerializerType type) {
+    switch (type) {
+        case xconn::SerializerType::JSON:
+            return json_serializer_new();
+        case xconn::SerializerType::MSGPACK:
+            return msgpack_serializer_new();
+        case xconn::SerializerType::CBOR:
+            return cbor_serializer_new();
+    }
+    return nullptr;
+}
+
+static void bench_conversion(const Shape& shape) {
+    const xconn::Value args = std::make_shared<xconn::List>(shape.args);
+    const xconn::Value kwargs = std::make_shared<xconn::Dict>(shape.kwargs);
+
+    bench::run(shape.name + "/to_c_value", [&] {
+        ::Value* c_args = xconn::to_c_value(args);
+        ::Value* c_kwargs = xconn::to_c_value(kwargs);
+        value_free(c_args);
+        value_free(c_kwargs);
+    });
+
+    ::Value* c_args = xconn::to_c_value(args);
+    ::Value* c_kwargs = xconn::to_c_value(kwargs);
+    bench::run(shape.name + "/from_c_value", [&] {
+        bench::do_not_optimize(xconn::from_c_value(c_args));
+        bench::do_not_optimize(xconn::from_c_value(c_kwargs));
+    });
+    value_free(c_args);
+    value_free(c_kwargs);
+}
+
+static void bench_serializer(const Shape& shape, xconn::SerializerType type) {
+    const std::string prefix = shape.name + "/" + bench::format_name(type);
+    Serializer* serializer = wampproto_serializer(type);
+
+    Message* call = (Message*)call_new(1, xconn::unordered_map_to_dict({}), "com.example.bench",
+                                       xconn::vector_to_list(shape.args), xconn::unordered_map_to_dict(shape.kwargs));
+
+    bench::run(prefix + "/encode/wampproto", [&] {
+        ::Bytes bytes = serializer->serialize(serializer, call);
+        free(bytes.data);
+    });
+
+    ::Bytes encoded_c = serializer->serialize(serializer, call);
+    bench::run(prefix + "/decode/wampproto", [&] {
+        Message* msg = serializer->deserialize(serializer, encoded_c);
+        if (msg) msg->free(msg);
+    });
+    free(encoded_c.data);
+    call->free(call);
+
+    std::vector<uint8_t> out;
+    bench::run(prefix + "/encode/native", [&] {
+        out.clear();
+        WireWriter writer(type, out);
+        xconn::encode_call(writer, 1, {}, "com.example.bench", shape.args, shape.kwargs);
+        bench::do_not_optimize(out);
+    });
+
+    std::vector<uint8_t> encoded;
+    WireWriter writer(type, encoded);
+    xconn::encode_call(writer, 1, {}, "com.example.bench", shape.args, shape.kwargs);
+    bench::run(prefix + "/decode/native", [&] {
+        WireFrame frame(type, encoded);
+        bench::do_not_optimize(frame.root().toValue());
+    });
+
+    std::printf("%-40s %12zu bytes on the wire\n", prefix.c_str(), encoded.size());
+}
+
+int main() {
+    if (!bench::alloc_counts) std::printf("allocation counting unavailable\n");
+
+    const xconn::SerializerType types[] = {xconn::SerializerType::JSON, xconn::SerializerType::MSGPACK,
+                                           xconn::SerializerType::CBOR};
+    for (const Shape& shape : build_shapes()) {
+        bench_conversion(shape);
+        for (xconn::SerializerType type : types) bench_serializer(shape, type);
+        std::printf("\n");
+    }
+    return 0;
+}
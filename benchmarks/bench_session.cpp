@@ -0,0 +1,141 @@
+// End-to-end session benchmarks against the scripted FakeRouter, for every serializer: call
+// round trip latency, publish throughput, invocation dispatch throughput and connect time.
+// Both ends share the machine, so compare numbers between builds on the same host only.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "xconn_cpp/authenticators.hpp"
+#include "xconn_cpp/client.hpp"
+#include "xconn_cpp/latency_histogram.hpp"
+#include "xconn_cpp/logging.hpp"
+#include "xconn_cpp/session.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+#include "bench.hpp"
+#include "fake_router.hpp"
+
+using namespace xconn;
+using Clock = std::chrono::steady_clock;
+
+static const std::string REALM = "realm1";
+
+constexpr int CALL_WARMUP = 1000;
+constexpr int CALL_SAMPLES = 20000;
+constexpr int PUBLISH_COUNT = 100000;
+constexpr int INVOCATION_COUNT = 50000;
+constexpr int CONNECT_SAMPLES = 100;
+
+static uint64_t elapsed_ns(Clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+static void report_latency(const std::string& name, const LatencyHistogram& histogram) {
+    HistogramSnapshot snap = histogram.snapshot();
+    std::printf("%-40s %12llu samples %9.1f us p50 %9.1f us p90 %9.1f us p99 %9.1f us p99.9\n", name.c_str(),
+                static_cast<unsigned long long>(snap.count), snap.p50 / 1e3, snap.p90 / 1e3, snap.p99 / 1e3,
+                snap.p999 / 1e3);
+}
+
+static void report_rate(const std::string& name, uint64_t count, uint64_t ns) {
+    std::printf("%-40s %12llu messages %12.0f msg/s\n", name.c_str(), static_cast<unsigned long long>(count),
+                double(count) * 1e9 / double(ns));
+}
+
+static std::unique_ptr<Session> connect(const bench::FakeRouter& router, SerializerType type) {
+    auto authenticator = std::make_unique<AnonymousAuthenticator>("bench");
+    Client client(*authenticator, type);
+    return client.connect(router.url(), REALM);
+}
+
+static void bench_connect(const bench::FakeRouter& router, SerializerType type, const std::string& suffix) {
+    auto authenticator = std::make_unique<AnonymousAuthenticator>("bench");
+    Client client(*authenticator, type);
+    LatencyHistogram histogram;
+
+    for (int i = 0; i < CONNECT_SAMPLES; ++i) {
+        auto start = Clock::now();
+        auto session = client.connect(router.url(), REALM);
+        histogram.record(elapsed_ns(start));
+        session->leave();
+    }
+
+    report_latency("connect/" + suffix, histogram);
+}
+
+static void bench_calls(Session& session, const std::string& suffix) {
+    List args{int64_t(42), "sensor-7", 21.5};
+
+    LatencyHistogram adhoc;
+    for (int i = 0; i < CALL_WARMUP; ++i) session.Call("bench.echo").Arg(int64_t(i)).DoView();
+    for (int i = 0; i < CALL_SAMPLES; ++i) {
+        auto start = Clock::now();
+        ResultView result = session.Call("bench.echo").Arg(int64_t(42)).Arg("sensor-7").Arg(21.5).DoView();
+        adhoc.record(elapsed_ns(start));
+        bench::do_not_optimize(result);
+    }
+    report_latency("call/rtt/" + suffix, adhoc);
+
+    auto echo = session.PrepareCall("bench.echo");
+    LatencyHistogram prepared;
+    for (int i = 0; i < CALL_WARMUP; ++i) echo.DoView(args);
+    for (int i = 0; i < CALL_SAMPLES; ++i) {
+        auto start = Clock::now();
+        ResultView result = echo.DoView(args);
+        prepared.record(elapsed_ns(start));
+        bench::do_not_optimize(result);
+    }
+    report_latency("call/rtt/prepared/" + suffix, prepared);
+}
+
+static void bench_publish(Session& session, const std::string& suffix) {
+    List args{int64_t(42), "sensor-7", 21.5};
+    auto publish = session.PreparePublish("bench.topic");
+    // The router answers in order, so one acknowledged publish marks the end of the batch.
+    auto barrier = session.PreparePublish("bench.topic", Dict{{"acknowledge", true}});
+
+    for (int i = 0; i < CALL_WARMUP; ++i) publish.Do(args);
+    barrier.Do();
+
+    auto start = Clock::now();
+    for (int i = 0; i < PUBLISH_COUNT; ++i) publish.Do(args);
+    barrier.Do();
+    report_rate("publish/" + suffix, PUBLISH_COUNT, elapsed_ns(start));
+}
+
+static void bench_invocations(Session& session, const std::string& suffix) {
+    ProcedureViewHandler sink = [](const InvocationView&) -> Result { return Result(); };
+    auto registration = session.Register("bench.sink", sink).Do();
+
+    session.Call(bench::FakeRouter::BURST_PROCEDURE).Arg("bench.sink").Arg(int64_t(CALL_WARMUP)).Do();
+
+    auto start = Clock::now();
+    session.Call(bench::FakeRouter::BURST_PROCEDURE).Arg("bench.sink").Arg(int64_t(INVOCATION_COUNT)).Do();
+    report_rate("invocation/" + suffix, INVOCATION_COUNT, elapsed_ns(start));
+
+    registration.unregister();
+}
+
+int main() {
+    // Every join logs at Info; keep that out of the report.
+    set_log_level(LogLevel::Warning);
+    bench::FakeRouter router;
+
+    for (SerializerType type : {SerializerType::JSON, SerializerType::MSGPACK, SerializerType::CBOR}) {
+        std::string suffix = bench::format_name(type);
+
+        bench_connect(router, type, suffix);
+
+        auto session = connect(router, type);
+        bench_calls(*session, suffix);
+        bench_publish(*session, suffix);
+        bench_invocations(*session, suffix);
+        session->leave();
+    }
+
+    return 0;
+}
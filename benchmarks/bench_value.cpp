@@ -0,0 +1,92 @@
+// Compares building, encoding and decoding a typical CALL payload with Value and with
+// CompactValue.
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/arena.hpp"
+#include "xconn_cpp/compact_value.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+#include "bench.hpp"
+
+using namespace xconn;
+
+static const Bytes PAYLOAD(32, 0xab);
+
+// [options, args, kwargs] as the application would hand them to Call().
+static Value build_value() {
+    return make_list({
+        make_dict({{"receive_progress", true},
+                   {"timeout", int64_t(5000)},
+                   {"disclose_me", false},
+                   {"rkey", "com.example.shard.7"},
+                   {"x_trace_id", "4bf92f3577b34da6a3ce929d0e0e4736"}}),
+        make_list({"com.example.sensor.temperature", int64_t(42), 21.5, PAYLOAD}),
+        make_dict({{"unit", "celsius"}, {"precision", int64_t(2)}, {"source", "building-3/floor-2/room-14"}}),
+    });
+}
+
+static CompactValue build_compact(Arena& arena) {
+    return CompactValue::list(
+        arena, {
+                   CompactValue::dict(arena, {{"receive_progress", true},
+                                              {"timeout", int64_t(5000)},
+                                              {"disclose_me", false},
+                                              {"rkey", CompactValue(arena, "com.example.shard.7")},
+                                              {"x_trace_id", CompactValue(arena, "4bf92f3577b34da6a3ce929d0e0e4736")}}),
+                   CompactValue::list(arena, {CompactValue(arena, "com.example.sensor.temperature"), int64_t(42), 21.5,
+                                              CompactValue::bytes(arena, PAYLOAD)}),
+                   CompactValue::dict(arena, {{"unit", CompactValue(arena, "celsius")},
+                                              {"precision", int64_t(2)},
+                                              {"source", CompactValue(arena, "building-3/floor-2/room-14")}}),
+               });
+}
+
+int main() {
+    Arena arena;
+
+    bench::run("build/value", [] { bench::do_not_optimize(build_value()); });
+    bench::run("build/compact", [&arena] {
+        arena.reset();
+        bench::do_not_optimize(build_compact(arena));
+    });
+
+    const Value value = build_value();
+    arena.reset();
+    const CompactValue compact = build_compact(arena);
+
+    for (SerializerType type : {SerializerType::JSON, SerializerType::MSGPACK, SerializerType::CBOR}) {
+        std::string suffix = bench::format_name(type);
+        std::vector<uint8_t> out;
+
+        bench::run("encode/value/" + suffix, [&] {
+            out.clear();
+            WireWriter(type, out).write_value(value);
+            bench::do_not_optimize(out);
+        });
+        bench::run("encode/compact/" + suffix, [&] {
+            out.clear();
+            WireWriter(type, out).write_value(compact);
+            bench::do_not_optimize(out);
+        });
+
+        out.clear();
+        WireWriter(type, out).write_value(value);
+        WireFrame frame(type, out);
+        Arena decode_arena;
+
+        bench::run("decode/value/" + suffix, [&] { bench::do_not_optimize(frame.root().toValue()); });
+        bench::run("decode/compact/" + suffix, [&] {
+            decode_arena.reset();
+            bench::do_not_optimize(frame.root().toCompact(decode_arena));
+        });
+    }
+
+    return 0;
+}
@@ -0,0 +1,369 @@
+#include "fake_router.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <unordered_map>
+#include <vector>
+
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+namespace xconn::bench {
+
+namespace {
+
+// Message codes beyond the ones the native encoders already name.
+constexpr uint64_t WAMP_MESSAGE_HELLO = 1;
+constexpr uint64_t WAMP_MESSAGE_WELCOME = 2;
+constexpr uint64_t WAMP_MESSAGE_GOODBYE = 6;
+constexpr uint64_t WAMP_MESSAGE_PUBLISHED = 17;
+constexpr uint64_t WAMP_MESSAGE_SUBSCRIBE = 32;
+constexpr uint64_t WAMP_MESSAGE_SUBSCRIBED = 33;
+constexpr uint64_t WAMP_MESSAGE_UNSUBSCRIBE = 34;
+constexpr uint64_t WAMP_MESSAGE_UNSUBSCRIBED = 35;
+constexpr uint64_t WAMP_MESSAGE_REGISTER = 64;
+constexpr uint64_t WAMP_MESSAGE_REGISTERED = 65;
+constexpr uint64_t WAMP_MESSAGE_UNREGISTER = 66;
+constexpr uint64_t WAMP_MESSAGE_UNREGISTERED = 67;
+
+constexpr uint8_t RAWSOCKET_MAGIC = 0x7F;
+constexpr uint8_t FRAME_TYPE_WAMP = 0;
+constexpr uint8_t FRAME_TYPE_PING = 1;
+constexpr uint8_t FRAME_TYPE_PONG = 2;
+
+std::atomic<uint64_t> next_session_id{1};
+
+uint64_t id_at(const ValueView& message, size_t index) {
+    return static_cast<uint64_t>(message.at(index).getInt64().value_or(0));
+}
+
+// Appends the optional args and kwargs found at `first` and `first + 1` of a message.
+void append_payload(List& message, const ValueView& source, size_t first) {
+    ValueView args = source.at(first);
+    if (!args.isValid()) return;
+    message.push_back(std::make_shared<List>(args.toList()));
+
+    ValueView kwargs = source.at(first + 1);
+    if (kwargs.isValid()) message.push_back(std::make_shared<Dict>(kwargs.toDict()));
+}
+
+class Connection {
+   public:
+    explicit Connection(int fd) : fd_(fd) {}
+
+    void run() {
+        if (!handshake()) return;
+
+        std::vector<uint8_t> payload;
+        uint8_t frame_type;
+        while (read_frame(frame_type, payload)) {
+            if (frame_type == FRAME_TYPE_PING) {
+                if (!write_frame(FRAME_TYPE_PONG, payload.data(), payload.size())) return;
+                continue;
+            }
+            if (frame_type != FRAME_TYPE_WAMP) continue;
+
+            WireFrame frame(format_, std::move(payload));
+            if (!handle(frame.root())) return;
+            payload = std::move(frame.buffer);
+        }
+    }
+
+   private:
+    int fd_;
+    SerializerType format_ = SerializerType::JSON;
+    std::vector<uint8_t> out_;
+    uint64_t next_id_ = 1;
+
+    std::unordered_map<std::string, uint64_t> registrations_;
+    std::unordered_map<std::string, uint64_t> subscriptions_;
+    // Outstanding INVOCATION id -> id of the CALL it serves.
+    std::unordered_map<uint64_t, uint64_t> invocations_;
+    // CALL to BURST_PROCEDURE -> invocations it still waits for, and how many it sent.
+    std::unordered_map<uint64_t, std::pair<int64_t, int64_t>> bursts_;
+
+    bool read_exactly(uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::recv(fd_, data, size, 0);
+            if (n <= 0) {
+                if (n < 0 && errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool write_all(const uint8_t* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::send(fd_, data, size, MSG_NOSIGNAL);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool handshake() {
+        uint8_t request[4];
+        if (!read_exactly(request, sizeof(request)) || request[0] != RAWSOCKET_MAGIC) return false;
+
+        uint8_t serializer = request[1] & 0x0F;
+        switch (serializer) {
+            case 1:
+                format_ = SerializerType::JSON;
+                break;
+            case 2:
+                format_ = SerializerType::MSGPACK;
+                break;
+            case 3:
+                format_ = SerializerType::CBOR;
+                break;
+            default: {
+                // Error 1: serializer unsupported.
+                uint8_t refusal[4] = {RAWSOCKET_MAGIC, 0x10, 0, 0};
+                write_all(refusal, sizeof(refusal));
+                return false;
+            }
+        }
+
+        // Accept frames up to the RawSocket maximum of 2^24 bytes.
+        uint8_t reply[4] = {RAWSOCKET_MAGIC, uint8_t(0xF0 | serializer), 0, 0};
+        return write_all(reply, sizeof(reply));
+    }
+
+    bool read_frame(uint8_t& frame_type, std::vector<uint8_t>& payload) {
+        uint8_t header[4];
+        if (!read_exactly(header, sizeof(header))) return false;
+
+        frame_type = header[0] & 0x07;
+        size_t length = (size_t(header[1]) << 16) | (size_t(header[2]) << 8) | size_t(header[3]);
+        payload.resize(length);
+        return read_exactly(payload.data(), length);
+    }
+
+    bool write_frame(uint8_t frame_type, const uint8_t* data, size_t size) {
+        uint8_t header[4] = {frame_type, uint8_t(size >> 16), uint8_t(size >> 8), uint8_t(size)};
+        return write_all(header, sizeof(header)) && write_all(data, size);
+    }
+
+    bool send(const List& message) {
+        out_.clear();
+        WireWriter(format_, out_).write_list(message);
+        return write_frame(FRAME_TYPE_WAMP, out_.data(), out_.size());
+    }
+
+    void invoke(uint64_t call_id, uint64_t registration_id, const ValueView& call) {
+        uint64_t invocation_id = next_id_++;
+        invocations_[invocation_id] = call_id;
+
+        List invocation{int64_t(WAMP_MESSAGE_INVOCATION), int64_t(invocation_id), int64_t(registration_id),
+                        make_dict({})};
+        if (call.isValid()) append_payload(invocation, call, 4);
+        send(invocation);
+    }
+
+    // Returns false once the connection should be closed.
+    bool handle(const ValueView& message) {
+        switch (id_at(message, 0)) {
+            case WAMP_MESSAGE_HELLO: {
+                auto roles = make_dict({{"broker", make_dict({})}, {"dealer", make_dict({})}});
+                auto details = make_dict({{"authid", "bench"},
+                                          {"authrole", "anonymous"},
+                                          {"authmethod", "anonymous"},
+                                          {"authprovider", "static"},
+                                          {"roles", roles}});
+                return send(List{int64_t(WAMP_MESSAGE_WELCOME), int64_t(next_session_id++), details});
+            }
+            case WAMP_MESSAGE_GOODBYE: {
+                send(List{int64_t(WAMP_MESSAGE_GOODBYE), make_dict({}), "wamp.close.goodbye_and_out"});
+                return false;
+            }
+            case WAMP_MESSAGE_REGISTER: {
+                uint64_t registration_id = next_id_++;
+                registrations_[std::string(message.at(3).getString().value_or(""))] = registration_id;
+                return send(List{int64_t(WAMP_MESSAGE_REGISTERED), int64_t(id_at(message, 1)),
+                                 int64_t(registration_id)});
+            }
+            case WAMP_MESSAGE_UNREGISTER: {
+                std::erase_if(registrations_, [&](const auto& entry) { return entry.second == id_at(message, 2); });
+                return send(List{int64_t(WAMP_MESSAGE_UNREGISTERED), int64_t(id_at(message, 1))});
+            }
+            case WAMP_MESSAGE_SUBSCRIBE: {
+                uint64_t subscription_id = next_id_++;
+                subscriptions_[std::string(message.at(3).getString().value_or(""))] = subscription_id;
+                return send(List{int64_t(WAMP_MESSAGE_SUBSCRIBED), int64_t(id_at(message, 1)),
+                                 int64_t(subscription_id)});
+            }
+            case WAMP_MESSAGE_UNSUBSCRIBE: {
+                std::erase_if(subscriptions_, [&](const auto& entry) { return entry.second == id_at(message, 2); });
+                return send(List{int64_t(WAMP_MESSAGE_UNSUBSCRIBED), int64_t(id_at(message, 1))});
+            }
+            case WAMP_MESSAGE_PUBLISH: {
+                ValueView options = message.at(2);
+                uint64_t publication_id = next_id_++;
+
+                // The publisher is the only session here, so it hears itself only when asking to.
+                auto subscription = subscriptions_.find(std::string(message.at(3).getString().value_or("")));
+                if (subscription != subscriptions_.end() && options.get("exclude_me").getBool() == false) {
+                    List event{int64_t(WAMP_MESSAGE_EVENT), int64_t(subscription->second), int64_t(publication_id),
+                               make_dict({})};
+                    append_payload(event, message, 4);
+                    if (!send(event)) return false;
+                }
+
+                if (options.get("acknowledge").getBool().value_or(false)) {
+                    return send(List{int64_t(WAMP_MESSAGE_PUBLISHED), int64_t(id_at(message, 1)),
+                                     int64_t(publication_id)});
+                }
+                return true;
+            }
+            case WAMP_MESSAGE_CALL:
+                return handle_call(message);
+            case WAMP_MESSAGE_YIELD:
+            case WAMP_MESSAGE_ERROR:
+                return handle_reply(message);
+            default:
+                return true;
+        }
+    }
+
+    bool handle_call(const ValueView& message) {
+        uint64_t call_id = id_at(message, 1);
+        std::string procedure(message.at(3).getString().value_or(""));
+
+        if (procedure == FakeRouter::BURST_PROCEDURE) {
+            ValueView args = message.at(4);
+            auto target = registrations_.find(std::string(args.at(0).getString().value_or("")));
+            int64_t count = args.at(1).getInt64().value_or(0);
+            if (target == registrations_.end() || count <= 0) {
+                return send(List{int64_t(WAMP_MESSAGE_ERROR), int64_t(WAMP_MESSAGE_CALL), int64_t(call_id),
+                                 make_dict({}), "wamp.error.invalid_argument"});
+            }
+
+            bursts_[call_id] = {count, count};
+            for (int64_t i = 0; i < count; ++i) invoke(call_id, target->second, ValueView());
+            return true;
+        }
+
+        auto registration = registrations_.find(procedure);
+        if (registration != registrations_.end()) {
+            invoke(call_id, registration->second, message);
+            return true;
+        }
+
+        List result{int64_t(WAMP_MESSAGE_RESULT), int64_t(call_id), make_dict({})};
+        append_payload(result, message, 4);
+        return send(result);
+    }
+
+    // YIELD or ERROR from the callee, completing the CALL the invocation was made for.
+    bool handle_reply(const ValueView& message) {
+        bool is_error = id_at(message, 0) == WAMP_MESSAGE_ERROR;
+        uint64_t invocation_id = id_at(message, is_error ? 2 : 1);
+
+        auto invocation = invocations_.find(invocation_id);
+        if (invocation == invocations_.end()) return true;
+        uint64_t call_id = invocation->second;
+        invocations_.erase(invocation);
+
+        auto burst = bursts_.find(call_id);
+        if (burst != bursts_.end()) {
+            if (--burst->second.first > 0) return true;
+
+            int64_t sent = burst->second.second;
+            bursts_.erase(burst);
+            return send(List{int64_t(WAMP_MESSAGE_RESULT), int64_t(call_id), make_dict({}), make_list({sent})});
+        }
+
+        if (is_error) {
+            List error{int64_t(WAMP_MESSAGE_ERROR), int64_t(WAMP_MESSAGE_CALL), int64_t(call_id), make_dict({}),
+                       std::string(message.at(4).getString().value_or(""))};
+            append_payload(error, message, 5);
+            return send(error);
+        }
+
+        List result{int64_t(WAMP_MESSAGE_RESULT), int64_t(call_id), make_dict({})};
+        append_payload(result, message, 3);
+        return send(result);
+    }
+};
+
+}  // namespace
+
+FakeRouter::FakeRouter() {
+    char directory[] = "/tmp/xconn-bench-XXXXXX";
+    if (!::mkdtemp(directory)) throw std::runtime_error("Failed to create socket directory");
+    directory_ = directory;
+    path_ = directory_ + "/router.sock";
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+
+    listener_ = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener_ < 0 || ::bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener_, 128) != 0) {
+        std::string reason = std::strerror(errno);
+        if (listener_ >= 0) ::close(listener_);
+        ::rmdir(directory_.c_str());
+        throw std::runtime_error("Failed to listen on " + path_ + ": " + reason);
+    }
+
+    accept_thread_ = std::thread(&FakeRouter::accept_loop, this);
+}
+
+FakeRouter::~FakeRouter() {
+    stopping_ = true;
+    ::shutdown(listener_, SHUT_RDWR);
+    if (accept_thread_.joinable()) accept_thread_.join();
+
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        for (int fd : connections_) ::shutdown(fd, SHUT_RDWR);
+    }
+    for (auto& worker : workers_) worker.join();
+
+    ::close(listener_);
+    ::unlink(path_.c_str());
+    ::rmdir(directory_.c_str());
+}
+
+void FakeRouter::accept_loop() {
+    while (!stopping_) {
+        int fd = ::accept(listener_, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(connections_mutex_);
+        connections_.push_back(fd);
+        workers_.emplace_back(&FakeRouter::serve, this, fd);
+    }
+}
+
+void FakeRouter::serve(int fd) {
+    Connection(fd).run();
+
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    connections_.erase(std::find(connections_.begin(), connections_.end(), fd));
+    ::close(fd);
+}
+
+}  // namespace xconn::bench
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace xconn::bench {
+
+// Scripted WAMP peer for benchmarks, so they run without an outside router. It listens on a
+// Unix socket in a temporary directory, accepts RawSocket with any serializer, welcomes every
+// HELLO anonymously and answers from a fixed script instead of routing between sessions:
+//
+//   CALL to a procedure the session registered   INVOCATION, then RESULT with what it yields
+//   CALL to BURST_PROCEDURE [procedure, n]       n INVOCATIONs of `procedure`, then RESULT [n]
+//                                                once all of them are yielded
+//   any other CALL                               RESULT echoing args and kwargs
+//   PUBLISH                                      EVENT to the session if it subscribed to the
+//                                                topic, PUBLISHED when acknowledge is set
+//
+// Each connection is served by its own thread and nothing is shared between sessions.
+class FakeRouter {
+   public:
+    static constexpr const char* BURST_PROCEDURE = "bench.invoke_burst";
+
+    FakeRouter();
+    ~FakeRouter();
+
+    FakeRouter(const FakeRouter&) = delete;
+    FakeRouter& operator=(const FakeRouter&) = delete;
+
+    // Address to hand to Client::connect().
+    std::string url() const { return "unix://" + path_; }
+
+   private:
+    std::string directory_;
+    std::string path_;
+    int listener_ = -1;
+
+    std::atomic<bool> stopping_{false};
+    std::thread accept_thread_;
+
+    std::mutex connections_mutex_;
+    std::vector<int> connections_;
+    std::vector<std::thread> workers_;
+
+    void accept_loop();
+    void serve(int fd);
+};
+
+}  // namespace xconn::bench
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstdint>
+
+namespace xconn {
+
+struct AllocStats {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    AllocStats operator-(const AllocStats& other) const {
+        return {allocations - other.allocations, bytes - other.bytes};
+    }
+};
+
+// True when the library was built with XCONN_ALLOC_ACCOUNTING. That build replaces the
+// global operator new and, on glibc, malloc and friends so that wampproto's buffers are
+// seen too. In any other build the counters below stay at zero.
+bool alloc_accounting_enabled();
+
+// Heap allocations made so far by the calling thread.
+AllocStats thread_alloc_stats();
+
+// Heap allocations made so far by the whole process.
+AllocStats process_alloc_stats();
+
+// Allocations the calling thread makes between construction and elapsed().
+class AllocScope {
+   public:
+    AllocScope() : start_(thread_alloc_stats()) {}
+
+    AllocStats elapsed() const { return thread_alloc_stats() - start_; }
+
+   private:
+    AllocStats start_;
+};
+
+}  // namespace xconn
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+namespace xconn {
+
+// Bump allocator for short-lived, message scoped data. Allocations are never freed one by
+// one; reset() rewinds the whole arena and keeps its blocks for the next use. Objects
+// placed in an arena must be trivially destructible.
+class Arena {
+   public:
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 4096;
+
+    explicit Arena(std::size_t block_size = DEFAULT_BLOCK_SIZE) : block_size_(block_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    Arena(Arena&&) noexcept = default;
+    Arena& operator=(Arena&&) noexcept = default;
+
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    template <typename T>
+    T* allocate_array(std::size_t count) {
+        return static_cast<T*>(allocate(sizeof(T) * count, alignof(T)));
+    }
+
+    void reset();
+
+    // Bytes handed out since the last reset, and bytes reserved from the heap overall.
+    std::size_t used() const { return used_; }
+    std::size_t capacity() const;
+
+   private:
+    struct Block {
+        std::unique_ptr<std::byte[]> data;
+        std::size_t size;
+    };
+
+    std::size_t block_size_;
+    std::vector<Block> blocks_;
+    std::size_t current_ = 0;
+    std::size_t offset_ = 0;
+    std::size_t used_ = 0;
+};
+
+}  // namespace xconn
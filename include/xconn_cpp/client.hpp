@@ -1,9 +1,12 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "xconn_cpp/authenticators.hpp"
 #include "xconn_cpp/session.hpp"
+#include "xconn_cpp/session_joiner.hpp"
 #include "xconn_cpp/types.hpp"
 
 namespace xconn {
@@ -12,6 +15,10 @@ class Client {
    public:
     Authenticator authenticator;
     SerializerType serializer_type;
+    // Largest inbound message announced to the router, see SessionJoiner.
+    std::size_t max_msg_size = MAX_MSG_SIZE;
+    // Placement of each session's receive thread and handler pool.
+    ThreadingOptions threading;
 
     Client(Authenticator authenticator, SerializerType serializer_type)
         : authenticator(std::move(authenticator)), serializer_type(serializer_type) {}
@@ -19,6 +26,13 @@ class Client {
     ~Client();
 
     std::unique_ptr<Session> connect(std::string uri, std::string realm);
+
+    // Opens `count` sessions, running at most `concurrency` connects, handshakes and
+    // authentications at a time. The router address is resolved once up front. If any
+    // session fails to join, the ones already established are closed and the error is rethrown.
+    std::vector<std::unique_ptr<Session>> connect_many(std::string uri, std::string realm, std::size_t count,
+                                                       std::size_t concurrency = 16,
+                                                       ConnectTimings* timings = nullptr);
 };
 
 inline std::unique_ptr<Session> connectAnonymous(std::string uri, std::string realm, std::string auth_id = "") {
@@ -0,0 +1,145 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+
+#include "xconn_cpp/arena.hpp"
+#include "xconn_cpp/types.hpp"
+
+namespace xconn {
+
+struct CompactEntry;
+
+// A 16 byte alternative to Value for hot paths. Scalars and strings or bytes of up to
+// INLINE_CAPACITY bytes live in the value itself; longer data and the elements of lists
+// and dicts are placed in an Arena, so building a message costs no individual heap
+// allocations and no reference counting. Dicts are flat arrays sorted by key.
+//
+// A CompactValue is trivially copyable and does not own anything: it stays valid as long
+// as the arena it was built in is neither reset nor destroyed. Views returned by
+// getString() and getBytes() of inline data point into the value itself.
+class CompactValue {
+   public:
+    enum class Type : uint8_t { Null, Int, UInt, Double, Bool, String, Bytes, List, Dict };
+
+    static constexpr std::size_t INLINE_CAPACITY = 14;
+
+    CompactValue() = default;
+    CompactValue(std::nullptr_t) {}
+    CompactValue(int value) : CompactValue(int64_t(value)) {}
+    CompactValue(int64_t value) : type_(Type::Int) { store(value); }
+    CompactValue(uint64_t value) : type_(Type::UInt) { store(value); }
+    CompactValue(double value) : type_(Type::Double) { store(value); }
+    CompactValue(bool value) : type_(Type::Bool) { store(value); }
+    CompactValue(Arena& arena, std::string_view value) : type_(Type::String) { store_data(arena, value); }
+    // Would otherwise silently convert to bool; strings need an arena.
+    CompactValue(const char*) = delete;
+
+    static CompactValue bytes(Arena& arena, std::span<const uint8_t> value);
+
+    static CompactValue list(Arena& arena, std::span<const CompactValue> items);
+    static CompactValue list(Arena& arena, std::initializer_list<CompactValue> items);
+    static CompactValue dict(Arena& arena, std::span<const CompactEntry> entries);
+    static CompactValue dict(Arena& arena, std::initializer_list<std::pair<std::string_view, CompactValue>> entries);
+
+    // Builds a list of `count` null elements or a dict of `count` empty entries, to be
+    // filled in place through items() or entries(). A filled dict needs sort_entries().
+    static CompactValue list(Arena& arena, std::size_t count);
+    static CompactValue dict(Arena& arena, std::size_t count);
+    std::span<CompactValue> items();
+    std::span<CompactEntry> entries();
+    // Sorts dict entries by key; for duplicate keys the last one wins.
+    void sort_entries();
+
+    static CompactValue from(Arena& arena, const Value& value);
+
+    Type type() const { return type_; }
+    bool isNull() const { return type_ == Type::Null; }
+
+    std::optional<int64_t> getInt64() const {
+        return type_ == Type::Int ? std::optional(load<int64_t>()) : std::nullopt;
+    }
+    std::optional<uint64_t> getUInt64() const {
+        return type_ == Type::UInt ? std::optional(load<uint64_t>()) : std::nullopt;
+    }
+    std::optional<double> getDouble() const {
+        return type_ == Type::Double ? std::optional(load<double>()) : std::nullopt;
+    }
+    std::optional<bool> getBool() const { return type_ == Type::Bool ? std::optional(load<bool>()) : std::nullopt; }
+    std::optional<std::string_view> getString() const {
+        return type_ == Type::String ? std::optional(data()) : std::nullopt;
+    }
+    std::optional<std::span<const uint8_t>> getBytes() const {
+        if (type_ != Type::Bytes) return std::nullopt;
+        std::string_view bytes = data();
+        return std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+    }
+    std::optional<std::span<const CompactValue>> getList() const {
+        if (type_ != Type::List) return std::nullopt;
+        return std::span<const CompactValue>(static_cast<const CompactValue*>(ref_data()), ref_size());
+    }
+    std::optional<std::span<const CompactEntry>> getDict() const;
+
+    // Element count of a list or dict, zero for anything else.
+    std::size_t size() const { return type_ == Type::List || type_ == Type::Dict ? ref_size() : 0; }
+    // List element by position or dict value by key, nullptr if there is none.
+    const CompactValue* at(std::size_t index) const;
+    const CompactValue* get(std::string_view key) const;
+
+    // Copies into the heap-allocated Value types.
+    Value toValue() const;
+
+   private:
+    // Marks data stored in the arena rather than inline.
+    static constexpr uint8_t OUT_OF_LINE = 0xff;
+
+    alignas(8) unsigned char storage_[INLINE_CAPACITY]{};
+    uint8_t inline_size_ = 0;
+    Type type_ = Type::Null;
+
+    template <typename T>
+    void store(T value) {
+        std::memcpy(storage_, &value, sizeof(T));
+    }
+
+    template <typename T>
+    T load() const {
+        T value;
+        std::memcpy(&value, storage_, sizeof(T));
+        return value;
+    }
+
+    // Out of line payloads are a pointer followed by a 32-bit length.
+    void store_ref(const void* data, std::size_t size);
+    const void* ref_data() const { return load<const void*>(); }
+    uint32_t ref_size() const {
+        uint32_t length;
+        std::memcpy(&length, storage_ + sizeof(void*), sizeof(length));
+        return length;
+    }
+
+    void store_data(Arena& arena, std::string_view data);
+    std::string_view data() const {
+        if (inline_size_ != OUT_OF_LINE) return std::string_view(reinterpret_cast<const char*>(storage_), inline_size_);
+        return std::string_view(static_cast<const char*>(ref_data()), ref_size());
+    }
+};
+
+struct CompactEntry {
+    CompactValue key;
+    CompactValue value;
+};
+
+inline std::optional<std::span<const CompactEntry>> CompactValue::getDict() const {
+    if (type_ != Type::Dict) return std::nullopt;
+    return std::span<const CompactEntry>(static_cast<const CompactEntry*>(ref_data()), ref_size());
+}
+
+static_assert(sizeof(CompactValue) == 16);
+
+}  // namespace xconn
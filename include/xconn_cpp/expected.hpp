@@ -0,0 +1,105 @@
+#pragma once
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <version>
+
+#ifdef __cpp_lib_expected
+#include <expected>
+#endif
+
+namespace xconn {
+
+#ifdef __cpp_lib_expected
+
+template <typename T, typename E>
+using Expected = std::expected<T, E>;
+
+template <typename E>
+using Unexpected = std::unexpected<E>;
+
+template <typename E>
+using BadExpectedAccess = std::bad_expected_access<E>;
+
+#else
+
+// The subset of C++23 std::expected the library uses, for C++20 builds. It is replaced by
+// std::expected itself when the standard library provides it.
+template <typename E>
+class Unexpected {
+   public:
+    explicit Unexpected(E error) : error_(std::move(error)) {}
+
+    E& error() & { return error_; }
+    const E& error() const& { return error_; }
+    E&& error() && { return std::move(error_); }
+
+   private:
+    E error_;
+};
+
+template <typename E>
+Unexpected(E) -> Unexpected<E>;
+
+// Thrown by value() on an Expected holding an error, as std::bad_expected_access is.
+template <typename E>
+class BadExpectedAccess : public std::exception {
+   public:
+    explicit BadExpectedAccess(E error) : error_(std::move(error)) {}
+
+    const char* what() const noexcept override { return "bad access to Expected without expected value"; }
+
+    E& error() & noexcept { return error_; }
+    const E& error() const& noexcept { return error_; }
+    E&& error() && noexcept { return std::move(error_); }
+
+   private:
+    E error_;
+};
+
+template <typename T, typename E>
+class Expected {
+   public:
+    template <typename U = T, typename = std::enable_if_t<!std::is_same_v<std::decay_t<U>, Expected> &&
+                                                          std::is_constructible_v<T, U&&>>>
+    Expected(U&& value) : storage_(std::in_place_index<0>, std::forward<U>(value)) {}
+
+    template <typename G>
+    Expected(Unexpected<G> error) : storage_(std::in_place_index<1>, std::move(error).error()) {}
+
+    bool has_value() const noexcept { return storage_.index() == 0; }
+    explicit operator bool() const noexcept { return has_value(); }
+
+    T& value() & {
+        if (!has_value()) throw BadExpectedAccess<E>(error());
+        return std::get<0>(storage_);
+    }
+    const T& value() const& {
+        if (!has_value()) throw BadExpectedAccess<E>(error());
+        return std::get<0>(storage_);
+    }
+    T&& value() && { return std::move(value()); }
+
+    template <typename U>
+    T value_or(U&& fallback) const& {
+        return has_value() ? std::get<0>(storage_) : static_cast<T>(std::forward<U>(fallback));
+    }
+
+    T& operator*() & { return std::get<0>(storage_); }
+    const T& operator*() const& { return std::get<0>(storage_); }
+    T&& operator*() && { return std::get<0>(std::move(storage_)); }
+    T* operator->() { return &std::get<0>(storage_); }
+    const T* operator->() const { return &std::get<0>(storage_); }
+
+    E& error() & { return std::get<1>(storage_); }
+    const E& error() const& { return std::get<1>(storage_); }
+    E&& error() && { return std::get<1>(std::move(storage_)); }
+
+   private:
+    std::variant<T, E> storage_;
+};
+
+#endif
+
+}  // namespace xconn
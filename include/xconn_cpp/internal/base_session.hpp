@@ -1,14 +1,20 @@
 #pragma once
 
+#include <memory>
+#include <vector>
+
+#include "xconn_cpp/internal/frame_pool.hpp"
 #include "xconn_cpp/internal/socket_transport.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
 
 namespace xconn {
 
 class BaseSession {
    public:
     BaseSession(std::shared_ptr<SocketTransport> transport, const SessionDetails* session_details,
-                Serializer* serializer);
+                Serializer* serializer, SerializerType serializer_type);
     Serializer* serializer;
+    SerializerType serializer_type;
 
     std::shared_ptr<SocketTransport> transport() const;
     uint64_t id() const;
@@ -18,16 +24,27 @@ class BaseSession {
 
     // Core methods
     void send(::Bytes& bytes);
+    void send(const uint8_t* data, size_t size, uint64_t* locked_at = nullptr);
     ::Bytes receive();
 
     void send_message(const Message* msg);
     Message* receive_message();
 
+    // Reads the next message without decoding it. The frame owns its buffer because views
+    // handed to handlers point into it, and is recycled once they are all released.
+    // Returns nullptr if nothing was read.
+    std::shared_ptr<WireFrame> receive_frame();
+    Message* deserialize(const WireFrame& frame);
+
     void close();
 
    private:
     std::shared_ptr<SocketTransport> transport_;
     const SessionDetails* session_details_;
+
+    // Reused across receive_message() calls; released again after an unusually large frame.
+    std::vector<uint8_t> recv_buffer_;
+    FramePool frames_;
 };
 
 }  // namespace xconn
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+
+namespace xconn {
+
+// Caps how many invocations of one registration run at a time. Invocations over the cap
+// wait here rather than on a pool worker, and are turned away once `max_queued` are waiting.
+class ConcurrencyLimiter {
+   public:
+    enum class Admission { Run, Queued, Rejected };
+
+    ConcurrencyLimiter(size_t limit, size_t max_queued) : limit_(limit ? limit : 1), max_queued_(max_queued) {}
+
+    // Run: `task` holds a slot and should be started now. Queued: it was moved in and is
+    // handed back by release() once a slot frees up. Rejected: it was left with the caller.
+    Admission admit(std::function<void()>& task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_ < limit_) {
+            ++running_;
+            return Admission::Run;
+        }
+        if (waiting_.size() >= max_queued_) return Admission::Rejected;
+        waiting_.push_back(std::move(task));
+        return Admission::Queued;
+    }
+
+    // Called when a task that held a slot finishes. The slot passes to the returned task,
+    // if one was waiting.
+    std::optional<std::function<void()>> release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (waiting_.empty()) {
+            --running_;
+            return std::nullopt;
+        }
+        std::function<void()> next = std::move(waiting_.front());
+        waiting_.pop_front();
+        return next;
+    }
+
+    size_t running() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return running_;
+    }
+
+    size_t queued() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return waiting_.size();
+    }
+
+   private:
+    const size_t limit_;
+    const size_t max_queued_;
+    mutable std::mutex mutex_;
+    size_t running_ = 0;
+    std::deque<std::function<void()>> waiting_;
+};
+
+}  // namespace xconn
@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <utility>
+
+namespace xconn {
+
+// Calls `on_expired` with the ID of each deadline that passes before it is cancelled. The
+// calls are made one at a time from a thread of the timer's own, started by the first
+// schedule(), so a timer that is never used costs no thread.
+class DeadlineTimer {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit DeadlineTimer(std::function<void(uint64_t)> on_expired) : on_expired_(std::move(on_expired)) {}
+
+    ~DeadlineTimer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_one();
+        if (thread_.joinable()) thread_.join();
+    }
+
+    DeadlineTimer(const DeadlineTimer&) = delete;
+    DeadlineTimer& operator=(const DeadlineTimer&) = delete;
+
+    void schedule(Clock::time_point deadline, uint64_t id) {
+        bool earliest;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) thread_ = std::thread([this] { run(); });
+            auto added = deadlines_.emplace(deadline, id).first;
+            earliest = added == deadlines_.begin();
+        }
+        if (earliest) wake_.notify_one();
+    }
+
+    // Called with the deadline it was scheduled with. Cancelling one that already expired,
+    // or is expiring, does nothing.
+    void cancel(Clock::time_point deadline, uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        deadlines_.erase({deadline, id});
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return deadlines_.size();
+    }
+
+   private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (!stop_) {
+            if (deadlines_.empty()) {
+                wake_.wait(lock);
+                continue;
+            }
+            // Copied out, since a cancel() may remove the entry while this waits for it.
+            auto [deadline, id] = *deadlines_.begin();
+            if (Clock::now() < deadline) {
+                wake_.wait_until(lock, deadline);
+                continue;
+            }
+            deadlines_.erase(deadlines_.begin());
+            lock.unlock();
+            on_expired_(id);
+            lock.lock();
+        }
+    }
+
+    std::function<void(uint64_t)> on_expired_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::set<std::pair<Clock::time_point, uint64_t>> deadlines_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+}  // namespace xconn
@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+namespace xconn {
+
+// Lease on a per-thread output buffer for the native encoders, reused across messages. Leases
+// nest: one taken while another is held on the same thread, e.g. by a CALL made from inside a
+// procedure handler whose YIELD is being encoded, gets a buffer of its own.
+class EncodeBuffer {
+   public:
+    EncodeBuffer() : depth_(depth()++) {
+        auto& buffers = stack();
+        if (buffers.size() <= depth_) buffers.emplace_back();
+        buffer_ = &buffers[depth_];
+        buffer_->clear();
+    }
+    ~EncodeBuffer() { --depth(); }
+
+    EncodeBuffer(const EncodeBuffer&) = delete;
+    EncodeBuffer& operator=(const EncodeBuffer&) = delete;
+
+    std::vector<uint8_t>& bytes() { return *buffer_; }
+
+    // Leases currently held by the calling thread.
+    static size_t held() { return depth(); }
+
+   private:
+    // A deque, so growing it leaves the buffers of outer leases where they are.
+    static std::deque<std::vector<uint8_t>>& stack() {
+        thread_local std::deque<std::vector<uint8_t>> buffers;
+        return buffers;
+    }
+    static size_t& depth() {
+        thread_local size_t value = 0;
+        return value;
+    }
+
+    size_t depth_;
+    std::vector<uint8_t>* buffer_;
+};
+
+}  // namespace xconn
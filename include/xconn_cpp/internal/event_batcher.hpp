@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "xconn_cpp/value_view.hpp"
+
+namespace xconn {
+
+// Events of one batch or conflating subscription waiting for its handler. The receive thread
+// adds to it; a single drain task at a time takes them out, at most `max_events` per batch,
+// so batches are handed over in the order the events arrived.
+class EventBatcher {
+   public:
+    explicit EventBatcher(size_t max_events) : max_events_(max_events ? max_events : 1) {}
+
+    // Returns true when no drain task is queued or running, i.e. the caller must post one.
+    bool add(EventView event, uint64_t queued_at) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back({std::move(event), queued_at, {}, false});
+        return start_drain();
+    }
+
+    // Like add(), but an event still waiting under the same `key` is replaced rather than
+    // followed; the newer event keeps the older one's place. `replaced` tells which it was.
+    bool add(EventView event, uint64_t queued_at, std::string key, bool& replaced) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = keyed_.find(key);
+        replaced = found != keyed_.end();
+        if (replaced) {
+            pending_[found->second - taken_].event = std::move(event);
+            return false;
+        }
+        keyed_.emplace(key, taken_ + pending_.size());
+        pending_.push_back({std::move(event), queued_at, std::move(key), true});
+        return start_drain();
+    }
+
+    // Moves the oldest waiting events into `batch` and returns when the first of them arrived.
+    uint64_t take(std::vector<EventView>& batch) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t queued_at = pending_.empty() ? 0 : pending_.front().queued_at;
+        while (!pending_.empty() && batch.size() < max_events_) {
+            Pending& next = pending_.front();
+            if (next.keyed) keyed_.erase(next.key);
+            batch.push_back(std::move(next.event));
+            pending_.pop_front();
+            ++taken_;
+        }
+        return queued_at;
+    }
+
+    // Called by the drain task once its batch is handled. Returns true if more events came in
+    // meanwhile and it should be posted again; otherwise the next add() starts a new one.
+    bool finish() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!pending_.empty()) return true;
+        draining_ = false;
+        return false;
+    }
+
+    size_t pending() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pending_.size();
+    }
+
+   private:
+    struct Pending {
+        EventView event;
+        uint64_t queued_at;
+        std::string key;
+        // Added under a conflation key, which may be empty.
+        bool keyed;
+    };
+
+    // Called with mutex_ held.
+    bool start_drain() {
+        if (draining_) return false;
+        draining_ = true;
+        return true;
+    }
+
+    const size_t max_events_;
+    mutable std::mutex mutex_;
+    std::deque<Pending> pending_;
+    // Position of each keyed event, counted from the first event ever added; the front of
+    // pending_ is at position taken_.
+    std::unordered_map<std::string, uint64_t> keyed_;
+    uint64_t taken_ = 0;
+    bool draining_ = false;
+};
+
+}  // namespace xconn
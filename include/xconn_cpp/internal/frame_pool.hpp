@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+
+namespace xconn {
+
+// Recycles received frames together with their buffer and arena. A frame returns to the
+// pool once the last view into it is released, so in steady state a message is received
+// and decoded into memory that is already there and freed by rewinding it. The shared_ptr
+// control blocks are recycled too, so handing out a frame does not allocate either.
+class FramePool {
+   public:
+    static constexpr size_t DEFAULT_MAX_IDLE = 32;
+    // Frames that grew past this are shrunk before going back to the pool.
+    static constexpr size_t DEFAULT_RETAIN_SIZE = 1 << 20;
+
+    explicit FramePool(SerializerType format, size_t max_idle = DEFAULT_MAX_IDLE,
+                       size_t retain_size = DEFAULT_RETAIN_SIZE);
+
+    // An empty frame; the pool may be destroyed before the frame is released.
+    std::shared_ptr<WireFrame> acquire();
+
+    // Frames waiting to be reused.
+    size_t idle() const;
+
+   private:
+    // Memory of released control blocks. Every control block still out holds a reference,
+    // so it can be freed into the cache after the pool is gone.
+    struct BlockCache {
+        explicit BlockCache(size_t max_idle) : max_idle(max_idle) { blocks.reserve(max_idle); }
+        ~BlockCache();
+
+        void* take(size_t size);
+        void give(void* block, size_t size);
+
+        const size_t max_idle;
+        std::mutex mutex;
+        // All control blocks are of one type, so of one size.
+        size_t block_size = 0;
+        std::vector<void*> blocks;
+    };
+
+    template <typename T>
+    struct BlockAllocator {
+        using value_type = T;
+
+        explicit BlockAllocator(std::shared_ptr<BlockCache> cache) : cache(std::move(cache)) {}
+        template <typename U>
+        BlockAllocator(const BlockAllocator<U>& other) : cache(other.cache) {}
+
+        T* allocate(size_t n) { return static_cast<T*>(cache->take(n * sizeof(T))); }
+        void deallocate(T* block, size_t n) { cache->give(block, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const BlockAllocator<U>& other) const {
+            return cache == other.cache;
+        }
+
+        std::shared_ptr<BlockCache> cache;
+    };
+
+    struct State {
+        SerializerType format;
+        size_t max_idle;
+        size_t retain_size;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<WireFrame>> idle;
+        std::shared_ptr<BlockCache> blocks;
+    };
+
+    std::shared_ptr<State> state_;
+
+    static void release(const std::weak_ptr<State>& state, WireFrame* frame);
+};
+
+}  // namespace xconn
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+namespace xconn {
+
+// Vectorized byte scanning for the native JSON encoder and decoder. The implementation
+// is picked once at startup from what the CPU supports.
+enum class SimdLevel { Scalar, SSE42, AVX2 };
+
+const char* simd_level_name(SimdLevel level);
+
+// Best level this CPU supports, and the level currently in use.
+SimdLevel json_simd_supported();
+SimdLevel json_simd_level();
+
+// Forces a lower level, for tests and benchmarks. Levels above json_simd_supported()
+// are clamped.
+void set_json_simd_level(SimdLevel level);
+
+// Each returns the first matching byte in [p, end), or end if there is none.
+
+// '"' or '\\': the end of a string body, or an escape inside it.
+const uint8_t* json_find_quote_or_backslash(const uint8_t* p, const uint8_t* end);
+// '"', '\\' or a control character: what the encoder has to escape.
+const uint8_t* json_find_unsafe(const uint8_t* p, const uint8_t* end);
+// '"', '[', ']', '{' or '}': what matters when skipping over a container.
+const uint8_t* json_find_structural(const uint8_t* p, const uint8_t* end);
+
+}  // namespace xconn
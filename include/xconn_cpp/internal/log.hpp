@@ -0,0 +1,19 @@
+#pragma once
+
+#include <format>
+
+#include "xconn_cpp/logging.hpp"
+#include "xconn_cpp/tracing.hpp"
+
+// Logs a std::format message at `level`, rate limited per call site. Arguments are only
+// evaluated and formatted when the level is enabled and the site is under its limit.
+#define XCONN_LOG(level, ...)                                                                  \
+    do {                                                                                       \
+        if (::xconn::log_enabled(level)) {                                                     \
+            static ::xconn::LogRateLimit xconn_log_limit_;                                     \
+            uint64_t xconn_log_suppressed_ = 0;                                                \
+            if (xconn_log_limit_.allow(::xconn::trace_now_ns(), xconn_log_suppressed_)) {      \
+                ::xconn::log(level, std::format(__VA_ARGS__), xconn_log_suppressed_);          \
+            }                                                                                  \
+        }                                                                                      \
+    } while (0)
@@ -1,9 +1,13 @@
 #pragma once
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <wampproto.h>
 
+#include "xconn_cpp/latency_histogram.hpp"
 #include "xconn_cpp/transports.hpp"
 #include "xconn_cpp/types.hpp"
 #include "xconn_cpp/url_parser.hpp"
@@ -13,25 +17,72 @@
 #include <asio.hpp>
 
 namespace xconn {
+
+// RawSocket frame types, carried in the low three bits of the first header octet.
+constexpr uint8_t FRAME_TYPE_WAMP = 0;
+constexpr uint8_t FRAME_TYPE_PING = 1;
+constexpr uint8_t FRAME_TYPE_PONG = 2;
+
+// Largest frame RawSocket can describe; the handshake may only lower it.
+constexpr size_t RAWSOCKET_MAX_LENGTH = (1 << 24);
+// Step by which the receive buffer grows while a frame payload is arriving.
+constexpr size_t RECV_CHUNK_SIZE = (64 << 10);
+// Receive buffers that grew beyond this for one large frame are released afterwards.
+constexpr size_t RECV_BUFFER_RETAIN_SIZE = (1 << 20);
+
 class SocketTransport {
    public:
     SocketTransport(asio::io_context& io, UrlParser& parser);
+    // Over a `transport` that is already connected, with the frame limits a handshake would
+    // have set; used to run the framing against a scripted peer.
+    SocketTransport(std::unique_ptr<Transport> transport, size_t max_recv_size, size_t max_send_size);
     ~SocketTransport();
     static std::shared_ptr<SocketTransport> Create(std::string& url);
 
     bool connect(const std::string& host, const std::string& port, xconn::SerializerType serializer_type,
                  int max_msg_size);
     std::vector<uint8_t> read();
+    // Reads the next WAMP frame into `payload`, reusing its capacity.
+    bool read_into(std::vector<uint8_t>& payload);
     ::Bytes read_bytes();
     bool write(::Bytes& bytes);
+    // `locked_at`, when given, receives the trace_now_ns() time the write lock was acquired.
+    bool write(const uint8_t* data, size_t size, uint64_t* locked_at = nullptr);
     void close();
     bool is_connected() const;
+    int native_handle() const { return transport_->native_handle(); }
+
+    size_t max_recv_size() const { return max_recv_size_; }
+    size_t max_send_size() const { return max_send_size_; }
+
+    void start_keepalive(KeepaliveOptions options);
+    void stop_keepalive();
+    HistogramSnapshot rtt() const;
 
    private:
     std::unique_ptr<Transport> transport_;
     std::mutex write_mutex_;
 
+    size_t max_recv_size_ = RAWSOCKET_MAX_LENGTH;
+    size_t max_send_size_ = RAWSOCKET_MAX_LENGTH;
+
+    std::thread keepalive_thread_;
+    std::mutex keepalive_mutex_;
+    std::condition_variable keepalive_cv_;
+    bool keepalive_stop_ = false;
+    // steady_clock timestamp (ns) of the PING awaiting its PONG, zero when none is outstanding.
+    std::atomic<int64_t> ping_sent_at_{0};
+    // Set by the keepalive thread when a PONG is overdue. It only shuts the transport down;
+    // the reading thread, woken by that, closes it.
+    std::atomic<bool> keepalive_expired_{false};
+    LatencyHistogram rtt_;
+
+    bool read_frame(std::vector<uint8_t>& payload);
     bool recv_exactly(uint8_t* buffer, size_t n);
+    bool recv_payload(std::vector<uint8_t>& payload, size_t length);
+    bool write_frame(uint8_t frame_type, const uint8_t* data, size_t length, uint64_t* locked_at = nullptr);
+    void handle_pong(const std::vector<uint8_t>& payload);
+    void keepalive_loop(KeepaliveOptions options);
 };
 
 }  // namespace xconn
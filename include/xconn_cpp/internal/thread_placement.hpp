@@ -0,0 +1,22 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xconn {
+
+// Parses a Linux cpulist such as "0-3,8,10-11". Malformed entries are skipped.
+std::vector<int> parse_cpu_list(std::string_view list);
+
+// The CPUs of NUMA node `node`, empty when the platform does not say.
+std::vector<int> numa_node_cpus(int node);
+
+// The NUMA node of the network interface a connected TCP socket goes out through, -1 when it
+// cannot be told: Unix sockets, loopback and virtual interfaces, or a platform without sysfs.
+int socket_numa_node(int fd);
+
+// Names the calling thread, restricts it to `cpus` unless empty, and makes it prefer memory
+// from `numa_node` unless negative. Best effort: whatever the platform refuses is logged.
+void place_current_thread(const std::string& name, const std::vector<int>& cpus, int numa_node);
+
+}  // namespace xconn
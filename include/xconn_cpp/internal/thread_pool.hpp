@@ -1,57 +1,161 @@
 #pragma once
+#include <array>
 #include <atomic>
 #include <condition_variable>
+#include <exception>
 #include <functional>
 #include <future>
 #include <mutex>
+#include <optional>
 #include <queue>
 #include <thread>
 #include <vector>
 
+#include "xconn_cpp/internal/log.hpp"
+#include "xconn_cpp/types.hpp"
+
 namespace xconn {
 
+// How a ThreadPool shares its workers between lanes, see ThreadingOptions.
+struct PoolLanes {
+    LaneScheduling scheduling = LaneScheduling::Strict;
+    std::array<uint32_t, 3> weights{8, 4, 1};
+    // Workers, in addition to the pool size, that only serve the High lane.
+    size_t high_priority_workers = 0;
+};
+
+// Workers fed from one queue per HandlerPriority. Tasks of one lane run in the order they
+// were queued; which lane a free worker serves next is set by the LaneScheduling.
 class ThreadPool {
    public:
-    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency());
+    static constexpr size_t LANES = 3;
+
+    // `on_start`, when given, runs first on each worker with the worker's index, e.g. to
+    // name it or set its affinity. Dedicated High lane workers come after the others.
+    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency(),
+                        std::function<void(size_t)> on_start = nullptr, PoolLanes lanes = {});
     ~ThreadPool();
 
     // Submit a task that returns a future
     template <typename F, typename... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result_t<F, Args...>>;
 
+    // Queues a task in the lane of `priority`, without a future to report its outcome.
+    void post(HandlerPriority priority, std::function<void()> task);
+
+    // Tasks waiting for a worker, in all lanes.
+    size_t pending() const;
+
    private:
     std::vector<std::thread> workers_;
-    std::queue<std::function<void()>> tasks_;
-    std::mutex queue_mutex_;
+    std::array<std::queue<std::function<void()>>, LANES> tasks_;
+    mutable std::mutex queue_mutex_;
     std::condition_variable condition_;
+    // Dedicated High lane workers wait here, so a lower priority task never wakes one of them
+    // instead of a worker that could run it.
+    std::condition_variable high_condition_;
     std::atomic<bool> stop_{false};
+
+    PoolLanes lanes_;
+    // Tasks each lane may still run in the current turn under LaneScheduling::Weighted.
+    std::array<uint32_t, LANES> credits_{};
+
+    void run(bool high_only);
+    // Picks the lane to serve next, if any has work. Called with queue_mutex_ held.
+    std::optional<size_t> next_lane(bool high_only);
 };
 
 // Implementation
-inline ThreadPool::ThreadPool(size_t num_threads) {
-    for (size_t i = 0; i < num_threads; ++i) {
-        workers_.emplace_back([this] {
-            while (true) {
-                std::function<void()> task;
-                {
-                    std::unique_lock<std::mutex> lock(queue_mutex_);
-                    condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
-                    if (stop_ && tasks_.empty()) return;
-                    task = std::move(tasks_.front());
-                    tasks_.pop();
-                }
-                task();
-            }
+inline ThreadPool::ThreadPool(size_t num_threads, std::function<void(size_t)> on_start, PoolLanes lanes)
+    : lanes_(lanes) {
+    for (auto& weight : lanes_.weights) {
+        if (weight == 0) weight = 1;
+    }
+    credits_ = lanes_.weights;
+
+    size_t total = num_threads + lanes_.high_priority_workers;
+    for (size_t i = 0; i < total; ++i) {
+        bool high_only = i >= num_threads;
+        workers_.emplace_back([this, i, on_start, high_only] {
+            if (on_start) on_start(i);
+            run(high_only);
         });
     }
 }
 
 inline ThreadPool::~ThreadPool() {
-    stop_ = true;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stop_ = true;
+    }
     condition_.notify_all();
+    high_condition_.notify_all();
     for (auto& w : workers_) w.join();
 }
 
+inline void ThreadPool::run(bool high_only) {
+    std::condition_variable& condition = high_only ? high_condition_ : condition_;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            std::optional<size_t> lane;
+            condition.wait(lock, [&] { return (lane = next_lane(high_only)).has_value() || stop_; });
+            if (!lane) return;
+            task = std::move(tasks_[*lane].front());
+            tasks_[*lane].pop();
+        }
+        // A posted task that throws must not take its worker, and with it the process, down.
+        try {
+            task();
+        } catch (const std::exception& e) {
+            XCONN_LOG(LogLevel::Error, "Pool task failed: {}", e.what());
+        } catch (...) {
+            XCONN_LOG(LogLevel::Error, "Pool task failed with an unknown exception");
+        }
+    }
+}
+
+inline std::optional<size_t> ThreadPool::next_lane(bool high_only) {
+    if (high_only) return tasks_[0].empty() ? std::nullopt : std::optional<size_t>(0);
+
+    if (lanes_.scheduling == LaneScheduling::Strict) {
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            if (!tasks_[lane].empty()) return lane;
+        }
+        return std::nullopt;
+    }
+
+    // A turn ends once no lane with work has credit left; then every lane gets its weight back.
+    for (int turn = 0; turn < 2; ++turn) {
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            if (!tasks_[lane].empty() && credits_[lane] > 0) {
+                --credits_[lane];
+                return lane;
+            }
+        }
+        credits_ = lanes_.weights;
+    }
+    return std::nullopt;
+}
+
+inline void ThreadPool::post(HandlerPriority priority, std::function<void()> task) {
+    auto lane = static_cast<size_t>(priority);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        tasks_[lane].push(std::move(task));
+    }
+    condition_.notify_one();
+    if (lane == 0 && lanes_.high_priority_workers > 0) high_condition_.notify_one();
+}
+
+inline size_t ThreadPool::pending() const {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    size_t total = 0;
+    for (const auto& lane : tasks_) total += lane.size();
+    return total;
+}
+
 template <typename F, typename... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result_t<F, Args...>> {
     using return_type = typename std::invoke_result_t<F, Args...>;
@@ -60,11 +164,7 @@ auto ThreadPool::enqueue(F&& f, Args&&... args) -> std::future<typename std::inv
         std::make_shared<std::packaged_task<return_type()>>(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
 
     std::future<return_type> res = task->get_future();
-    {
-        std::unique_lock<std::mutex> lock(queue_mutex_);
-        tasks_.emplace([task]() { (*task)(); });
-    }
-    condition_.notify_one();
+    post(HandlerPriority::Normal, [task]() { (*task)(); });
     return res;
 }
 
@@ -0,0 +1,124 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "xconn_cpp/compact_value.hpp"
+#include "xconn_cpp/types.hpp"
+
+namespace xconn {
+
+// WAMP message type codes used by the native encoders and decoders.
+constexpr uint64_t WAMP_MESSAGE_ERROR = 8;
+constexpr uint64_t WAMP_MESSAGE_PUBLISH = 16;
+constexpr uint64_t WAMP_MESSAGE_EVENT = 36;
+constexpr uint64_t WAMP_MESSAGE_CALL = 48;
+constexpr uint64_t WAMP_MESSAGE_RESULT = 50;
+constexpr uint64_t WAMP_MESSAGE_INVOCATION = 68;
+constexpr uint64_t WAMP_MESSAGE_YIELD = 70;
+
+// Appends CBOR, MessagePack or JSON straight from xconn values to an output buffer,
+// without building a wampproto ::Value tree first.
+//
+// Containers are written as begin_*, elements, end_*. In JSON, separator() goes between
+// elements and write_key() emits the key together with its colon; both only affect JSON.
+class WireWriter {
+   public:
+    WireWriter(SerializerType type, std::vector<uint8_t>& out) : type_(type), out_(out) {}
+
+    SerializerType type() const { return type_; }
+    std::vector<uint8_t>& buffer() { return out_; }
+
+    void begin_array(size_t size);
+    void end_array();
+    void begin_map(size_t size);
+    void end_map();
+    void separator();
+    void write_key(std::string_view key);
+
+    void write_null();
+    void write_bool(bool value);
+    void write_int(int64_t value);
+    void write_uint(uint64_t value);
+    void write_double(double value);
+    void write_string(std::string_view value);
+    void write_bytes(const uint8_t* data, size_t size);
+
+    void write_value(const Value& value);
+    void write_list(const List& list);
+    void write_dict(const Dict& dict);
+    void write_value(const CompactValue& value);
+
+    // Copies already encoded bytes of the same format.
+    void write_raw(const uint8_t* data, size_t size) { out_.insert(out_.end(), data, data + size); }
+
+   private:
+    SerializerType type_;
+    std::vector<uint8_t>& out_;
+
+    void put(uint8_t byte) { out_.push_back(byte); }
+    void put_be(uint64_t value, int width);
+    void put_text(std::string_view text) { out_.insert(out_.end(), text.begin(), text.end()); }
+    void cbor_head(uint8_t major, uint64_t value);
+    void json_string(std::string_view value);
+};
+
+// Encodes one value captured by a typed codec, see field_writer() in typed_handler.hpp.
+using FieldWriter = std::function<void(WireWriter&)>;
+
+// Arguments that are encoded by their codec when the message is written instead of being
+// held as Values. Positional entries record the index they take among all arguments.
+struct TypedPayload {
+    std::vector<std::pair<size_t, FieldWriter>> args;
+    std::vector<std::pair<std::string, FieldWriter>> kwargs;
+
+    bool empty() const { return args.empty() && kwargs.empty(); }
+
+    void set_kwarg(std::string key, FieldWriter writer) {
+        erase_kwarg(key);
+        kwargs.emplace_back(std::move(key), std::move(writer));
+    }
+
+    void erase_kwarg(std::string_view key) {
+        std::erase_if(kwargs, [key](const auto& entry) { return entry.first == key; });
+    }
+};
+
+// Writes Arguments and ArgumentsKw, omitting trailing empty elements as WAMP allows.
+// Returns how many elements it wrote so callers can size the enclosing array.
+size_t payload_fields(const List& args, const Dict& kwargs, const TypedPayload* typed = nullptr);
+void write_payload(WireWriter& writer, const List& args, const Dict& kwargs, const TypedPayload* typed = nullptr);
+
+// [CALL, Request|id, Options|dict, Procedure|uri, Arguments|list, ArgumentsKw|dict]
+void encode_call(WireWriter& writer, uint64_t request_id, const Dict& options, std::string_view procedure,
+                 const List& args, const Dict& kwargs, const TypedPayload* typed = nullptr);
+
+// [PUBLISH, Request|id, Options|dict, Topic|uri, Arguments|list, ArgumentsKw|dict]
+void encode_publish(WireWriter& writer, uint64_t request_id, const Dict& options, std::string_view topic,
+                    const List& args, const Dict& kwargs, const TypedPayload* typed = nullptr);
+
+// The Options|dict and Procedure|uri or Topic|uri of a CALL or PUBLISH, which stay the same
+// for every message sent through a prepared handle.
+std::vector<uint8_t> encode_constant_fields(SerializerType type, const Dict& options, std::string_view uri);
+
+// [CALL or PUBLISH, Request|id, <constant fields>, Arguments|list, ArgumentsKw|dict] with the
+// constant fields copied from encode_constant_fields() output of the same format.
+void encode_prepared(WireWriter& writer, uint64_t message_type, uint64_t request_id,
+                     const std::vector<uint8_t>& constant, const List& args, const Dict& kwargs,
+                     const TypedPayload* typed = nullptr);
+
+// [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list, ArgumentsKw|dict]
+void encode_yield(WireWriter& writer, uint64_t request_id, const Dict& options, const List& args,
+                  const Dict& kwargs);
+
+// [ERROR, REQUEST.Type|int, REQUEST.Request|id, Details|dict, Error|uri, Arguments|list, ArgumentsKw|dict]
+void encode_error(WireWriter& writer, uint64_t request_type, uint64_t request_id, const Dict& details,
+                  std::string_view uri, const List& args, const Dict& kwargs);
+
+void append_base64(std::vector<uint8_t>& out, const uint8_t* data, size_t size);
+
+}  // namespace xconn
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+#include "xconn_cpp/arena.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+namespace xconn {
+
+// One received WAMP message in its wire encoding. Views handed to handlers point into
+// `buffer`, so the frame is shared by every view derived from it. Anything decoded on
+// behalf of the message lives in its arena and goes away with it in one step.
+struct WireFrame {
+    SerializerType format;
+    std::vector<uint8_t> buffer;
+
+    explicit WireFrame(SerializerType format) : format(format) {}
+    WireFrame(SerializerType format, std::vector<uint8_t> buffer) : format(format), buffer(std::move(buffer)) {}
+
+    const uint8_t* begin() const { return buffer.data(); }
+    const uint8_t* end() const { return buffer.data() + buffer.size(); }
+
+    // The top-level message array.
+    ValueView root() const;
+
+    // Copies decoded text into the arena so it lives as long as the frame. Only JSON needs
+    // this, for strings containing escapes and for base64 encoded bytes.
+    std::string_view keep(std::string_view value) const {
+        std::lock_guard<std::mutex> lock(arena_mutex_);
+        char* copy = arena_.allocate_array<char>(value.size());
+        std::memcpy(copy, value.data(), value.size());
+        return {copy, value.size()};
+    }
+
+    // Per-message arena for handlers that decode into CompactValues. Not synchronized: it
+    // belongs to whichever handler the message was delivered to.
+    Arena& arena() const { return arena_; }
+
+    // Empties the frame for reuse, keeping buffer and arena memory up to `retain` bytes each.
+    void recycle(size_t retain) {
+        if (buffer.capacity() > retain) {
+            std::vector<uint8_t>().swap(buffer);
+        } else {
+            buffer.clear();
+        }
+
+        if (arena_.capacity() > retain) {
+            arena_ = Arena();
+        } else {
+            arena_.reset();
+        }
+    }
+
+   private:
+    mutable std::mutex arena_mutex_;
+    mutable Arena arena_;
+};
+
+// WAMP type code of the message in the frame, or 0 when the frame is not a WAMP message.
+uint64_t wire_message_type(const WireFrame& frame);
+
+}  // namespace xconn
@@ -0,0 +1,119 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace xconn {
+
+struct HistogramSnapshot {
+    uint64_t count = 0;
+    uint64_t min = 0;
+    uint64_t max = 0;
+    double mean = 0;
+    uint64_t p50 = 0;
+    uint64_t p90 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+};
+
+// Lock-free log-linear histogram (HDR style) of non-negative values, usually nanoseconds.
+// Every power of two is split into 16 linear buckets, so reported percentiles are within
+// 1/16 of the recorded value. Recording is a handful of relaxed atomic operations.
+class LatencyHistogram {
+   public:
+    static constexpr unsigned SUB_BUCKET_BITS = 4;
+    static constexpr uint64_t SUB_BUCKETS = uint64_t{1} << SUB_BUCKET_BITS;
+    static constexpr std::size_t NUM_BUCKETS = SUB_BUCKETS + (64 - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+    void record(uint64_t value) {
+        buckets_[bucket_index(value)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(value, std::memory_order_relaxed);
+
+        uint64_t current = min_.load(std::memory_order_relaxed);
+        while (value < current && !min_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+
+        current = max_.load(std::memory_order_relaxed);
+        while (value > current && !max_.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    HistogramSnapshot snapshot() const {
+        std::array<uint64_t, NUM_BUCKETS> counts;
+        uint64_t total = 0;
+        for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+
+        HistogramSnapshot snap;
+        if (total == 0) return snap;
+
+        snap.count = total;
+        snap.min = min_.load(std::memory_order_relaxed);
+        snap.max = max_.load(std::memory_order_relaxed);
+        snap.mean = static_cast<double>(sum_.load(std::memory_order_relaxed)) /
+                    static_cast<double>(count_.load(std::memory_order_relaxed));
+
+        snap.p50 = percentile(counts, total, snap.max, 0.50);
+        snap.p90 = percentile(counts, total, snap.max, 0.90);
+        snap.p99 = percentile(counts, total, snap.max, 0.99);
+        snap.p999 = percentile(counts, total, snap.max, 0.999);
+        return snap;
+    }
+
+    void reset() {
+        for (auto& bucket : buckets_) bucket.store(0, std::memory_order_relaxed);
+        count_.store(0, std::memory_order_relaxed);
+        sum_.store(0, std::memory_order_relaxed);
+        min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        max_.store(0, std::memory_order_relaxed);
+    }
+
+    static std::size_t bucket_index(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<std::size_t>(value);
+
+        unsigned shift = static_cast<unsigned>(std::bit_width(value)) - 1 - SUB_BUCKET_BITS;
+        uint64_t sub = (value >> shift) & (SUB_BUCKETS - 1);
+        return static_cast<std::size_t>(SUB_BUCKETS + shift * SUB_BUCKETS + sub);
+    }
+
+    // Largest value that falls into the given bucket.
+    static uint64_t bucket_upper_bound(std::size_t index) {
+        if (index < SUB_BUCKETS) return index;
+
+        uint64_t shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+        uint64_t sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+        uint64_t lower = (SUB_BUCKETS + sub) << shift;
+        return lower + ((uint64_t{1} << shift) - 1);
+    }
+
+   private:
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> min_{std::numeric_limits<uint64_t>::max()};
+    std::atomic<uint64_t> max_{0};
+
+    static uint64_t percentile(const std::array<uint64_t, NUM_BUCKETS>& counts, uint64_t total, uint64_t max,
+                               double quantile) {
+        auto target = static_cast<uint64_t>(quantile * static_cast<double>(total));
+        if (target == 0) target = 1;
+
+        uint64_t seen = 0;
+        for (std::size_t i = 0; i < NUM_BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= target) {
+                uint64_t bound = bucket_upper_bound(i);
+                return bound < max ? bound : max;
+            }
+        }
+        return max;
+    }
+};
+
+}  // namespace xconn
@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace xconn {
+
+enum class LogLevel : uint8_t { Debug, Info, Warning, Error, Off };
+
+const char* log_level_name(LogLevel level);
+
+struct LogRecord {
+    LogLevel level = LogLevel::Info;
+    // Wall clock, nanoseconds since the Unix epoch.
+    uint64_t timestamp_ns = 0;
+    std::string message;
+    // Messages from the same call site dropped by its rate limit since this one last got through.
+    uint64_t suppressed = 0;
+};
+
+// Where the library's diagnostics end up. write() is only ever called from one thread at a
+// time, the background flusher, so a sink may block without holding up the message path.
+class LogSink {
+   public:
+    virtual ~LogSink() = default;
+    virtual void write(const LogRecord& record) = 0;
+};
+
+// Default sink: one line per record on stderr.
+class StderrLogSink : public LogSink {
+   public:
+    void write(const LogRecord& record) override;
+};
+
+// Replaces the sink; nullptr discards everything. Records still queued go to the new sink.
+void set_log_sink(std::shared_ptr<LogSink> sink);
+
+// Records below `level` are dropped before they are formatted. Defaults to Info.
+void set_log_level(LogLevel level);
+LogLevel log_level();
+bool log_enabled(LogLevel level);
+
+// Queues a record for the background flusher without taking a lock. When the queue is full
+// the record is dropped and counted; the flusher reports the count once there is room again.
+void log(LogLevel level, std::string message, uint64_t suppressed = 0);
+
+// Writes out everything queued so far before returning.
+void flush_logs();
+
+// Lets through at most `per_second` messages per one second window from one call site and
+// counts the rest. Lock free and approximate under contention.
+class LogRateLimit {
+   public:
+    explicit LogRateLimit(uint32_t per_second = 10) : per_second_(per_second) {}
+
+    // On success `suppressed` is set to the number of messages refused since the last one allowed.
+    bool allow(uint64_t now_ns, uint64_t& suppressed);
+
+   private:
+    const uint32_t per_second_;
+    std::atomic<uint64_t> window_{0};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> suppressed_{0};
+};
+
+}  // namespace xconn
@@ -1,17 +1,30 @@
 #pragma once
 #include <atomic>
+#include <chrono>
+#include <coroutine>
 #include <cstddef>
+#include <functional>
 #include <future>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <span>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include <sys/types.h>
 
+#include "xconn_cpp/expected.hpp"
+#include "xconn_cpp/internal/deadline_timer.hpp"
 #include "xconn_cpp/internal/thread_pool.hpp"
+#include "xconn_cpp/latency_histogram.hpp"
+#include "xconn_cpp/session_metrics.hpp"
+#include "xconn_cpp/tracing.hpp"
+#include "xconn_cpp/typed_handler.hpp"
 #include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
 
 extern "C" {
 typedef struct wampproto_Session wampproto_Session;
@@ -23,13 +36,34 @@ namespace xconn {
 
 constexpr int TIMEOUT_SECONDS = 10;
 constexpr const char* ERROR_RUNTIME_ERROR = "wamp.error.runtime_error";
+constexpr const char* ERROR_UNAVAILABLE = "wamp.error.unavailable";
+constexpr const char* ERROR_PAYLOAD_SIZE_EXCEEDED = "wamp.error.payload_size_exceeded";
+constexpr const char* ERROR_TIMEOUT = "wamp.error.timeout";
+// A DoAsync() call whose session closed before its reply arrived.
+constexpr const char* ERROR_CONNECTION_CLOSED = "xconn.error.connection_closed";
 
 class BaseSession;
 class ThreadPool;
+struct WireFrame;
+
+// A CALL waiting for its RESULT or ERROR: either a blocked caller's promise, or the
+// callback of a CallRequest::DoAsync().
+struct PendingCall {
+    std::promise<Expected<ResultView, ApplicationError>> promise;
+    std::function<void(Expected<ResultView, ApplicationError>)> on_reply;
+
+    void complete(Expected<ResultView, ApplicationError> outcome) {
+        if (on_reply) {
+            on_reply(std::move(outcome));
+        } else {
+            promise.set_value(std::move(outcome));
+        }
+    }
+};
 
 class Session {
    public:
-    Session(std::unique_ptr<BaseSession> base_session);
+    Session(std::unique_ptr<BaseSession> base_session, const ThreadingOptions& threading = {});
     ~Session();
 
     int64_t session_id;
@@ -40,42 +74,148 @@ class Session {
     bool is_connected();
     int leave();
 
+    // Starts sending RawSocket PINGs; a link that stops answering is closed.
+    void start_keepalive(KeepaliveOptions options = {});
+    // Transport round-trip times measured from PING/PONG, in nanoseconds.
+    HistogramSnapshot rtt() const;
+
+    // Message and byte counts, outstanding requests, handler queue depth and latencies.
+    SessionMetricsSnapshot metrics();
+    // metrics() in Prometheus text format, labelled with the session ID and realm.
+    std::string prometheus_metrics();
+
+    // Records TraceStage timestamps for every CALL and INVOCATION into `sink`, e.g. a
+    // RingBufferTraceSink; nullptr turns tracing off. Off, it costs one atomic load per message.
+    void set_trace_sink(std::shared_ptr<TraceSink> sink);
+
+    // Returned by CallRequest::DoAsync(). Awaiting it sends the CALL; the coroutine is resumed
+    // on a pool worker once the reply arrives, and an ERROR reply is thrown as Do() throws it.
+    // So are ERROR_TIMEOUT, once the timeout passes first, and ERROR_CONNECTION_CLOSED.
+    class CallAwaiter {
+       public:
+        CallAwaiter(Session& session, uint64_t request_id, std::vector<uint8_t> message,
+                    std::chrono::milliseconds timeout);
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> awaiting);
+        Result await_resume();
+
+       private:
+        Session& session_;
+        uint64_t request_id_;
+        std::vector<uint8_t> message_;
+        std::chrono::milliseconds timeout_;
+        std::optional<Expected<ResultView, ApplicationError>> outcome_;
+    };
+
     class CallRequest {
        public:
         CallRequest(Session& session, std::string uri);
 
         CallRequest& Arg(xconn::Value arg);
         CallRequest& Kwarg(std::string key, xconn::Value value);
+        // Structs described with XCONN_FIELDS are encoded straight into the message.
+        template <typename T>
+            requires HasFields<T>
+        CallRequest& Arg(T value) {
+            typed_.args.emplace_back(args_.size() + typed_.args.size(), field_writer(std::move(value)));
+            return *this;
+        }
+        template <typename T>
+            requires HasFields<T>
+        CallRequest& Kwarg(std::string key, T value) {
+            kwargs_.erase(key);
+            typed_.set_kwarg(std::move(key), field_writer(std::move(value)));
+            return *this;
+        }
         CallRequest& Option(std::string key, xconn::Value value);
+        // Sends `payload` in Payload PassThru Mode, replacing any arguments. The payload is
+        // not copied until the message is written, so it must outlive Do().
+        CallRequest& PassThru(std::string scheme, std::span<const uint8_t> payload,
+                              std::string serializer = PPT_SERIALIZER_NATIVE);
 
         Result Do() const;
+        // Like Do(), but the result payload stays encoded until it is read.
+        ResultView DoView() const;
+        // Like Do() and DoView(), but an ERROR reply is returned instead of thrown, without
+        // any exception being created on the way. Timeouts and a closed connection still throw.
+        Expected<Result, ApplicationError> DoExpected() const;
+        Expected<ResultView, ApplicationError> DoViewExpected() const;
+        // Like Do(), for coroutines: co_await DoAsync() waits for the RESULT without blocking
+        // the thread. A reply that takes longer than `timeout`, or a session that closes
+        // first, resumes the coroutine with an error.
+        CallAwaiter DoAsync(std::chrono::milliseconds timeout = std::chrono::seconds(TIMEOUT_SECONDS)) const;
 
        private:
         Session& session_;
         std::string procedure_;
         List args_;
         Dict kwargs_;
+        TypedPayload typed_;
         Dict options_;
     };
 
     CallRequest Call(std::string uri);
 
+    // A CALL whose procedure and options are encoded once up front. Each Do() only encodes
+    // the request ID and the arguments.
+    class PreparedCall {
+       public:
+        PreparedCall(Session& session, std::string procedure, const Dict& options);
+
+        Result Do(const List& args = {}, const Dict& kwargs = {}) const;
+        ResultView DoView(const List& args = {}, const Dict& kwargs = {}) const;
+        Expected<Result, ApplicationError> DoExpected(const List& args = {}, const Dict& kwargs = {}) const;
+        Expected<ResultView, ApplicationError> DoViewExpected(const List& args = {}, const Dict& kwargs = {}) const;
+
+       private:
+        Session& session_;
+        std::vector<uint8_t> constant_;
+    };
+
+    PreparedCall PrepareCall(std::string procedure, const Dict& options = {});
+
     class RegisterRequest {
        public:
         RegisterRequest(Session& session, std::string uri, ProcedureHandler handler);
+        RegisterRequest(Session& session, std::string uri, ProcedureViewHandler handler);
+        RegisterRequest(Session& session, std::string uri, RawProcedureHandler handler);
+        RegisterRequest(Session& session, std::string uri, AsyncProcedureHandler handler);
 
         RegisterRequest& Option(std::string key, xconn::Value value);
+        // Pool lane the handler's invocations are queued in; Normal unless set.
+        RegisterRequest& Priority(HandlerPriority priority);
+        // Runs at most `limit` invocations of the handler at a time. Further invocations wait
+        // without holding a pool worker; once `max_queued` are waiting the rest are answered
+        // with ERROR_UNAVAILABLE. An async handler holds its slot until its reply is sent, not
+        // just until its task first suspends. Unlimited unless set.
+        RegisterRequest& Concurrency(size_t limit, size_t max_queued = SIZE_MAX);
 
         Registration Do() const;
 
        private:
         Session& session_;
         std::string procedure_;
-        ProcedureHandler handler_;
+        RawProcedureHandler handler_;
         Dict options;
+        HandlerPriority priority_ = HandlerPriority::Normal;
+        size_t concurrency_ = 0;
+        size_t max_queued_ = SIZE_MAX;
     };
 
     RegisterRequest Register(std::string procedure, ProcedureHandler handler);
+    // Registers a handler that reads arguments straight from the received INVOCATION.
+    RegisterRequest Register(std::string procedure, ProcedureViewHandler handler);
+    // Registers a coroutine handler, which may co_await other calls without holding a worker.
+    RegisterRequest Register(std::string procedure, AsyncProcedureHandler handler);
+    // Registers a statically typed handler, e.g. Register<int64_t(int64_t, int64_t)>("sum", fn).
+    // Arguments are decoded straight into the parameter types and the return value is
+    // encoded without building a List; arguments that do not match are answered with
+    // wamp.error.invalid_argument.
+    template <typename Signature, typename F>
+    RegisterRequest Register(std::string procedure, F&& handler) {
+        return RegisterRequest(*this, std::move(procedure), TypedProcedure<Signature>::wrap(std::forward<F>(handler)));
+    }
 
     void Unregister(uint64_t registration_id);
 
@@ -85,7 +225,25 @@ class Session {
 
         PublishRequest& Arg(xconn::Value arg);
         PublishRequest& Kwarg(std::string key, xconn::Value value);
+        // Structs described with XCONN_FIELDS are encoded straight into the message.
+        template <typename T>
+            requires HasFields<T>
+        PublishRequest& Arg(T value) {
+            typed_.args.emplace_back(args_.size() + typed_.args.size(), field_writer(std::move(value)));
+            return *this;
+        }
+        template <typename T>
+            requires HasFields<T>
+        PublishRequest& Kwarg(std::string key, T value) {
+            kwargs_.erase(key);
+            typed_.set_kwarg(std::move(key), field_writer(std::move(value)));
+            return *this;
+        }
         PublishRequest& Option(std::string key, xconn::Value value);
+        // Sends `payload` in Payload PassThru Mode, replacing any arguments. The payload is
+        // not copied until the message is written, so it must outlive Do().
+        PublishRequest& PassThru(std::string scheme, std::span<const uint8_t> payload,
+                                 std::string serializer = PPT_SERIALIZER_NATIVE);
         PublishRequest& Acknowledge(bool value);
 
         void Do() const;
@@ -95,27 +253,76 @@ class Session {
         std::string topic_;
         List args_;
         Dict kwargs_;
+        TypedPayload typed_;
         Dict options_;
     };
 
     PublishRequest Publish(std::string topic);
 
+    // A PUBLISH whose topic and options are encoded once up front, for topics published to
+    // at high rates. Each Do() only encodes the request ID and the arguments.
+    class PreparedPublish {
+       public:
+        PreparedPublish(Session& session, std::string topic, const Dict& options);
+
+        void Do(const List& args = {}, const Dict& kwargs = {}) const;
+
+       private:
+        Session& session_;
+        std::vector<uint8_t> constant_;
+        bool acknowledge_;
+    };
+
+    PreparedPublish PreparePublish(std::string topic, const Dict& options = {});
+
     class SubscribeRequest {
        public:
         SubscribeRequest(Session& session, std::string topic, EventHandler handler);
+        SubscribeRequest(Session& session, std::string topic, EventViewHandler handler);
+        SubscribeRequest(Session& session, std::string topic, EventBatchHandler handler);
+        SubscribeRequest(Session& session, std::string topic, EventViewBatchHandler handler);
 
         SubscribeRequest& Option(std::string key, xconn::Value value);
+        // Pool lane the handler's events are queued in; Normal unless set.
+        SubscribeRequest& Priority(HandlerPriority priority);
+        // Largest batch handed to a batch handler; DEFAULT_MAX_BATCH unless set.
+        SubscribeRequest& MaxBatch(size_t max_events);
+        // Keeps only the latest waiting event per `key`: an event whose key already has one
+        // waiting for the handler replaces it. The subscription then never has more events
+        // queued than distinct keys, however far the handler falls behind.
+        SubscribeRequest& Conflate(ConflationKey key);
 
         Subscription Do() const;
 
+        static constexpr size_t DEFAULT_MAX_BATCH = 256;
+
        private:
         Session& session_;
         std::string topic_;
-        EventHandler handler_;
+        EventViewHandler handler_;
+        EventViewBatchHandler batch_handler_;
+        ConflationKey conflation_key_;
         Dict options_;
+        HandlerPriority priority_ = HandlerPriority::Normal;
+        size_t max_batch_ = DEFAULT_MAX_BATCH;
     };
 
     SubscribeRequest Subscribe(std::string topic, EventHandler handler);
+    // Subscribes a handler that reads the payload straight from the received EVENT.
+    SubscribeRequest Subscribe(std::string topic, EventViewHandler handler);
+    // Subscribes a batch handler. Events are collected on the receive thread while the
+    // handler's previous batch is queued or running, and handed over together, oldest
+    // first, so only one batch per subscription is in the pool at a time. A batch does not
+    // wait for more events: it goes to the pool as soon as its first event arrives.
+    SubscribeRequest Subscribe(std::string topic, EventBatchHandler handler);
+    SubscribeRequest Subscribe(std::string topic, EventViewBatchHandler handler);
+    // Subscribes a statically typed handler, e.g. Subscribe<std::string, double>("ticks", fn).
+    // Events whose arguments do not match are logged and dropped.
+    template <typename... Args, typename F>
+        requires(sizeof...(Args) > 0)
+    SubscribeRequest Subscribe(std::string topic, F&& handler) {
+        return SubscribeRequest(*this, std::move(topic), typed_event_handler<Args...>(std::forward<F>(handler)));
+    }
 
     void Unsubscribe(uint64_t subscription_id);
 
@@ -130,16 +337,27 @@ class Session {
     std::promise<int> goodbye_promise;
     std::atomic<bool> goodbye_sent{false};
 
+    // Metrics and trace sinks are declared before the pool, whose queued handlers use them
+    // while it drains.
+    SessionMetrics metrics_;
+    std::atomic<TraceSink*> trace_sink_{nullptr};
+    // Every sink ever set, kept until the session goes since handlers may still hold one.
+    std::mutex trace_sinks_mutex_;
+    std::vector<std::shared_ptr<TraceSink>> trace_sinks_;
+
     std::unique_ptr<ThreadPool> pool_;
 
     std::mutex call_requests_mutex_;
-    std::unordered_map<uint64_t, std::promise<Result>> call_requests_;
+    std::unordered_map<uint64_t, PendingCall> call_requests_;
+    // Deadlines of the DoAsync() calls in call_requests_. Declared after it, so the timer
+    // thread is gone before the calls are.
+    DeadlineTimer call_deadlines_{[this](uint64_t request_id) { expire_call(request_id); }};
 
     std::mutex register_requests_mutex_;
     std::unordered_map<uint64_t, xconn::RegisterRequest> register_requests_;
 
     std::mutex registrations_mutex_;
-    std::unordered_map<uint64_t, ProcedureHandler> registrations_;
+    std::unordered_map<uint64_t, RegisteredProcedure> registrations_;
 
     std::mutex unregister_requests_mutex_;
     std::unordered_map<uint64_t, UnregisterRequest> unregister_requests_;
@@ -151,13 +369,37 @@ class Session {
     std::unordered_map<uint64_t, xconn::SubscribeRequest> subscribe_requests_;
 
     std::mutex subscriptions_mutex_;
-    std::unordered_map<uint64_t, EventHandler> subscriptions_;
+    std::unordered_map<uint64_t, SubscribedTopic> subscriptions_;
 
     std::mutex unsubscribe_requests_mutex_;
     std::unordered_map<uint64_t, UnsubscribeRequest> unsubscribe_requests_;
 
     void send_message(Message* msg);
+    void send_bytes(const std::vector<uint8_t>& bytes, uint64_t* locked_at = nullptr);
+    // Sends the YIELD or ERROR in `message` for an invocation. One over the router's message
+    // size limit is replaced with an ERROR, so the caller is answered rather than left waiting.
+    void send_reply(uint64_t request_id, std::vector<uint8_t>& message, uint64_t* locked_at = nullptr);
+    // Send an encoded CALL or PUBLISH and wait for its RESULT or acknowledgement.
+    Expected<ResultView, ApplicationError> send_call(uint64_t request_id, const std::vector<uint8_t>& message);
+    void send_publish(uint64_t request_id, const std::vector<uint8_t>& message, bool acknowledge);
     void process_incoming_message(Message* msg);
+    // Queues a task that hands the next batch of `topic`'s events to its batch handler.
+    void post_batch(const SubscribedTopic& topic);
+    // Starts an async handler's task and sends its YIELD or ERROR once it finishes.
+    void yield_async(uint64_t request_id, Task<Result> task);
+    // Runs an invocation that holds a slot of `limiter` on the pool, then passes the slot on.
+    void post_limited(std::shared_ptr<ConcurrencyLimiter> limiter, HandlerPriority priority,
+                      std::function<void()> task);
+    // Frees a slot of `limiter`, or hands it to the next invocation waiting for one.
+    void release_slot(std::shared_ptr<ConcurrencyLimiter>& limiter, HandlerPriority priority);
+    // Handles RESULT, INVOCATION, EVENT and ERROR replies to CALL without a wampproto decode;
+    // returns false for every other message.
+    bool process_incoming_frame(const std::shared_ptr<const WireFrame>& frame, uint64_t received_at);
+    TraceSink* tracer() const { return trace_sink_.load(std::memory_order_acquire); }
+    // Fails the DoAsync() call `request_id` with ERROR_TIMEOUT, unless its reply came first.
+    void expire_call(uint64_t request_id);
+    // Fails every DoAsync() call still waiting with ERROR_CONNECTION_CLOSED.
+    void fail_async_calls();
     void wait();
 
     template <typename T>
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <chrono>
+
 #include "xconn_cpp/authenticators.hpp"
 #include "xconn_cpp/types.hpp"
 
@@ -13,16 +15,37 @@ class BaseSession;
 
 constexpr std::size_t MAX_MSG_SIZE = (1 << 24);
 
+// Time spent in each phase of session establishment. When filled by a bulk connect the
+// phase durations are summed over all sessions, while `wall` is the elapsed time.
+struct ConnectTimings {
+    std::chrono::nanoseconds resolve{0};    // DNS lookup
+    std::chrono::nanoseconds transport{0};  // socket connect and RawSocket handshake
+    std::chrono::nanoseconds join{0};       // HELLO, authentication and WELCOME
+    std::chrono::nanoseconds session{0};    // Session construction
+    std::chrono::nanoseconds wall{0};
+
+    ConnectTimings& operator+=(const ConnectTimings& other) {
+        resolve += other.resolve;
+        transport += other.transport;
+        join += other.join;
+        session += other.session;
+        return *this;
+    }
+};
+
 class SessionJoiner {
    public:
-    SessionJoiner(Authenticator authenticator, SerializerType serializer_type);
+    // `max_msg_size` is the largest message we accept, announced to the router during the
+    // RawSocket handshake. RawSocket rounds it to a power of two between 512 bytes and 16 MiB.
+    SessionJoiner(Authenticator authenticator, SerializerType serializer_type, std::size_t max_msg_size = MAX_MSG_SIZE);
     ~SessionJoiner();
 
-    std::unique_ptr<BaseSession> join(std::string& uri, std::string& realm);
+    std::unique_ptr<BaseSession> join(std::string& uri, std::string& realm, ConnectTimings* timings = nullptr);
 
    private:
     Authenticator authenticator_;
     SerializerType serializer_type_;
+    std::size_t max_msg_size_;
     Serializer* serializer_;
 };
 
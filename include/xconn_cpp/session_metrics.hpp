@@ -0,0 +1,133 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xconn_cpp/alloc_accounting.hpp"
+#include "xconn_cpp/latency_histogram.hpp"
+
+namespace xconn {
+
+// Point-in-time view of a session, see Session::metrics(). Counters only grow; gauges are
+// read while the snapshot is taken. Latencies are in nanoseconds.
+struct SessionMetricsSnapshot {
+    uint64_t messages_sent = 0;
+    uint64_t bytes_sent = 0;
+    uint64_t messages_received = 0;
+    uint64_t bytes_received = 0;
+
+    uint64_t calls = 0;
+    uint64_t call_errors = 0;
+    uint64_t publishes = 0;
+    uint64_t invocations = 0;
+    uint64_t events = 0;
+    uint64_t handler_errors = 0;
+    // INVOCATIONs turned away because their registration's concurrency queue was full.
+    uint64_t invocations_rejected = 0;
+    // Calls of batch subscription handlers; events / event_batches is the mean batch size.
+    uint64_t event_batches = 0;
+    // EVENTs dropped by a conflating subscription because a newer one with the same key came in.
+    uint64_t events_conflated = 0;
+
+    size_t pending_calls = 0;
+    size_t pending_publishes = 0;
+    size_t pending_registers = 0;
+    size_t pending_unregisters = 0;
+    size_t pending_subscribes = 0;
+    size_t pending_unsubscribes = 0;
+    size_t registrations = 0;
+    size_t subscriptions = 0;
+    // Handlers waiting for a pool thread.
+    size_t pool_queue_depth = 0;
+
+    // From sending a CALL until its RESULT or ERROR is handed back to the caller.
+    HistogramSnapshot call_latency;
+    // From receiving an INVOCATION or EVENT until a pool thread starts its handler.
+    HistogramSnapshot queue_latency;
+    // Time spent inside invocation and event handlers.
+    HistogramSnapshot handler_latency;
+    // Transport PING/PONG round trips, when keepalive is on.
+    HistogramSnapshot rtt;
+
+    // Heap allocations made while serving each kind of operation, on the caller, receive and
+    // pool threads alike. Only counted in XCONN_ALLOC_ACCOUNTING builds.
+    AllocStats call_allocs;
+    AllocStats publish_allocs;
+    AllocStats invocation_allocs;
+};
+
+// Relaxed atomic counter on its own cache line, so counters bumped by different threads do
+// not contend.
+class alignas(64) MetricCounter {
+   public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+   private:
+    std::atomic<uint64_t> value_{0};
+};
+
+// Allocations charged to one kind of operation.
+class AllocCounters {
+   public:
+    void add(const AllocStats& stats) {
+        allocations_.add(stats.allocations);
+        bytes_.add(stats.bytes);
+    }
+    AllocStats value() const { return {allocations_.value(), bytes_.value()}; }
+
+   private:
+    MetricCounter allocations_;
+    MetricCounter bytes_;
+};
+
+// The counters and histograms a Session updates as messages pass through it. Every update
+// is a few relaxed atomic operations, cheap enough to stay on permanently.
+class SessionMetrics {
+   public:
+    MetricCounter messages_sent;
+    MetricCounter bytes_sent;
+    MetricCounter messages_received;
+    MetricCounter bytes_received;
+
+    MetricCounter calls;
+    MetricCounter call_errors;
+    MetricCounter publishes;
+    MetricCounter invocations;
+    MetricCounter events;
+    MetricCounter handler_errors;
+    MetricCounter invocations_rejected;
+    MetricCounter event_batches;
+    MetricCounter events_conflated;
+
+    LatencyHistogram call_latency;
+    LatencyHistogram queue_latency;
+    LatencyHistogram handler_latency;
+
+    AllocCounters call_allocs;
+    AllocCounters publish_allocs;
+    AllocCounters invocation_allocs;
+
+    void record_sent(size_t bytes) {
+        messages_sent.add();
+        bytes_sent.add(bytes);
+    }
+
+    void record_received(size_t bytes) {
+        messages_received.add();
+        bytes_received.add(bytes);
+    }
+
+    // Counters and histograms only; the session fills in the gauges.
+    SessionMetricsSnapshot snapshot() const;
+};
+
+// Renders a snapshot in the Prometheus text exposition format. Counters become *_total,
+// latencies become summaries in seconds, and `labels` are attached to every sample.
+std::string to_prometheus(const SessionMetricsSnapshot& snapshot,
+                          const std::vector<std::pair<std::string, std::string>>& labels = {});
+
+}  // namespace xconn
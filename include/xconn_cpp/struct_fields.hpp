@@ -0,0 +1,99 @@
+#pragma once
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+namespace xconn {
+
+// Name and member pointer of one field of a user struct.
+template <typename T, typename M>
+struct StructField {
+    const char* name;
+    M T::*member;
+};
+
+template <typename T, typename M>
+constexpr StructField<T, M> field(const char* name, M T::*member) {
+    return {name, member};
+}
+
+enum class StructLayout { Map, Array };
+
+// A struct is described by a constexpr xconn_struct_fields(T*) function returning a tuple
+// of StructFields, found through argument-dependent lookup, and optionally an
+// xconn_struct_layout(T*). Both are normally written by XCONN_FIELDS / XCONN_ARRAY_FIELDS.
+template <typename T>
+concept HasFields = requires(T* type) { xconn_struct_fields(type); };
+
+template <typename T>
+constexpr auto struct_fields() {
+    return xconn_struct_fields(static_cast<T*>(nullptr));
+}
+
+template <typename T>
+constexpr StructLayout struct_layout() {
+    if constexpr (requires(T* type) { xconn_struct_layout(type); }) {
+        return xconn_struct_layout(static_cast<T*>(nullptr));
+    } else {
+        return StructLayout::Map;
+    }
+}
+
+template <typename T>
+constexpr size_t struct_field_count() {
+    return std::tuple_size_v<decltype(struct_fields<T>())>;
+}
+
+// Calls f(index, field) for every described field, in declaration order.
+template <typename T, typename F>
+constexpr void for_each_field(F&& f) {
+    constexpr auto fields = struct_fields<T>();
+    [&]<size_t... I>(std::index_sequence<I...>) {
+        (f(std::integral_constant<size_t, I>{}, std::get<I>(fields)), ...);
+    }(std::make_index_sequence<std::tuple_size_v<decltype(fields)>>{});
+}
+
+}  // namespace xconn
+
+#define XCONN_FIELDS_EXPAND(...) __VA_ARGS__
+#define XCONN_FIELDS_1(T, a) ::xconn::field(#a, &T::a)
+#define XCONN_FIELDS_2(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_1(T, __VA_ARGS__))
+#define XCONN_FIELDS_3(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_2(T, __VA_ARGS__))
+#define XCONN_FIELDS_4(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_3(T, __VA_ARGS__))
+#define XCONN_FIELDS_5(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_4(T, __VA_ARGS__))
+#define XCONN_FIELDS_6(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_5(T, __VA_ARGS__))
+#define XCONN_FIELDS_7(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_6(T, __VA_ARGS__))
+#define XCONN_FIELDS_8(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_7(T, __VA_ARGS__))
+#define XCONN_FIELDS_9(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_8(T, __VA_ARGS__))
+#define XCONN_FIELDS_10(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_9(T, __VA_ARGS__))
+#define XCONN_FIELDS_11(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_10(T, __VA_ARGS__))
+#define XCONN_FIELDS_12(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_11(T, __VA_ARGS__))
+#define XCONN_FIELDS_13(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_12(T, __VA_ARGS__))
+#define XCONN_FIELDS_14(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_13(T, __VA_ARGS__))
+#define XCONN_FIELDS_15(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_14(T, __VA_ARGS__))
+#define XCONN_FIELDS_16(T, a, ...) XCONN_FIELDS_1(T, a), XCONN_FIELDS_EXPAND(XCONN_FIELDS_15(T, __VA_ARGS__))
+#define XCONN_FIELDS_PICK(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, NAME, ...) NAME
+#define XCONN_FIELDS_LIST(T, ...)                                                                                      \
+    XCONN_FIELDS_EXPAND(XCONN_FIELDS_PICK(__VA_ARGS__, XCONN_FIELDS_16, XCONN_FIELDS_15, XCONN_FIELDS_14,             \
+                                          XCONN_FIELDS_13, XCONN_FIELDS_12, XCONN_FIELDS_11, XCONN_FIELDS_10,         \
+                                          XCONN_FIELDS_9, XCONN_FIELDS_8, XCONN_FIELDS_7, XCONN_FIELDS_6,             \
+                                          XCONN_FIELDS_5, XCONN_FIELDS_4, XCONN_FIELDS_3, XCONN_FIELDS_2,             \
+                                          XCONN_FIELDS_1)(T, __VA_ARGS__))
+
+// Describes up to 16 fields of a struct, in the namespace the struct is declared in:
+//
+//     struct Quote { std::string symbol; double price; };
+//     XCONN_FIELDS(Quote, symbol, price)
+//
+// The struct is then encoded as a map keyed by field name. XCONN_ARRAY_FIELDS encodes it
+// as a list in field order instead, which is smaller but not self-describing.
+#define XCONN_FIELDS(T, ...)                                                                                           \
+    [[maybe_unused]] inline constexpr auto xconn_struct_fields(T*) {                                                   \
+        return std::make_tuple(XCONN_FIELDS_LIST(T, __VA_ARGS__));                                                     \
+    }
+
+#define XCONN_ARRAY_FIELDS(T, ...)                                                                                     \
+    XCONN_FIELDS(T, __VA_ARGS__)                                                                                       \
+    [[maybe_unused]] inline constexpr ::xconn::StructLayout xconn_struct_layout(T*) {                                  \
+        return ::xconn::StructLayout::Array;                                                                           \
+    }
@@ -0,0 +1,101 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+namespace xconn {
+
+// A coroutine producing one T, e.g. the return type of an AsyncProcedureHandler. It does not
+// start until it is awaited or detached, and while it waits in a co_await it holds no thread.
+//
+//     Task<Result> handler(Invocation invocation) {
+//         Result sum = co_await session->Call("io.xconn.add").Arg(1).Arg(2).DoAsync();
+//         co_return sum;
+//     }
+//
+// Coroutine parameters should be taken by value; a reference may dangle once the coroutine
+// first suspends.
+template <typename T>
+class Task {
+   public:
+    // Called with the value, or the exception the coroutine ended with, once a detached task finishes.
+    using Completion = std::function<void(std::optional<T> value, std::exception_ptr error)>;
+
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        // The coroutine awaiting this one, or none once detached.
+        std::coroutine_handle<> continuation;
+        Completion completion;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                promise_type& promise = handle.promise();
+                if (promise.continuation) return promise.continuation;
+
+                // Detached: nobody owns the frame any more, so it goes before the completion runs.
+                Completion completion = std::move(promise.completion);
+                std::optional<T> value = std::move(promise.value);
+                std::exception_ptr error = promise.error;
+                handle.destroy();
+                if (completion) completion(std::move(value), error);
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template <typename U>
+        void return_value(U&& result) {
+            value.emplace(std::forward<U>(result));
+        }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, nullptr)) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle_) handle_.destroy();
+            handle_ = std::exchange(other.handle_, nullptr);
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    // Starts the task and lets it run to completion on its own; `completion` runs on whichever
+    // thread finishes it, which is the calling thread if the task never suspends.
+    void detach(Completion completion) && {
+        auto handle = std::exchange(handle_, nullptr);
+        handle.promise().completion = std::move(completion);
+        handle.resume();
+    }
+
+    // Awaiting a task starts it and resumes the awaiting coroutine once it has finished.
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() {
+        promise_type& promise = handle_.promise();
+        if (promise.error) std::rethrow_exception(promise.error);
+        return std::move(*promise.value);
+    }
+
+   private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+}  // namespace xconn
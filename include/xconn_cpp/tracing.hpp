@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace xconn {
+
+// Points in the life of a CALL made by the session and of an INVOCATION served by it. The
+// gap between two consecutive stages of one request is where its time went.
+enum class TraceStage : uint8_t {
+    CallStarted,         // Do() entered, before the CALL is encoded
+    CallEncoded,         // CALL encoded, about to be written
+    CallWriteLocked,     // transport write lock acquired
+    CallWritten,         // CALL handed to the socket
+    ResultReceived,      // RESULT or ERROR read off the socket by the receive thread
+    ResultDecoded,       // reply parsed and handed to the waiting caller
+    CallCompleted,       // caller resumed with the outcome
+    InvocationReceived,  // INVOCATION read off the socket by the receive thread
+    InvocationQueued,    // parsed, matched to its registration and queued on the pool
+    HandlerStarted,      // a pool thread picked it up
+    HandlerFinished,     // handler returned and its YIELD or ERROR is encoded
+    YieldWriteLocked,    // transport write lock acquired
+    YieldWritten,        // YIELD or ERROR handed to the socket
+};
+
+const char* trace_stage_name(TraceStage stage);
+
+// Monotonic clock all trace timestamps are taken from.
+inline uint64_t trace_now_ns() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+// CALL stages carry the CALL request ID, INVOCATION stages the INVOCATION request ID.
+struct TraceEvent {
+    uint64_t request_id = 0;
+    uint64_t timestamp_ns = 0;
+    TraceStage stage = TraceStage::CallStarted;
+};
+
+// Receives trace events from the receive thread, the pool and callers alike. record() sits
+// on the message path, so it must be thread safe and must not block.
+class TraceSink {
+   public:
+    virtual ~TraceSink() = default;
+    virtual void record(const TraceEvent& event) = 0;
+};
+
+// Default sink: a fixed size ring that producers write to without locks, overwriting the
+// oldest events when it is full. drain() hands back what is still there.
+class RingBufferTraceSink : public TraceSink {
+   public:
+    // Capacity is rounded up to a power of two.
+    explicit RingBufferTraceSink(size_t capacity = 1 << 16);
+
+    void record(const TraceEvent& event) override;
+
+    // Events recorded since the last drain, oldest first. Events overwritten before they were
+    // drained, or being written while draining, are skipped and counted in dropped().
+    std::vector<TraceEvent> drain();
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+   private:
+    // `sequence` is 2 * position + 1 while the slot is written and 2 * position + 2 once it
+    // holds the event recorded at `position`.
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<uint64_t> request_id{0};
+        std::atomic<uint64_t> timestamp_ns{0};
+        std::atomic<uint8_t> stage{0};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex drain_mutex_;
+    uint64_t tail_ = 0;
+};
+
+}  // namespace xconn
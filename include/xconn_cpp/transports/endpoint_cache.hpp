@@ -0,0 +1,67 @@
+#pragma once
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include <asio.hpp>
+
+namespace xconn {
+
+// Process-wide cache of resolved TCP endpoints, so opening many sessions to the same
+// router costs a single DNS lookup.
+class EndpointCache {
+   public:
+    using Endpoints = asio::ip::tcp::resolver::results_type;
+
+    static EndpointCache& instance() {
+        static EndpointCache cache;
+        return cache;
+    }
+
+    Endpoints resolve(const std::string& host, const std::string& port) {
+        auto key = host + ":" + port;
+        auto now = std::chrono::steady_clock::now();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = entries_.find(key);
+            if (it != entries_.end() && now < it->second.expires_at) return it->second.endpoints;
+        }
+
+        asio::io_context io;
+        asio::ip::tcp::resolver resolver(io);
+        Endpoints endpoints = resolver.resolve(host, port);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_[key] = Entry{endpoints, now + ttl_};
+        return endpoints;
+    }
+
+    void invalidate(const std::string& host, const std::string& port) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.erase(host + ":" + port);
+    }
+
+    void set_ttl(std::chrono::seconds ttl) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ttl_ = ttl;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries_.clear();
+    }
+
+   private:
+    struct Entry {
+        Endpoints endpoints;
+        std::chrono::steady_clock::time_point expires_at;
+    };
+
+    std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::chrono::steady_clock::duration ttl_ = std::chrono::seconds(30);
+};
+
+}  // namespace xconn
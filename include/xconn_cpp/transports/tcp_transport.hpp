@@ -2,6 +2,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "endpoint_cache.hpp"
 #include "transport.hpp"
 
 #include <asio.hpp>
@@ -13,9 +14,14 @@ class TcpTransport : public Transport {
     explicit TcpTransport(asio::io_context& io) : socket_(io) {}
 
     void connect(const std::string& host, const std::string& port) override {
-        asio::ip::tcp::resolver resolver(socket_.get_executor());
-        auto endpoints = resolver.resolve(host, port);
-        asio::connect(socket_, endpoints);
+        auto endpoints = EndpointCache::instance().resolve(host, port);
+        try {
+            asio::connect(socket_, endpoints);
+        } catch (...) {
+            // The cached addresses may be stale, resolve again on the next attempt.
+            EndpointCache::instance().invalidate(host, port);
+            throw;
+        }
     }
 
     std::size_t read(uint8_t* buffer, std::size_t length) override {
@@ -52,6 +58,8 @@ class TcpTransport : public Transport {
 
     bool is_connected() const override { return socket_.is_open(); }
 
+    int native_handle() override { return socket_.native_handle(); }
+
    private:
     asio::ip::tcp::socket socket_;
 };
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include <sys/socket.h>
+
 namespace xconn {
 
 class Transport {
@@ -16,8 +18,17 @@ class Transport {
     virtual std::size_t write(const uint8_t* data, std::size_t length) = 0;
 
     virtual std::size_t close() = 0;
+    // Makes a read() blocked on another thread return, and every later one fail, without
+    // closing the transport; safe to call while that read is in progress, unlike close().
+    virtual void shutdown() {
+        int handle = native_handle();
+        if (handle >= 0) ::shutdown(handle, SHUT_RDWR);
+    }
 
     virtual bool is_connected() const = 0;
+
+    // The OS socket, -1 when there is none.
+    virtual int native_handle() { return -1; }
 };
 
 }  // namespace xconn
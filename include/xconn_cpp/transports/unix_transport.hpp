@@ -48,6 +48,8 @@ class UnixTransport : public Transport {
 
     bool is_connected() const override { return socket_.is_open(); }
 
+    int native_handle() override { return socket_.native_handle(); }
+
    private:
     asio::local::stream_protocol::socket socket_;
 };
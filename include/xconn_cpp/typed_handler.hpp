@@ -0,0 +1,433 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/struct_fields.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+namespace xconn {
+
+constexpr const char* ERROR_INVALID_ARGUMENT = "wamp.error.invalid_argument";
+
+template <typename T>
+struct is_optional : std::false_type {};
+template <typename T>
+struct is_optional<std::optional<T>> : std::true_type {};
+
+// Converts between a wire value and a native C++ type for statically typed handlers.
+// decode() returns false when the value does not fit T; encode() writes T to the wire.
+template <typename T, typename = void>
+struct ValueCodec;
+
+template <typename T>
+struct ValueCodec<T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>>> {
+    static constexpr const char* name = "integer";
+
+    static bool decode(const ValueView& value, T& out) {
+        if constexpr (std::is_signed_v<T>) {
+            auto number = value.getInt64();
+            if (!number || *number < std::numeric_limits<T>::min() || *number > std::numeric_limits<T>::max())
+                return false;
+            out = static_cast<T>(*number);
+        } else {
+            auto number = value.getUInt64();
+            if (!number || *number > std::numeric_limits<T>::max()) return false;
+            out = static_cast<T>(*number);
+        }
+        return true;
+    }
+
+    static void encode(WireWriter& writer, T value) {
+        if constexpr (std::is_signed_v<T>) {
+            writer.write_int(value);
+        } else {
+            writer.write_uint(value);
+        }
+    }
+};
+
+template <typename T>
+struct ValueCodec<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    static constexpr const char* name = "number";
+
+    // Integers are accepted too: JSON peers commonly send 2 for 2.0.
+    static bool decode(const ValueView& value, T& out) {
+        if (auto number = value.getDouble()) {
+            out = static_cast<T>(*number);
+        } else if (auto integer = value.getInt64()) {
+            out = static_cast<T>(*integer);
+        } else if (auto unsigned_integer = value.getUInt64()) {
+            out = static_cast<T>(*unsigned_integer);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static void encode(WireWriter& writer, T value) { writer.write_double(value); }
+};
+
+template <>
+struct ValueCodec<bool> {
+    static constexpr const char* name = "bool";
+
+    static bool decode(const ValueView& value, bool& out) {
+        auto flag = value.getBool();
+        if (!flag) return false;
+        out = *flag;
+        return true;
+    }
+
+    static void encode(WireWriter& writer, bool value) { writer.write_bool(value); }
+};
+
+template <>
+struct ValueCodec<std::string> {
+    static constexpr const char* name = "string";
+
+    static bool decode(const ValueView& value, std::string& out) {
+        auto text = value.getString();
+        if (!text) return false;
+        out.assign(*text);
+        return true;
+    }
+
+    static void encode(WireWriter& writer, const std::string& value) { writer.write_string(value); }
+};
+
+// Points into the received message; only valid for the duration of the handler call.
+template <>
+struct ValueCodec<std::string_view> {
+    static constexpr const char* name = "string";
+
+    static bool decode(const ValueView& value, std::string_view& out) {
+        auto text = value.getString();
+        if (!text) return false;
+        out = *text;
+        return true;
+    }
+
+    static void encode(WireWriter& writer, std::string_view value) { writer.write_string(value); }
+};
+
+template <>
+struct ValueCodec<Bytes> {
+    static constexpr const char* name = "bytes";
+
+    static bool decode(const ValueView& value, Bytes& out) {
+        auto bytes = value.getBytes();
+        if (!bytes) return false;
+        out.assign(bytes->begin(), bytes->end());
+        return true;
+    }
+
+    static void encode(WireWriter& writer, const Bytes& value) { writer.write_bytes(value.data(), value.size()); }
+};
+
+template <typename T>
+struct ValueCodec<std::vector<T>, std::enable_if_t<!std::is_same_v<T, uint8_t>>> {
+    static constexpr const char* name = "list";
+
+    static bool decode(const ValueView& value, std::vector<T>& out) {
+        if (value.kind() != ValueKind::List) return false;
+
+        out.clear();
+        bool ok = true;
+        value.forEach([&](const ValueView& item) {
+            if (!ok) return;
+            T element{};
+            ok = ValueCodec<T>::decode(item, element);
+            if (ok) out.push_back(std::move(element));
+        });
+        return ok;
+    }
+
+    static void encode(WireWriter& writer, const std::vector<T>& value) {
+        writer.begin_array(value.size());
+        for (size_t i = 0; i < value.size(); ++i) {
+            if (i) writer.separator();
+            ValueCodec<T>::encode(writer, value[i]);
+        }
+        writer.end_array();
+    }
+};
+
+// A missing or null value decodes as nullopt.
+template <typename T>
+struct ValueCodec<std::optional<T>> {
+    static constexpr const char* name = ValueCodec<T>::name;
+
+    static bool decode(const ValueView& value, std::optional<T>& out) {
+        if (!value.isValid() || value.isNull()) {
+            out.reset();
+            return true;
+        }
+        T inner{};
+        if (!ValueCodec<T>::decode(value, inner)) return false;
+        out = std::move(inner);
+        return true;
+    }
+
+    static void encode(WireWriter& writer, const std::optional<T>& value) {
+        if (value) {
+            ValueCodec<T>::encode(writer, *value);
+        } else {
+            writer.write_null();
+        }
+    }
+};
+
+// Dynamically typed escape hatches.
+template <>
+struct ValueCodec<Value> {
+    static constexpr const char* name = "value";
+
+    static bool decode(const ValueView& value, Value& out) {
+        out = value.toValue();
+        return true;
+    }
+
+    static void encode(WireWriter& writer, const Value& value) { writer.write_value(value); }
+};
+
+template <>
+struct ValueCodec<List> {
+    static constexpr const char* name = "list";
+
+    static bool decode(const ValueView& value, List& out) {
+        if (value.kind() != ValueKind::List) return false;
+        out = value.toList();
+        return true;
+    }
+
+    static void encode(WireWriter& writer, const List& value) { writer.write_list(value); }
+};
+
+template <>
+struct ValueCodec<Dict> {
+    static constexpr const char* name = "dict";
+
+    static bool decode(const ValueView& value, Dict& out) {
+        if (value.kind() != ValueKind::Dict) return false;
+        out = value.toDict();
+        return true;
+    }
+
+    static void encode(WireWriter& writer, const Dict& value) { writer.write_dict(value); }
+};
+
+// Structs described with XCONN_FIELDS or XCONN_ARRAY_FIELDS. Maps are matched by key, so
+// unknown keys are ignored and fields may arrive in any order; either way a missing field
+// is only accepted when it is a std::optional.
+template <typename T>
+struct ValueCodec<T, std::enable_if_t<HasFields<T>>> {
+    static constexpr bool as_array = struct_layout<T>() == StructLayout::Array;
+    static constexpr size_t count = struct_field_count<T>();
+    static constexpr const char* name = as_array ? "list" : "dict";
+
+    static bool decode(const ValueView& value, T& out) {
+        std::array<bool, count> seen{};
+        bool ok = true;
+
+        if (value.kind() == ValueKind::Dict && !as_array) {
+            value.forEach([&](std::string_view key, const ValueView& item) {
+                for_each_field<T>([&](auto index, const auto& field) {
+                    if (!ok || key != field.name) return;
+                    seen[index] = true;
+                    ok = ValueCodec<std::decay_t<decltype(out.*field.member)>>::decode(item, out.*field.member);
+                });
+            });
+        } else if (value.kind() == ValueKind::List && as_array) {
+            if (value.size() > count) return false;
+
+            size_t position = 0;
+            value.forEach([&](const ValueView& item) {
+                for_each_field<T>([&](auto index, const auto& field) {
+                    if (!ok || index != position) return;
+                    seen[index] = true;
+                    ok = ValueCodec<std::decay_t<decltype(out.*field.member)>>::decode(item, out.*field.member);
+                });
+                ++position;
+            });
+        } else {
+            return false;
+        }
+
+        for_each_field<T>([&](auto index, const auto& field) {
+            using M = std::decay_t<decltype(out.*field.member)>;
+            if (seen[index]) return;
+            if constexpr (is_optional<M>::value) {
+                (out.*field.member).reset();
+            } else {
+                ok = false;
+            }
+        });
+        return ok;
+    }
+
+    static void encode(WireWriter& writer, const T& value) {
+        if constexpr (as_array) {
+            writer.begin_array(count);
+        } else {
+            writer.begin_map(count);
+        }
+
+        for_each_field<T>([&](auto index, const auto& field) {
+            if (index != 0) writer.separator();
+            if constexpr (!as_array) writer.write_key(field.name);
+            ValueCodec<std::decay_t<decltype(value.*field.member)>>::encode(writer, value.*field.member);
+        });
+
+        if constexpr (as_array) {
+            writer.end_array();
+        } else {
+            writer.end_map();
+        }
+    }
+};
+
+// Decodes a received value into T, e.g. value_as<Quote>(result.arg(0)).
+template <typename T>
+std::optional<T> value_as(const ValueView& value) {
+    T out{};
+    if (!ValueCodec<T>::decode(value, out)) return std::nullopt;
+    return out;
+}
+
+// Captures a typed value to be encoded when its message is written.
+template <typename T>
+FieldWriter field_writer(T value) {
+    return [value = std::move(value)](WireWriter& writer) { ValueCodec<T>::encode(writer, value); };
+}
+
+template <typename T>
+struct is_tuple : std::false_type {};
+template <typename... Ts>
+struct is_tuple<std::tuple<Ts...>> : std::true_type {};
+
+// Decodes positional arguments into `out`. On a mismatch returns false and describes the
+// first offending argument in `error`.
+template <typename Tuple, size_t... I>
+bool decode_arguments(const ValueView& args, Tuple& out, std::string& error, std::index_sequence<I...>) {
+    constexpr size_t count = sizeof...(I);
+
+    std::array<ValueView, count + 1> views{};
+    size_t received = 0;
+    args.forEach([&](const ValueView& item) {
+        if (received < views.size()) views[received] = item;
+        ++received;
+    });
+
+    if (received > count) {
+        error = "expected at most " + std::to_string(count) + " arguments, got " + std::to_string(received);
+        return false;
+    }
+
+    auto decode_one = [&](auto index, auto& target) {
+        using T = std::decay_t<decltype(target)>;
+        const ValueView& view = views[index];
+        if (!view.isValid() && !is_optional<T>::value) {
+            error = "missing argument " + std::to_string(index + 1) + ", expected " + ValueCodec<T>::name;
+            return false;
+        }
+        if (!ValueCodec<T>::decode(view, target)) {
+            error = "argument " + std::to_string(index + 1) + ": expected " + ValueCodec<T>::name;
+            return false;
+        }
+        return true;
+    };
+    return (decode_one(I, std::get<I>(out)) && ...);
+}
+
+template <typename... Args>
+bool decode_arguments(const ValueView& args, std::tuple<Args...>& out, std::string& error) {
+    return decode_arguments(args, out, error, std::index_sequence_for<Args...>{});
+}
+
+// [YIELD, INVOCATION.Request|id, Options|dict, Arguments|list] with the return value, or
+// each element of a returned tuple, as the positional results.
+template <typename R>
+void encode_typed_yield(WireWriter& writer, uint64_t request_id, const R& result) {
+    writer.begin_array(4);
+    writer.write_uint(WAMP_MESSAGE_YIELD);
+    writer.separator();
+    writer.write_uint(request_id);
+    writer.separator();
+    writer.begin_map(0);
+    writer.end_map();
+    writer.separator();
+
+    if constexpr (is_tuple<R>::value) {
+        writer.begin_array(std::tuple_size_v<R>);
+        std::apply(
+            [&writer](const auto&... items) {
+                bool first = true;
+                auto write_one = [&](const auto& item) {
+                    if (!first) writer.separator();
+                    first = false;
+                    ValueCodec<std::decay_t<decltype(item)>>::encode(writer, item);
+                };
+                (write_one(items), ...);
+            },
+            result);
+    } else {
+        writer.begin_array(1);
+        ValueCodec<R>::encode(writer, result);
+    }
+
+    writer.end_array();
+    writer.end_array();
+}
+
+template <typename Signature>
+struct TypedProcedure;
+
+template <typename R, typename... Args>
+struct TypedProcedure<R(Args...)> {
+    template <typename F>
+    static RawProcedureHandler wrap(F fn) {
+        return [fn = std::move(fn)](const InvocationView& invocation, WireWriter& writer) mutable {
+            std::tuple<std::decay_t<Args>...> args;
+            std::string error;
+            if (!decode_arguments(invocation.args(), args, error)) {
+                encode_error(writer, WAMP_MESSAGE_INVOCATION, invocation.request_id, Dict(), ERROR_INVALID_ARGUMENT,
+                             List{error}, Dict());
+                return;
+            }
+
+            if constexpr (std::is_void_v<R>) {
+                std::apply(fn, std::move(args));
+                encode_yield(writer, invocation.request_id, Dict(), List(), Dict());
+            } else {
+                R result = std::apply(fn, std::move(args));
+                encode_typed_yield(writer, invocation.request_id, result);
+            }
+        };
+    }
+};
+
+template <typename... Args, typename F>
+EventViewHandler typed_event_handler(F fn) {
+    return [fn = std::move(fn)](const EventView& event) mutable {
+        std::tuple<std::decay_t<Args>...> args;
+        std::string error;
+        if (!decode_arguments(event.args(), args, error)) throw std::invalid_argument(error);
+
+        std::apply(fn, std::move(args));
+    };
+}
+
+}  // namespace xconn
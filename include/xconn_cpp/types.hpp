@@ -1,22 +1,77 @@
 #pragma once
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <future>
 #include <iostream>
 #include <memory>
 #include <optional>
+#include <span>
 #include <sstream>
 #include <string>
 #include <unordered_map>
 #include <variant>
 #include <vector>
 
+#include "xconn_cpp/task.hpp"
+
 namespace xconn {
 
 enum class SerializerType { JSON = 1, MSGPACK = 2, CBOR = 3 };
 
+// RawSocket PING scheduling. A PING left unanswered for longer than `timeout` marks the
+// link as dead and closes the transport.
+struct KeepaliveOptions {
+    std::chrono::milliseconds interval{1000};
+    std::chrono::milliseconds timeout{2000};
+};
+
+// Lane of the handler pool an invocation or event handler is queued in. A handler only ever
+// waits behind handlers of its own or a higher priority that arrived before it.
+enum class HandlerPriority : uint8_t { High, Normal, Low };
+
+// How pool workers pick between the priority lanes.
+enum class LaneScheduling : uint8_t {
+    // Always the highest priority lane that has work; low lanes wait as long as high ones are busy.
+    Strict,
+    // Lanes take turns, each running up to its weight in handlers, so none is starved.
+    Weighted,
+};
+
+// Placement of the receive thread and handler pool a Session starts. Anything the platform
+// refuses is logged and skipped; the session still runs.
+struct ThreadingOptions {
+    static constexpr int NUMA_NODE_ANY = -1;
+    // The node of the network interface the TCP connection goes out through, if it reports one.
+    static constexpr int NUMA_NODE_NIC = -2;
+
+    // CPUs the receive thread may run on; empty leaves it to the scheduler.
+    std::vector<int> receive_cpus;
+    // CPUs the pool workers may run on; empty leaves them to the scheduler.
+    std::vector<int> worker_cpus;
+    // Pins worker i to worker_cpus[i % size] alone instead of letting all share the set.
+    bool pin_workers_individually = false;
+    // Pool size; 0 means std::thread::hardware_concurrency().
+    std::size_t worker_threads = 0;
+    // Extra workers that only run High priority handlers, so those do not wait for a worker
+    // held up by a slow handler of lower priority.
+    std::size_t high_priority_workers = 0;
+    LaneScheduling lane_scheduling = LaneScheduling::Strict;
+    // Handlers per turn for the High, Normal and Low lanes under LaneScheduling::Weighted.
+    std::array<uint32_t, 3> lane_weights{8, 4, 1};
+    // Threads are named "<prefix>-recv" and "<prefix>-w<N>", cut to the platform limit.
+    std::string name_prefix = "xconn";
+    // Node the threads allocate from, and whose CPUs they use when no CPU set is given.
+    // Receive frames are allocated by the receive thread, so they land there too.
+    int numa_node = NUMA_NODE_ANY;
+};
+
 struct Value;   // forward declaration
 class Session;  // forward declaration
+class ConcurrencyLimiter;
+class EventBatcher;
 
 using Bytes = std::vector<uint8_t>;
 class List;
@@ -236,6 +291,7 @@ class ApplicationError : public std::exception {
         }
     }
 
+    const std::string& uri() const noexcept { return message_; }
     const List& list() const noexcept { return list_; }
     const Dict& dict() const noexcept { return dict_; }
 };
@@ -310,6 +366,14 @@ class Result : public ArgsHelper, public KwargsHelper {
     Result(List args_, Dict kwargs_, Dict details_);
 };
 
+// WAMP Payload PassThru Mode carries an application payload, such as a protobuf message,
+// as the only argument without interpreting it. ppt_scheme and ppt_serializer describe it.
+constexpr const char* PPT_SERIALIZER_NATIVE = "native";
+
+// A result answering with a passthru payload. The bytes are moved into the result and
+// copied once, when the YIELD is written.
+Result passthru_result(std::string scheme, Bytes payload, std::string serializer = PPT_SERIALIZER_NATIVE);
+
 struct Registration {
     uint64_t registration_id;
     Session& session;
@@ -320,13 +384,28 @@ struct Registration {
 };
 
 using ProcedureHandler = std::function<Result(const Invocation&)>;
+// A coroutine handler; the YIELD is sent when its Task finishes, and it holds no pool worker
+// while it awaits, e.g. a nested CallRequest::DoAsync().
+using AsyncProcedureHandler = std::function<Task<Result>(Invocation)>;
+
+class InvocationView;  // lazily decoded INVOCATION, see value_view.hpp
+using ProcedureViewHandler = std::function<Result(const InvocationView&)>;
+
+class WireWriter;  // see internal/wire_encoder.hpp
+// Writes the complete YIELD or ERROR for an invocation. Every other handler kind is
+// adapted to this one when registered.
+using RawProcedureHandler = std::function<void(const InvocationView&, WireWriter&)>;
 
 struct RegisterRequest {
     std::promise<Registration> promise;
-    ProcedureHandler handler;
-
-    RegisterRequest(std::promise<Registration> promise, ProcedureHandler handler)
-        : promise(std::move(promise)), handler(std::move(handler)) {}
+    RawProcedureHandler handler;
+    HandlerPriority priority;
+    std::shared_ptr<ConcurrencyLimiter> limiter;
+
+    RegisterRequest(std::promise<Registration> promise, RawProcedureHandler handler,
+                    HandlerPriority priority = HandlerPriority::Normal,
+                    std::shared_ptr<ConcurrencyLimiter> limiter = nullptr)
+        : promise(std::move(promise)), handler(std::move(handler)), priority(priority), limiter(std::move(limiter)) {}
 };
 
 struct UnregisterRequest {
@@ -351,6 +430,15 @@ class Event : public ArgsHelper, public KwargsHelper {
 
 using EventHandler = std::function<void(const Event&)>;
 
+class EventView;  // lazily decoded EVENT, see value_view.hpp
+using EventViewHandler = std::function<void(const EventView&)>;
+// Batch subscriptions get every event that arrived since their previous batch in one call.
+using EventBatchHandler = std::function<void(std::span<const Event>)>;
+using EventViewBatchHandler = std::function<void(std::span<const EventView>)>;
+// Picks the key a conflating subscription keeps only the latest event for, e.g. args[0].
+// Runs on the receive thread, so it should only read the event.
+using ConflationKey = std::function<std::string(const EventView&)>;
+
 struct Subscription {
     uint64_t subscription_id;
     Session& session;
@@ -362,7 +450,29 @@ struct Subscription {
 
 struct SubscribeRequest {
     std::promise<Subscription> promise;
-    EventHandler handler;
+    EventViewHandler handler;
+    HandlerPriority priority = HandlerPriority::Normal;
+    EventViewBatchHandler batch_handler;
+    std::shared_ptr<EventBatcher> batcher;
+    ConflationKey conflation_key;
+};
+
+// A subscription's handler and the pool lane it runs in. Batch and conflating subscriptions
+// have a batch_handler and the batcher their events wait in instead of a handler.
+struct SubscribedTopic {
+    EventViewHandler handler;
+    HandlerPriority priority = HandlerPriority::Normal;
+    EventViewBatchHandler batch_handler;
+    std::shared_ptr<EventBatcher> batcher;
+    ConflationKey conflation_key;
+};
+
+// A registered procedure's handler, its lane and, when it has a concurrency limit, the
+// limiter its invocations pass through.
+struct RegisteredProcedure {
+    RawProcedureHandler handler;
+    HandlerPriority priority = HandlerPriority::Normal;
+    std::shared_ptr<ConcurrencyLimiter> limiter;
 };
 
 struct UnsubscribeRequest {
@@ -0,0 +1,178 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+#include "xconn_cpp/compact_value.hpp"
+#include "xconn_cpp/types.hpp"
+
+namespace xconn {
+
+struct WireFrame;  // a received message and the buffer it was read into
+
+enum class ValueKind { Invalid, Null, Int, UInt, Double, String, Bool, Bytes, List, Dict };
+
+// Read-only view of one encoded value inside a received frame. Nothing is decoded until it
+// is asked for: strings and bytes are returned as views over the receive buffer, and lists
+// and dicts are walked in place. A view stays valid as long as the message view it came
+// from (InvocationView, EventView, ResultView) or a copy of it is alive.
+//
+// A missing element yields an Invalid view, on which every getter returns nullopt.
+class ValueView {
+   public:
+    ValueView() = default;
+    ValueView(const WireFrame* frame, const uint8_t* pos) : frame_(frame), pos_(pos) {}
+
+    ValueKind kind() const;
+    bool isValid() const { return pos_ != nullptr; }
+    bool isNull() const { return kind() == ValueKind::Null; }
+
+    std::optional<int64_t> getInt64() const;
+    std::optional<uint64_t> getUInt64() const;
+    std::optional<double> getDouble() const;
+    std::optional<bool> getBool() const;
+    std::optional<std::string_view> getString() const;
+    std::optional<std::span<const uint8_t>> getBytes() const;
+
+    // Element count of a list or dict, zero for anything else.
+    size_t size() const;
+    // List element by position, or dict value by key.
+    ValueView at(size_t index) const;
+    ValueView get(std::string_view key) const;
+
+    // Calls f(ValueView) for every list element, or f(std::string_view, ValueView) for
+    // every dict entry.
+    template <typename F>
+    void forEach(F&& f) const {
+        iterate(
+            [](void* context, std::string_view key, const ValueView& value) {
+                auto& callback = *static_cast<std::remove_reference_t<F>*>(context);
+                if constexpr (std::is_invocable_v<F, std::string_view, const ValueView&>) {
+                    callback(key, value);
+                } else {
+                    callback(value);
+                }
+            },
+            &f);
+    }
+
+    // Decodes the viewed value into the owning xconn types. Containers nested deeper than
+    // the frame walker follows decode as invalid, like other malformed input.
+    Value toValue() const;
+    List toList() const;
+    Dict toDict() const;
+    // Decodes the viewed value into an arena, without per-value heap allocations.
+    CompactValue toCompact(Arena& arena) const;
+
+   private:
+    const WireFrame* frame_ = nullptr;
+    const uint8_t* pos_ = nullptr;
+
+    // The decoders above, for a value `depth` containers down.
+    Value toValue(int depth) const;
+    List toList(int depth) const;
+    Dict toDict(int depth) const;
+    CompactValue toCompact(Arena& arena, int depth) const;
+
+    using IterateCallback = void (*)(void*, std::string_view, const ValueView&);
+    void iterate(IterateCallback callback, void* context) const;
+};
+
+// Payload of a message sent in Payload PassThru Mode.
+struct PassThruView {
+    std::string_view scheme;
+    std::string_view serializer;
+    std::span<const uint8_t> payload;
+};
+
+// Arguments, keyword arguments and details of a received message, decoded on access.
+class PayloadView {
+   public:
+    const ValueView& args() const { return args_; }
+    const ValueView& kwargs() const { return kwargs_; }
+    const ValueView& details() const { return details_; }
+
+    ValueView arg(size_t index) const { return args_.at(index); }
+    std::optional<std::string_view> argString(size_t index) const { return arg(index).getString(); }
+    std::optional<bool> argBool(size_t index) const { return arg(index).getBool(); }
+    std::optional<int64_t> argInt64(size_t index) const { return arg(index).getInt64(); }
+    std::optional<uint64_t> argUInt64(size_t index) const { return arg(index).getUInt64(); }
+    std::optional<double> argDouble(size_t index) const { return arg(index).getDouble(); }
+    std::optional<std::span<const uint8_t>> argBytes(size_t index) const { return arg(index).getBytes(); }
+
+    ValueView kwarg(std::string_view key) const { return kwargs_.get(key); }
+    std::optional<std::string_view> kwargString(std::string_view key) const { return kwarg(key).getString(); }
+    std::optional<bool> kwargBool(std::string_view key) const { return kwarg(key).getBool(); }
+    std::optional<int64_t> kwargInt64(std::string_view key) const { return kwarg(key).getInt64(); }
+    std::optional<uint64_t> kwargUInt64(std::string_view key) const { return kwarg(key).getUInt64(); }
+    std::optional<double> kwargDouble(std::string_view key) const { return kwarg(key).getDouble(); }
+    std::optional<std::span<const uint8_t>> kwargBytes(std::string_view key) const {
+        return kwarg(key).getBytes();
+    }
+
+    // The payload when the sender used Payload PassThru Mode, nullopt otherwise. With CBOR
+    // and MessagePack it points straight into the received message.
+    std::optional<PassThruView> passThru() const;
+
+    // Arena of the received message. CompactValues decoded into it with toCompact() are
+    // released together with the message, without any per-value frees.
+    Arena& arena() const;
+
+   protected:
+    std::shared_ptr<const WireFrame> frame_;
+    ValueView details_;
+    ValueView args_;
+    ValueView kwargs_;
+};
+
+// [INVOCATION, Request|id, REGISTERED.Registration|id, Details|dict, Arguments|list, ArgumentsKw|dict]
+class InvocationView : public PayloadView {
+   public:
+    explicit InvocationView(std::shared_ptr<const WireFrame> frame);
+
+    uint64_t request_id = 0;
+    uint64_t registration_id = 0;
+
+    Invocation toInvocation() const;
+};
+
+// [EVENT, SUBSCRIBED.Subscription|id, PUBLISHED.Publication|id, Details|dict, Arguments|list, ArgumentsKw|dict]
+class EventView : public PayloadView {
+   public:
+    explicit EventView(std::shared_ptr<const WireFrame> frame);
+
+    uint64_t subscription_id = 0;
+    uint64_t publication_id = 0;
+
+    Event toEvent() const;
+};
+
+// [RESULT, CALL.Request|id, Details|dict, Arguments|list, ArgumentsKw|dict]
+class ResultView : public PayloadView {
+   public:
+    ResultView() = default;
+    explicit ResultView(std::shared_ptr<const WireFrame> frame);
+
+    uint64_t request_id = 0;
+
+    Result toResult() const;
+};
+
+// [ERROR, REQUEST.Type|int, REQUEST.Request|id, Details|dict, Error|uri, Arguments|list, ArgumentsKw|dict]
+class ErrorView : public PayloadView {
+   public:
+    explicit ErrorView(std::shared_ptr<const WireFrame> frame);
+
+    uint64_t request_type = 0;
+    uint64_t request_id = 0;
+    std::string_view uri;
+
+    ApplicationError toError() const;
+};
+
+}  // namespace xconn
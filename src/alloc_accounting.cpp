@@ -0,0 +1,133 @@
+#include "xconn_cpp/alloc_accounting.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+#ifdef XCONN_ALLOC_ACCOUNTING
+
+namespace {
+
+// Trivially constructible, so touching it from inside malloc never runs a TLS initialiser.
+struct ThreadCounts {
+    uint64_t allocations;
+    uint64_t bytes;
+};
+
+thread_local ThreadCounts thread_counts;
+std::atomic<uint64_t> process_allocations{0};
+std::atomic<uint64_t> process_bytes{0};
+
+void count(size_t size) noexcept {
+    ++thread_counts.allocations;
+    thread_counts.bytes += size;
+    process_allocations.fetch_add(1, std::memory_order_relaxed);
+    process_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+}  // namespace
+
+#if defined(__GLIBC__)
+
+// glibc exports its allocator under these names, which lets the replacements below forward
+// to it. Every malloc in the process, wampproto's included, comes through here.
+extern "C" {
+
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* pointer, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* pointer);
+
+void* malloc(size_t size) {
+    count(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t n, size_t size) {
+    count(n * size);
+    return __libc_calloc(n, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    count(size);
+    return __libc_realloc(pointer, size);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    count(size);
+    return __libc_memalign(alignment, size);
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    count(size);
+    void* pointer = __libc_memalign(alignment, size);
+    if (!pointer) return ENOMEM;
+    *out = pointer;
+    return 0;
+}
+
+void free(void* pointer) { __libc_free(pointer); }
+}
+
+static void* raw_allocate(size_t size) { return __libc_malloc(size); }
+static void raw_free(void* pointer) { __libc_free(pointer); }
+
+#else
+
+static void* raw_allocate(size_t size) { return std::malloc(size); }
+static void raw_free(void* pointer) { std::free(pointer); }
+
+#endif
+
+// Counted here and handed straight to the underlying allocator, so glibc builds do not count
+// a C++ allocation twice.
+void* operator new(size_t size) {
+    count(size);
+    if (void* pointer = raw_allocate(size ? size : 1)) return pointer;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    count(size);
+    return raw_allocate(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept { return operator new(size, tag); }
+
+void operator delete(void* pointer) noexcept { raw_free(pointer); }
+void operator delete[](void* pointer) noexcept { raw_free(pointer); }
+void operator delete(void* pointer, size_t) noexcept { raw_free(pointer); }
+void operator delete[](void* pointer, size_t) noexcept { raw_free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { raw_free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { raw_free(pointer); }
+
+#endif
+
+namespace xconn {
+
+#ifdef XCONN_ALLOC_ACCOUNTING
+
+bool alloc_accounting_enabled() { return true; }
+
+AllocStats thread_alloc_stats() { return {thread_counts.allocations, thread_counts.bytes}; }
+
+AllocStats process_alloc_stats() {
+    return {process_allocations.load(std::memory_order_relaxed), process_bytes.load(std::memory_order_relaxed)};
+}
+
+#else
+
+bool alloc_accounting_enabled() { return false; }
+
+AllocStats thread_alloc_stats() { return {}; }
+
+AllocStats process_alloc_stats() { return {}; }
+
+#endif
+
+}  // namespace xconn
@@ -0,0 +1,46 @@
+#include "xconn_cpp/arena.hpp"
+
+#include <algorithm>
+
+namespace xconn {
+
+static std::size_t align_up(std::size_t value, std::size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void* Arena::allocate(std::size_t size, std::size_t alignment) {
+    if (size == 0) size = 1;
+
+    // Try the current block, then any block left over from before the last reset.
+    for (; current_ < blocks_.size(); ++current_, offset_ = 0) {
+        Block& block = blocks_[current_];
+        auto base = reinterpret_cast<std::uintptr_t>(block.data.get());
+        std::size_t start = align_up(base + offset_, alignment) - base;
+        if (start + size <= block.size) {
+            offset_ = start + size;
+            used_ += size;
+            return block.data.get() + start;
+        }
+    }
+
+    std::size_t block_size = std::max(block_size_, size + alignment);
+    // Not make_unique: the block does not need to be zeroed.
+    blocks_.push_back(Block{std::unique_ptr<std::byte[]>(new std::byte[block_size]), block_size});
+    current_ = blocks_.size() - 1;
+    offset_ = 0;
+    return allocate(size, alignment);
+}
+
+void Arena::reset() {
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+std::size_t Arena::capacity() const {
+    std::size_t total = 0;
+    for (const auto& block : blocks_) total += block.size;
+    return total;
+}
+
+}  // namespace xconn
@@ -1,10 +1,16 @@
 #include "xconn_cpp/internal/base_session.hpp"
 
+#include <cstring>
+
 namespace xconn {
 
 BaseSession::BaseSession(std::shared_ptr<SocketTransport> transport, const SessionDetails* session_details,
-                         Serializer* serializer)
-    : transport_(transport), session_details_(session_details), serializer(serializer) {}
+                         Serializer* serializer, SerializerType serializer_type)
+    : transport_(transport),
+      session_details_(session_details),
+      serializer(serializer),
+      serializer_type(serializer_type),
+      frames_(serializer_type, FramePool::DEFAULT_MAX_IDLE, RECV_BUFFER_RETAIN_SIZE) {}
 
 std::shared_ptr<SocketTransport> BaseSession::transport() const { return transport_; }
 
@@ -19,6 +25,11 @@ const char* BaseSession::authrole() const { return session_details_->auth_role;
 // Send raw bytes to transport
 void BaseSession::send(::Bytes& bytes) { transport_->write(bytes); }
 
+// Send an already encoded message
+void BaseSession::send(const uint8_t* data, size_t size, uint64_t* locked_at) {
+    transport_->write(data, size, locked_at);
+}
+
 // Receive raw bytes from transport
 ::Bytes BaseSession::receive() {
     std::vector<uint8_t> data = transport_->read();
@@ -41,12 +52,32 @@ void BaseSession::send_message(const Message* msg) {
 
 // Receive and deserialize a message
 Message* BaseSession::receive_message() {
-    ::Bytes bytes = receive();
+    if (!transport_->read_into(recv_buffer_)) return nullptr;
+
+    ::Bytes bytes;
+    bytes.data = recv_buffer_.data();
+    bytes.len = recv_buffer_.size();
     Message* msg = serializer->deserialize(serializer, bytes);
-    free(bytes.data);  // free receive buffer
+
+    if (recv_buffer_.capacity() > RECV_BUFFER_RETAIN_SIZE) std::vector<uint8_t>().swap(recv_buffer_);
     return msg;
 }
 
+std::shared_ptr<WireFrame> BaseSession::receive_frame() {
+    std::shared_ptr<WireFrame> frame = frames_.acquire();
+    if (!transport_->read_into(frame->buffer)) return nullptr;
+
+    return frame;
+}
+
+// Decode a frame with wampproto, for messages without a native path
+Message* BaseSession::deserialize(const WireFrame& frame) {
+    ::Bytes bytes;
+    bytes.data = const_cast<uint8_t*>(frame.begin());
+    bytes.len = frame.buffer.size();
+    return serializer->deserialize(serializer, bytes);
+}
+
 // Close the transport
 void BaseSession::close() { transport_->close(); }
 
@@ -1,21 +1,92 @@
 #include "xconn_cpp/client.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "xconn_cpp/internal/base_session.hpp"
 #include "xconn_cpp/session.hpp"
 #include "xconn_cpp/session_joiner.hpp"
+#include "xconn_cpp/transports/endpoint_cache.hpp"
+#include "xconn_cpp/url_parser.hpp"
 
 namespace xconn {
 
 Client::~Client() {}
 
 std::unique_ptr<Session> Client::connect(std::string uri, std::string realm) {
-    auto joiner = std::make_unique<SessionJoiner>(authenticator, serializer_type);
+    auto joiner = std::make_unique<SessionJoiner>(authenticator, serializer_type, max_msg_size);
     auto base_session = joiner->join(uri, realm);
-    auto session = std::make_unique<Session>(std::move(base_session));
+    auto session = std::make_unique<Session>(std::move(base_session), threading);
 
     return session;
 }
 
+std::vector<std::unique_ptr<Session>> Client::connect_many(std::string uri, std::string realm, std::size_t count,
+                                                           std::size_t concurrency, ConnectTimings* timings) {
+    using Clock = std::chrono::steady_clock;
+    auto started = Clock::now();
+
+    std::vector<std::unique_ptr<Session>> sessions(count);
+    if (count == 0) return sessions;
+
+    ConnectTimings total;
+
+    UrlParser parser = parse_url(uri);
+    if (parser.scheme == "tcp" || parser.scheme == "rs") {
+        EndpointCache::instance().resolve(parser.host, parser.port);
+        total.resolve = Clock::now() - started;
+    }
+
+    std::size_t num_workers = std::clamp<std::size_t>(concurrency, 1, count);
+    std::vector<ConnectTimings> worker_timings(num_workers);
+    std::atomic<std::size_t> next{0};
+
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers);
+    for (std::size_t w = 0; w < num_workers; ++w) {
+        workers.emplace_back([&, w] {
+            // One joiner per worker, so its serializer is shared by the sessions it opens.
+            SessionJoiner joiner(authenticator, serializer_type, max_msg_size);
+            ConnectTimings& local = worker_timings[w];
+
+            while (true) {
+                std::size_t index = next.fetch_add(1);
+                if (index >= count) return;
+
+                try {
+                    auto base_session = joiner.join(uri, realm, &local);
+
+                    auto session_started = Clock::now();
+                    sessions[index] = std::make_unique<Session>(std::move(base_session), threading);
+                    local.session += Clock::now() - session_started;
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                    next = count;
+                    return;
+                }
+            }
+        });
+    }
+
+    for (auto& worker : workers) worker.join();
+
+    for (const auto& local : worker_timings) total += local;
+    total.wall = Clock::now() - started;
+    if (timings) *timings = total;
+
+    if (error) std::rethrow_exception(error);
+
+    return sessions;
+}
+
 }  // namespace xconn
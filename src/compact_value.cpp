@@ -0,0 +1,199 @@
+#include "xconn_cpp/compact_value.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace xconn {
+
+void CompactValue::store_ref(const void* data, std::size_t size) {
+    if (size > UINT32_MAX) throw std::length_error("CompactValue payload exceeds 4 GiB");
+
+    auto length = static_cast<uint32_t>(size);
+    std::memcpy(storage_, &data, sizeof(data));
+    std::memcpy(storage_ + sizeof(data), &length, sizeof(length));
+    inline_size_ = OUT_OF_LINE;
+}
+
+void CompactValue::store_data(Arena& arena, std::string_view data) {
+    if (data.size() <= INLINE_CAPACITY) {
+        std::memcpy(storage_, data.data(), data.size());
+        inline_size_ = static_cast<uint8_t>(data.size());
+        return;
+    }
+
+    char* copy = arena.allocate_array<char>(data.size());
+    std::memcpy(copy, data.data(), data.size());
+    store_ref(copy, data.size());
+}
+
+CompactValue CompactValue::bytes(Arena& arena, std::span<const uint8_t> value) {
+    CompactValue result;
+    result.type_ = Type::Bytes;
+    result.store_data(arena, std::string_view(reinterpret_cast<const char*>(value.data()), value.size()));
+    return result;
+}
+
+CompactValue CompactValue::list(Arena& arena, std::size_t count) {
+    CompactValue result;
+    result.type_ = Type::List;
+
+    CompactValue* items = arena.allocate_array<CompactValue>(count);
+    std::uninitialized_default_construct_n(items, count);
+    result.store_ref(items, count);
+    return result;
+}
+
+CompactValue CompactValue::dict(Arena& arena, std::size_t count) {
+    CompactValue result;
+    result.type_ = Type::Dict;
+
+    CompactEntry* entries = arena.allocate_array<CompactEntry>(count);
+    std::uninitialized_default_construct_n(entries, count);
+    result.store_ref(entries, count);
+    return result;
+}
+
+CompactValue CompactValue::list(Arena& arena, std::span<const CompactValue> items) {
+    CompactValue result = list(arena, items.size());
+    std::copy(items.begin(), items.end(), result.items().begin());
+    return result;
+}
+
+CompactValue CompactValue::list(Arena& arena, std::initializer_list<CompactValue> items) {
+    return list(arena, std::span<const CompactValue>(items.begin(), items.size()));
+}
+
+CompactValue CompactValue::dict(Arena& arena, std::span<const CompactEntry> entries) {
+    CompactValue result = dict(arena, entries.size());
+    std::copy(entries.begin(), entries.end(), result.entries().begin());
+    result.sort_entries();
+    return result;
+}
+
+CompactValue CompactValue::dict(Arena& arena,
+                                std::initializer_list<std::pair<std::string_view, CompactValue>> entries) {
+    CompactValue result = dict(arena, entries.size());
+    auto target = result.entries().begin();
+    for (const auto& [key, value] : entries) *target++ = CompactEntry{CompactValue(arena, key), value};
+    result.sort_entries();
+    return result;
+}
+
+std::span<CompactValue> CompactValue::items() {
+    if (type_ != Type::List) return {};
+    return std::span<CompactValue>(static_cast<CompactValue*>(const_cast<void*>(ref_data())), ref_size());
+}
+
+std::span<CompactEntry> CompactValue::entries() {
+    if (type_ != Type::Dict) return {};
+    return std::span<CompactEntry>(static_cast<CompactEntry*>(const_cast<void*>(ref_data())), ref_size());
+}
+
+void CompactValue::sort_entries() {
+    auto all = entries();
+    // Entries without a string key cannot be looked up, drop them.
+    auto end = std::remove_if(all.begin(), all.end(),
+                              [](const CompactEntry& entry) { return entry.key.type() != Type::String; });
+
+    auto by_key = [](const CompactEntry& a, const CompactEntry& b) { return a.key.data() < b.key.data(); };
+    std::stable_sort(all.begin(), end, by_key);
+
+    // Keep the last of every run of equal keys.
+    auto out = all.begin();
+    for (auto it = all.begin(); it != end; ++it) {
+        auto next = it + 1;
+        if (next != end && next->key.data() == it->key.data()) continue;
+        *out++ = *it;
+    }
+
+    store_ref(all.data(), static_cast<std::size_t>(out - all.begin()));
+}
+
+CompactValue CompactValue::from(Arena& arena, const Value& value) {
+    return std::visit(
+        [&arena](auto&& item) -> CompactValue {
+            using T = std::decay_t<decltype(item)>;
+
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                return CompactValue();
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                return CompactValue(arena, item);
+            } else if constexpr (std::is_same_v<T, Bytes>) {
+                return bytes(arena, item);
+            } else if constexpr (std::is_same_v<T, std::shared_ptr<List>>) {
+                if (!item) return CompactValue();
+
+                CompactValue result = list(arena, item->size());
+                auto target = result.items().begin();
+                for (const auto& element : *item) *target++ = from(arena, element);
+                return result;
+            } else if constexpr (std::is_same_v<T, std::shared_ptr<Dict>>) {
+                if (!item) return CompactValue();
+
+                CompactValue result = dict(arena, item->size());
+                auto target = result.entries().begin();
+                for (const auto& [key, element] : *item) *target++ = {CompactValue(arena, key), from(arena, element)};
+                result.sort_entries();
+                return result;
+            } else {
+                return CompactValue(item);
+            }
+        },
+        value.data);
+}
+
+const CompactValue* CompactValue::at(std::size_t index) const {
+    auto list = getList();
+    if (!list || index >= list->size()) return nullptr;
+    return &(*list)[index];
+}
+
+const CompactValue* CompactValue::get(std::string_view key) const {
+    auto dict = getDict();
+    if (!dict) return nullptr;
+
+    auto it = std::lower_bound(dict->begin(), dict->end(), key,
+                               [](const CompactEntry& entry, std::string_view k) { return entry.key.data() < k; });
+    if (it == dict->end() || it->key.data() != key) return nullptr;
+    return &it->value;
+}
+
+Value CompactValue::toValue() const {
+    switch (type_) {
+        case Type::Null:
+            return Value();
+        case Type::Int:
+            return load<int64_t>();
+        case Type::UInt:
+            return load<uint64_t>();
+        case Type::Double:
+            return load<double>();
+        case Type::Bool:
+            return load<bool>();
+        case Type::String:
+            return std::string(data());
+        case Type::Bytes: {
+            auto bytes = *getBytes();
+            return Bytes(bytes.begin(), bytes.end());
+        }
+        case Type::List: {
+            auto list = std::make_shared<List>();
+            list->reserve(size());
+            auto items = *getList();
+            for (const auto& item : items) list->push_back(item.toValue());
+            return list;
+        }
+        case Type::Dict: {
+            auto dict = std::make_shared<Dict>();
+            dict->reserve(size());
+            auto entries = *getDict();
+            for (const auto& entry : entries) dict->emplace(std::string(entry.key.data()), entry.value.toValue());
+            return dict;
+        }
+    }
+    return Value();
+}
+
+}  // namespace xconn
@@ -0,0 +1,77 @@
+#include "xconn_cpp/internal/frame_pool.hpp"
+
+#include <new>
+
+namespace xconn {
+
+FramePool::FramePool(SerializerType format, size_t max_idle, size_t retain_size)
+    : state_(std::make_shared<State>()) {
+    state_->format = format;
+    state_->max_idle = max_idle;
+    state_->retain_size = retain_size;
+    state_->idle.reserve(max_idle);
+    state_->blocks = std::make_shared<BlockCache>(max_idle);
+}
+
+std::shared_ptr<WireFrame> FramePool::acquire() {
+    std::unique_ptr<WireFrame> frame;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (!state_->idle.empty()) {
+            frame = std::move(state_->idle.back());
+            state_->idle.pop_back();
+        }
+    }
+    if (!frame) frame = std::make_unique<WireFrame>(state_->format);
+
+    std::weak_ptr<State> state = state_;
+    return std::shared_ptr<WireFrame>(frame.release(), [state](WireFrame* released) { release(state, released); },
+                                      BlockAllocator<WireFrame>(state_->blocks));
+}
+
+size_t FramePool::idle() const {
+    std::lock_guard<std::mutex> lock(state_->mutex);
+    return state_->idle.size();
+}
+
+void FramePool::release(const std::weak_ptr<State>& state, WireFrame* frame) {
+    std::unique_ptr<WireFrame> owned(frame);
+
+    auto pool = state.lock();
+    if (!pool) return;
+
+    owned->recycle(pool->retain_size);
+
+    std::lock_guard<std::mutex> lock(pool->mutex);
+    if (pool->idle.size() < pool->max_idle) pool->idle.push_back(std::move(owned));
+}
+
+FramePool::BlockCache::~BlockCache() {
+    for (void* block : blocks) ::operator delete(block);
+}
+
+void* FramePool::BlockCache::take(size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (size == block_size && !blocks.empty()) {
+            void* block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+    }
+    return ::operator new(size);
+}
+
+void FramePool::BlockCache::give(void* block, size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (block_size == 0) block_size = size;
+        if (size == block_size && blocks.size() < max_idle) {
+            blocks.push_back(block);
+            return;
+        }
+    }
+    ::operator delete(block);
+}
+
+}  // namespace xconn
@@ -0,0 +1,207 @@
+#include "xconn_cpp/internal/json_scan.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define XCONN_JSON_X86 1
+#include <immintrin.h>
+#endif
+
+namespace xconn {
+
+namespace {
+
+bool is_quote_or_backslash(uint8_t c) { return c == '"' || c == '\\'; }
+bool is_unsafe(uint8_t c) { return c < 0x20 || c == '"' || c == '\\'; }
+bool is_structural(uint8_t c) { return c == '"' || c == '[' || c == ']' || c == '{' || c == '}'; }
+
+template <bool (*Match)(uint8_t)>
+const uint8_t* scan_scalar(const uint8_t* p, const uint8_t* end) {
+    while (p < end && !Match(*p)) ++p;
+    return p;
+}
+
+#ifdef XCONN_JSON_X86
+
+// 16 bytes at a time. Everything used here is SSE2; the level is named after SSE4.2 as the
+// baseline of the CPUs it is selected on.
+
+__attribute__((target("sse4.2"))) const uint8_t* quote_or_backslash_sse42(const uint8_t* p, const uint8_t* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+        int mask = _mm_movemask_epi8(hits);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return scan_scalar<is_quote_or_backslash>(p, end);
+}
+
+__attribute__((target("sse4.2"))) const uint8_t* unsafe_sse42(const uint8_t* p, const uint8_t* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1f);
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        // Unsigned chunk <= 0x1f, as min(chunk, 0x1f) == chunk.
+        __m128i control = _mm_cmpeq_epi8(_mm_min_epu8(chunk, control_max), chunk);
+        __m128i hits = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                    control);
+        int mask = _mm_movemask_epi8(hits);
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return scan_scalar<is_unsafe>(p, end);
+}
+
+__attribute__((target("sse4.2"))) const uint8_t* structural_sse42(const uint8_t* p, const uint8_t* end) {
+    const __m128i quote = _mm_set1_epi8('"');
+    // '[' and ']' differ from '{' and '}' only in bit 0x20, and the open and close bracket
+    // only in bit 0x06 ('[' 0x5b, ']' 0x5d), so one mask and two compares cover all four.
+    const __m128i fold = _mm_set1_epi8(0x20 | 0x06);
+    const __m128i bracket = _mm_set1_epi8('[' | 0x20 | 0x06);
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i hits =
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(_mm_or_si128(chunk, fold), bracket));
+        int mask = _mm_movemask_epi8(hits);
+        while (mask) {
+            // The fold also admits a few non-bracket bytes; confirm each candidate.
+            int index = __builtin_ctz(mask);
+            if (is_structural(p[index])) return p + index;
+            mask &= mask - 1;
+        }
+    }
+    return scan_scalar<is_structural>(p, end);
+}
+
+// 32 bytes at a time.
+
+__attribute__((target("avx2"))) const uint8_t* quote_or_backslash_avx2(const uint8_t* p, const uint8_t* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return quote_or_backslash_sse42(p, end);
+}
+
+__attribute__((target("avx2"))) const uint8_t* unsafe_avx2(const uint8_t* p, const uint8_t* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i control_max = _mm256_set1_epi8(0x1f);
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i control = _mm256_cmpeq_epi8(_mm256_min_epu8(chunk, control_max), chunk);
+        __m256i hits = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote), _mm256_cmpeq_epi8(chunk, backslash)), control);
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return unsafe_sse42(p, end);
+}
+
+__attribute__((target("avx2"))) const uint8_t* structural_avx2(const uint8_t* p, const uint8_t* end) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i fold = _mm256_set1_epi8(0x20 | 0x06);
+    const __m256i bracket = _mm256_set1_epi8('[' | 0x20 | 0x06);
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i hits = _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+                                       _mm256_cmpeq_epi8(_mm256_or_si256(chunk, fold), bracket));
+        auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(hits));
+        while (mask) {
+            int index = __builtin_ctz(mask);
+            if (is_structural(p[index])) return p + index;
+            mask &= mask - 1;
+        }
+    }
+    return structural_sse42(p, end);
+}
+
+#endif  // XCONN_JSON_X86
+
+using ScanFn = const uint8_t* (*)(const uint8_t*, const uint8_t*);
+
+struct Scanners {
+    SimdLevel level;
+    ScanFn quote_or_backslash;
+    ScanFn unsafe;
+    ScanFn structural;
+};
+
+const Scanners SCALAR{SimdLevel::Scalar, scan_scalar<is_quote_or_backslash>, scan_scalar<is_unsafe>,
+                      scan_scalar<is_structural>};
+#ifdef XCONN_JSON_X86
+const Scanners SSE42{SimdLevel::SSE42, quote_or_backslash_sse42, unsafe_sse42, structural_sse42};
+const Scanners AVX2{SimdLevel::AVX2, quote_or_backslash_avx2, unsafe_avx2, structural_avx2};
+#endif
+
+SimdLevel detect() {
+#ifdef XCONN_JSON_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return SimdLevel::SSE42;
+#endif
+    return SimdLevel::Scalar;
+}
+
+const Scanners* scanners_for(SimdLevel level) {
+    switch (level) {
+#ifdef XCONN_JSON_X86
+        case SimdLevel::AVX2:
+            return &AVX2;
+        case SimdLevel::SSE42:
+            return &SSE42;
+#endif
+        default:
+            return &SCALAR;
+    }
+}
+
+std::atomic<const Scanners*>& active() {
+    static std::atomic<const Scanners*> scanners{scanners_for(json_simd_supported())};
+    return scanners;
+}
+
+}  // namespace
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2:
+            return "avx2";
+        case SimdLevel::SSE42:
+            return "sse4.2";
+        default:
+            return "scalar";
+    }
+}
+
+SimdLevel json_simd_supported() {
+    static const SimdLevel supported = detect();
+    return supported;
+}
+
+SimdLevel json_simd_level() { return active().load(std::memory_order_relaxed)->level; }
+
+void set_json_simd_level(SimdLevel level) {
+    if (level > json_simd_supported()) level = json_simd_supported();
+    active().store(scanners_for(level), std::memory_order_relaxed);
+}
+
+const uint8_t* json_find_quote_or_backslash(const uint8_t* p, const uint8_t* end) {
+    return active().load(std::memory_order_relaxed)->quote_or_backslash(p, end);
+}
+
+const uint8_t* json_find_unsafe(const uint8_t* p, const uint8_t* end) {
+    return active().load(std::memory_order_relaxed)->unsafe(p, end);
+}
+
+const uint8_t* json_find_structural(const uint8_t* p, const uint8_t* end) {
+    return active().load(std::memory_order_relaxed)->structural(p, end);
+}
+
+}  // namespace xconn
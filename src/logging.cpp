@@ -0,0 +1,201 @@
+#include "xconn_cpp/logging.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+
+namespace xconn {
+
+namespace {
+
+uint64_t wall_clock_ns() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count());
+}
+
+// Bounded multi-producer queue in front of a single background flusher. Producers claim a
+// slot with one CAS and never wait; the flusher, or flush_logs(), drains it under a mutex.
+class Logger {
+   public:
+    // Never destroyed, so sessions torn down during static destruction can still log.
+    static Logger& instance() {
+        static Logger* logger = new Logger();
+        return *logger;
+    }
+
+    std::atomic<uint8_t> level{static_cast<uint8_t>(LogLevel::Info)};
+
+    void push(LogRecord&& record) {
+        uint64_t position = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots_[position & MASK];
+            uint64_t sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(sequence - position);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.record = std::move(record);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    break;
+                }
+            } else if (diff < 0) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return;
+            } else {
+                position = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        if (stopped_.load(std::memory_order_acquire)) {
+            flush();
+        } else if (sleeping_.exchange(false, std::memory_order_acq_rel)) {
+            wake_.notify_one();
+        }
+    }
+
+    void set_sink(std::shared_ptr<LogSink> sink) {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        sink_ = std::move(sink);
+    }
+
+    void flush() {
+        std::lock_guard<std::mutex> lock(drain_mutex_);
+        drain();
+    }
+
+   private:
+    static constexpr size_t CAPACITY = 4096;
+    static constexpr size_t MASK = CAPACITY - 1;
+
+    // `sequence` equals the position a producer may claim next, and position + 1 once the
+    // record at `position` is ready for the flusher.
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        LogRecord record;
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<uint64_t> enqueue_pos_{0};
+    alignas(64) std::atomic<uint64_t> dropped_{0};
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> stopped_{false};
+
+    std::mutex drain_mutex_;
+    std::condition_variable wake_;
+    uint64_t dequeue_pos_ = 0;
+    bool stopping_ = false;
+    std::shared_ptr<LogSink> sink_ = std::make_shared<StderrLogSink>();
+    std::thread flusher_;
+
+    Logger() : slots_(std::make_unique<Slot[]>(CAPACITY)) {
+        for (size_t i = 0; i < CAPACITY; ++i) slots_[i].sequence.store(i, std::memory_order_relaxed);
+        flusher_ = std::thread([this] { run(); });
+        std::atexit([] { instance().stop(); });
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(drain_mutex_);
+        while (!stopping_) {
+            drain();
+            // A producer that finds the flag set wakes us; the timeout covers a record pushed
+            // between the last drain and setting it.
+            sleeping_.store(true, std::memory_order_release);
+            wake_.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        drain();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        if (flusher_.joinable()) flusher_.join();
+        // From here on producers flush their own records.
+        stopped_.store(true, std::memory_order_release);
+        flush();
+    }
+
+    // Called with drain_mutex_ held, which makes the caller the only consumer.
+    void drain() {
+        for (;;) {
+            Slot& slot = slots_[dequeue_pos_ & MASK];
+            if (slot.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1) break;
+
+            LogRecord record = std::move(slot.record);
+            slot.sequence.store(dequeue_pos_ + CAPACITY, std::memory_order_release);
+            ++dequeue_pos_;
+            if (sink_) sink_->write(record);
+        }
+
+        uint64_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+        if (dropped != 0 && sink_) {
+            sink_->write({LogLevel::Warning, wall_clock_ns(),
+                          std::to_string(dropped) + " log messages dropped, the log queue was full", 0});
+        }
+    }
+};
+
+}  // namespace
+
+const char* log_level_name(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug:
+            return "debug";
+        case LogLevel::Info:
+            return "info";
+        case LogLevel::Warning:
+            return "warning";
+        case LogLevel::Error:
+            return "error";
+        case LogLevel::Off:
+            return "off";
+    }
+    return "unknown";
+}
+
+void StderrLogSink::write(const LogRecord& record) {
+    if (record.suppressed != 0) {
+        std::fprintf(stderr, "xconn %s: %s (%llu similar messages suppressed)\n", log_level_name(record.level),
+                     record.message.c_str(), static_cast<unsigned long long>(record.suppressed));
+    } else {
+        std::fprintf(stderr, "xconn %s: %s\n", log_level_name(record.level), record.message.c_str());
+    }
+}
+
+void set_log_sink(std::shared_ptr<LogSink> sink) { Logger::instance().set_sink(std::move(sink)); }
+
+void set_log_level(LogLevel level) {
+    Logger::instance().level.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+LogLevel log_level() { return static_cast<LogLevel>(Logger::instance().level.load(std::memory_order_relaxed)); }
+
+bool log_enabled(LogLevel level) { return level != LogLevel::Off && level >= log_level(); }
+
+void log(LogLevel level, std::string message, uint64_t suppressed) {
+    if (!log_enabled(level)) return;
+    Logger::instance().push({level, wall_clock_ns(), std::move(message), suppressed});
+}
+
+void flush_logs() { Logger::instance().flush(); }
+
+bool LogRateLimit::allow(uint64_t now_ns, uint64_t& suppressed) {
+    uint64_t window = now_ns / 1'000'000'000;
+    uint64_t current = window_.load(std::memory_order_relaxed);
+    if (current != window && window_.compare_exchange_strong(current, window, std::memory_order_relaxed)) {
+        count_.store(0, std::memory_order_relaxed);
+    }
+
+    if (count_.fetch_add(1, std::memory_order_relaxed) < per_second_) {
+        suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+    suppressed_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+}  // namespace xconn
@@ -4,7 +4,6 @@
 #include <exception>
 #include <format>
 #include <future>
-#include <iostream>
 #include <memory>
 #include <mutex>
 #include <stdexcept>
@@ -12,13 +11,21 @@
 
 #include <sys/stat.h>
 
+#include "xconn_cpp/alloc_accounting.hpp"
 #include "xconn_cpp/internal/base_session.hpp"
+#include "xconn_cpp/internal/concurrency_limiter.hpp"
+#include "xconn_cpp/internal/encode_buffer.hpp"
+#include "xconn_cpp/internal/event_batcher.hpp"
+#include "xconn_cpp/internal/log.hpp"
+#include "xconn_cpp/internal/thread_placement.hpp"
 #include "xconn_cpp/internal/types.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
 #include "xconn_cpp/types.hpp"
 
 namespace xconn {
 
-Session::Session(std::unique_ptr<BaseSession> base_session)
+Session::Session(std::unique_ptr<BaseSession> base_session, const ThreadingOptions& threading)
     : base_session_(std::move(base_session)),
       session_id(base_session->id()),
       auth_id(base_session->authid()),
@@ -27,12 +34,34 @@ Session::Session(std::unique_ptr<BaseSession> base_session)
     wamp_session = session_new(base_session_->serializer);
     id_generator = id_generator_new();
 
-    pool_ = std::make_unique<ThreadPool>();
+    int node = threading.numa_node;
+    if (node == ThreadingOptions::NUMA_NODE_NIC) node = socket_numa_node(base_session_->transport()->native_handle());
 
-    recv_thread_ = std::thread(&Session::wait, this);
+    std::vector<int> receive_cpus = threading.receive_cpus;
+    std::vector<int> worker_cpus = threading.worker_cpus;
+    if (node >= 0) {
+        std::vector<int> local = numa_node_cpus(node);
+        if (receive_cpus.empty()) receive_cpus = local;
+        if (worker_cpus.empty()) worker_cpus = local;
+    }
+
+    size_t workers = threading.worker_threads ? threading.worker_threads : std::thread::hardware_concurrency();
+    PoolLanes lanes{threading.lane_scheduling, threading.lane_weights, threading.high_priority_workers};
+    auto place_worker = [threading, worker_cpus, node](size_t index) {
+        std::vector<int> cpus = worker_cpus;
+        if (threading.pin_workers_individually && !cpus.empty()) cpus = {worker_cpus[index % worker_cpus.size()]};
+        place_current_thread(threading.name_prefix + "-w" + std::to_string(index), cpus, node);
+    };
+    pool_ = std::make_unique<ThreadPool>(workers, place_worker, lanes);
+
+    recv_thread_ = std::thread([this, name = threading.name_prefix + "-recv", receive_cpus, node] {
+        place_current_thread(name, receive_cpus, node);
+        wait();
+    });
 }
 
 Session::~Session() {
+    base_session_->transport()->stop_keepalive();
     if (is_connected()) base_session_->close();
     running_ = false;
     if (recv_thread_.joinable()) recv_thread_.join();
@@ -52,9 +81,114 @@ int Session::leave() {
 
 bool Session::is_connected() { return running_; }
 
+void Session::start_keepalive(KeepaliveOptions options) { base_session_->transport()->start_keepalive(options); }
+
+HistogramSnapshot Session::rtt() const { return base_session_->transport()->rtt(); }
+
+template <typename Map>
+static size_t locked_size(std::mutex& mutex, const Map& map) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return map.size();
+}
+
+SessionMetricsSnapshot Session::metrics() {
+    SessionMetricsSnapshot snap = metrics_.snapshot();
+    snap.pending_calls = locked_size(call_requests_mutex_, call_requests_);
+    snap.pending_publishes = locked_size(publish_requests_mutex_, publish_requests_);
+    snap.pending_registers = locked_size(register_requests_mutex_, register_requests_);
+    snap.pending_unregisters = locked_size(unregister_requests_mutex_, unregister_requests_);
+    snap.pending_subscribes = locked_size(subscribe_requests_mutex_, subscribe_requests_);
+    snap.pending_unsubscribes = locked_size(unsubscribe_requests_mutex_, unsubscribe_requests_);
+    snap.registrations = locked_size(registrations_mutex_, registrations_);
+    snap.subscriptions = locked_size(subscriptions_mutex_, subscriptions_);
+    snap.pool_queue_depth = pool_->pending();
+    snap.rtt = rtt();
+    return snap;
+}
+
+void Session::set_trace_sink(std::shared_ptr<TraceSink> sink) {
+    std::lock_guard<std::mutex> lock(trace_sinks_mutex_);
+    trace_sink_.store(sink.get(), std::memory_order_release);
+    if (sink) trace_sinks_.push_back(std::move(sink));
+}
+
+std::string Session::prometheus_metrics() {
+    return to_prometheus(metrics(), {{"session_id", std::to_string(session_id)}, {"realm", realm}});
+}
+
+void Session::send_reply(uint64_t request_id, std::vector<uint8_t>& message, uint64_t* locked_at) {
+    try {
+        send_bytes(message, locked_at);
+    } catch (const std::length_error& e) {
+        metrics_.handler_errors.add();
+        XCONN_LOG(LogLevel::Warning, "Reply to invocation {} not sent: {}", request_id, e.what());
+        message.clear();
+        WireWriter writer(base_session_->serializer_type, message);
+        encode_error(writer, WAMP_MESSAGE_INVOCATION, request_id, Dict(), ERROR_PAYLOAD_SIZE_EXCEEDED,
+                     List{std::string(e.what())}, Dict());
+        send_bytes(message, locked_at);
+    }
+}
+
+void Session::post_batch(const SubscribedTopic& topic) {
+    pool_->post(topic.priority, [this, topic] {
+        std::vector<EventView> batch;
+        uint64_t queued_at = topic.batcher->take(batch);
+        uint64_t started_at = trace_now_ns();
+        metrics_.queue_latency.record(started_at - queued_at);
+        metrics_.event_batches.add();
+
+        try {
+            topic.batch_handler(std::span<const EventView>(batch));
+        } catch (const std::exception& e) {
+            metrics_.handler_errors.add();
+            XCONN_LOG(LogLevel::Error, "Subscription handler execution failed: {}", e.what());
+        } catch (...) {
+            metrics_.handler_errors.add();
+            XCONN_LOG(LogLevel::Error, "Subscription handler threw an unknown exception");
+        }
+        metrics_.handler_latency.record(trace_now_ns() - started_at);
+
+        if (topic.batcher->finish()) post_batch(topic);
+    });
+}
+
+// The invocation the calling pool worker is running.
+struct RunningInvocation {
+    // The registration's lane, so a coroutine handler that resumes after a DoAsync() stays in it.
+    HandlerPriority lane = HandlerPriority::Normal;
+    // Set by an async handler, which sends its own reply once its task finishes.
+    bool reply_deferred = false;
+    // The concurrency slot the invocation holds, if its registration has a limit. An async
+    // handler takes it along and gives it back once its reply is sent.
+    std::shared_ptr<ConcurrencyLimiter> limiter;
+};
+static thread_local RunningInvocation running_invocation;
+
+void Session::post_limited(std::shared_ptr<ConcurrencyLimiter> limiter, HandlerPriority priority,
+                           std::function<void()> task) {
+    pool_->post(priority, [this, limiter = std::move(limiter), priority, task = std::move(task)]() mutable {
+        // The slot is handed on even if the task throws, so a failed send cannot stall the queue.
+        struct Release {
+            Session* session;
+            HandlerPriority priority;
+            ~Release() {
+                if (auto held = std::move(running_invocation.limiter)) session->release_slot(held, priority);
+            }
+        } release{this, priority};
+        running_invocation.limiter = std::move(limiter);
+        task();
+    });
+}
+
+void Session::release_slot(std::shared_ptr<ConcurrencyLimiter>& limiter, HandlerPriority priority) {
+    if (auto next = limiter->release()) post_limited(limiter, priority, std::move(*next));
+}
+
 void Session::send_message(Message* msg) {
     ::Bytes bytes = wamp_session->send_message(wamp_session, msg);
     if (is_connected()) {
+        metrics_.record_sent(bytes.len);
         base_session_->send(bytes);
         return;
     }
@@ -62,6 +196,67 @@ void Session::send_message(Message* msg) {
     throw std::runtime_error("Connection closed");
 }
 
+static bool wants_acknowledge(const Dict& options) {
+    auto it = options.find("acknowledge");
+    return it != options.end() && it->second.getBool().value_or(false);
+}
+
+static void set_passthru(Dict& options, List& args, Dict& kwargs, TypedPayload& typed, std::string scheme,
+                         std::span<const uint8_t> payload, std::string serializer) {
+    options["ppt_scheme"] = std::move(scheme);
+    options["ppt_serializer"] = std::move(serializer);
+
+    args.clear();
+    kwargs.clear();
+    typed = TypedPayload();
+    typed.args.emplace_back(0, [payload](WireWriter& writer) { writer.write_bytes(payload.data(), payload.size()); });
+}
+
+// Records a stage of `request_id`; a no-op, not even reading the clock, when tracing is off.
+static void trace(TraceSink* sink, TraceStage stage, uint64_t request_id, uint64_t timestamp_ns = 0) {
+    if (!sink) return;
+    sink->record(TraceEvent{request_id, timestamp_ns ? timestamp_ns : trace_now_ns(), stage});
+}
+
+#ifdef XCONN_ALLOC_ACCOUNTING
+// Charges what the current thread allocates during its lifetime to one kind of operation.
+class ChargeAllocs {
+   public:
+    explicit ChargeAllocs(AllocCounters& counters) : counters_(counters) {}
+    ~ChargeAllocs() { counters_.add(scope_.elapsed()); }
+
+   private:
+    AllocCounters& counters_;
+    AllocScope scope_;
+};
+#else
+class ChargeAllocs {
+   public:
+    explicit ChargeAllocs(AllocCounters&) {}
+};
+#endif
+
+// Do() and DoView() keep reporting an ERROR reply as std::runtime_error, as they always have.
+static ResultView value_or_throw(Expected<ResultView, ApplicationError> outcome) {
+    if (!outcome) throw std::runtime_error(outcome.error().what());
+    return std::move(*outcome);
+}
+
+static Expected<Result, ApplicationError> to_result(Expected<ResultView, ApplicationError> outcome) {
+    if (!outcome) return Unexpected(std::move(outcome).error());
+    return outcome->toResult();
+}
+
+void Session::send_bytes(const std::vector<uint8_t>& bytes, uint64_t* locked_at) {
+    if (is_connected()) {
+        base_session_->send(bytes.data(), bytes.size(), locked_at);
+        metrics_.record_sent(bytes.size());
+        return;
+    }
+
+    throw std::runtime_error("Connection closed");
+}
+
 void Session::process_incoming_message(Message* msg) {
     switch (msg->message_type) {
         case MESSAGE_TYPE_GOODBYE: {
@@ -76,14 +271,6 @@ void Session::process_incoming_message(Message* msg) {
             base_session_->close();
             break;
         }
-        case MESSAGE_TYPE_RESULT: {
-            ::Result* result = (::Result*)msg;
-            uint64_t request_id = result->request_id;
-
-            auto maybe_promise = find_from_map(request_id, call_requests_, call_requests_mutex_);
-            if (maybe_promise.has_value()) maybe_promise->set_value(Result(result));
-            break;
-        }
         case MESSAGE_TYPE_REGISTERED: {
             ::Registered* registered = (::Registered*)msg;
             uint64_t request_id = registered->request_id;
@@ -93,7 +280,9 @@ void Session::process_incoming_message(Message* msg) {
             if (request.has_value()) {
                 {
                     std::lock_guard<std::mutex> lock(registrations_mutex_);
-                    registrations_.emplace(registered->registration_id, std::move(request->handler));
+                    RegisteredProcedure entry{std::move(request->handler), request->priority,
+                                              std::move(request->limiter)};
+                    registrations_.emplace(registered->registration_id, std::move(entry));
                 }
 
                 Registration registeration(*this, registered->registration_id);
@@ -112,41 +301,6 @@ void Session::process_incoming_message(Message* msg) {
             }
             break;
         }
-        case MESSAGE_TYPE_INVOCATION: {
-            ::Invocation* invok = (::Invocation*)msg;
-            auto handler = find_from_map(invok->registration_id, registrations_, registrations_mutex_, false);
-            if (handler.has_value()) {
-                Invocation invocation = Invocation(invok);
-                pool_->enqueue([this, handler, invocation = std::move(invocation), invok]() mutable {
-                    try {
-                        Result result = (*handler)(invocation);
-
-                        ::List* yield_args = vector_to_list(result.args);
-                        ::Dict* yield_kwargs = unordered_map_to_dict(result.kwargs);
-                        ::Dict* yield_options = unordered_map_to_dict(result.details);
-
-                        Yield* yield = yield_new(invok->request_id, yield_options, yield_args, yield_kwargs);
-
-                        base_session_->send_message((::Message*)yield);
-                    } catch (const ApplicationError& e) {
-                        ::List* args = vector_to_list(e.list());
-                        ::Dict* kwargs = unordered_map_to_dict(e.dict());
-
-                        ::Error* error = error_new(invok->base.message_type, invok->request_id, create_dict(),
-                                                   ERROR_RUNTIME_ERROR, args, kwargs);
-
-                        base_session_->send_message((::Message*)error);
-                    } catch (const std::exception& e) {
-                        ::Error* error = error_new(invok->base.message_type, invok->request_id, NULL,
-                                                   ERROR_RUNTIME_ERROR, NULL, NULL);
-
-                        base_session_->send_message((::Message*)error);
-                    }
-                });
-            }
-
-            break;
-        }
         case MESSAGE_TYPE_PUBLISHED: {
             ::Published* published = (::Published*)msg;
             uint64_t request_id = published->request_id;
@@ -162,7 +316,10 @@ void Session::process_incoming_message(Message* msg) {
             auto request = find_from_map(request_id, subscribe_requests_, subscribe_requests_mutex_, true);
             if (request.has_value()) {
                 std::lock_guard<std::mutex> lock(subscriptions_mutex_);
-                subscriptions_.emplace(subscribed->subscription_id, std::move(request->handler));
+                SubscribedTopic entry{std::move(request->handler), request->priority,
+                                      std::move(request->batch_handler), std::move(request->batcher),
+                                      std::move(request->conflation_key)};
+                subscriptions_.emplace(subscribed->subscription_id, std::move(entry));
             }
 
             auto subscription = Subscription(*this, subscribed->subscription_id);
@@ -170,26 +327,6 @@ void Session::process_incoming_message(Message* msg) {
             request->promise.set_value(subscription);
             break;
         }
-        case MESSAGE_TYPE_EVENT: {
-            ::Event* c_event = (::Event*)msg;
-            uint64_t subscription_id = c_event->subscription_id;
-
-            auto handler = find_from_map(subscription_id, subscriptions_, subscriptions_mutex_, false);
-            if (handler) {
-                Event event = Event(c_event);
-
-                pool_->enqueue([this, handler, event]() mutable {
-                    try {
-                        handler->operator()(event);
-                    } catch (const std::exception& e) {
-                        std::cerr << "Subscription Handler execution failed: " << e.what() << std::endl;
-                    }
-                });
-            }
-
-            msg->free(msg);
-            break;
-        }
         case MESSAGE_TYPE_UNSUBSCRIBED: {
             ::Unsubscribed* unsubscribed = (::Unsubscribed*)msg;
             uint64_t request_id = unsubscribed->request_id;
@@ -206,88 +343,281 @@ void Session::process_incoming_message(Message* msg) {
         case MESSAGE_TYPE_ERROR: {
             ::Error* error = (::Error*)msg;
 
-            std::string invalid_error_message =
-                std::format("Received {} message for invalid request ID", error->message_type);
-
-            std::exception_ptr invalid_error = std::make_exception_ptr(std::runtime_error(invalid_error_message));
-
             auto app_error = ApplicationError(error->uri, from_c_list(error->args), from_c_dict(error->kwargs));
 
             std::exception_ptr application_error = std::make_exception_ptr(std::runtime_error(app_error.what()));
 
             uint64_t request_id = error->request_id;
+            bool found = false;
 
             switch (error->message_type) {
                 case MESSAGE_TYPE_CALL: {
                     auto promise = find_from_map(request_id, call_requests_, call_requests_mutex_);
-
-                    std::exception_ptr exception = promise.has_value() ? application_error : invalid_error;
-                    promise->set_exception(exception);
-
+                    if (promise.has_value()) {
+                        promise->complete(Unexpected(std::move(app_error)));
+                        found = true;
+                    }
                     break;
                 }
                 case MESSAGE_TYPE_REGISTER: {
                     auto request = find_from_map(request_id, register_requests_, register_requests_mutex_);
-                    std::exception_ptr exception = request.has_value() ? application_error : invalid_error;
-                    request->promise.set_exception(exception);
+                    if (request.has_value()) {
+                        request->promise.set_exception(application_error);
+                        found = true;
+                    }
                     break;
                 }
                 case MESSAGE_TYPE_UNREGISTER: {
                     auto request = find_from_map(request_id, unregister_requests_, unregister_requests_mutex_);
-
-                    std::exception_ptr exception = request.has_value() ? application_error : invalid_error;
-                    request->promise.set_exception(exception);
+                    if (request.has_value()) {
+                        request->promise.set_exception(application_error);
+                        found = true;
+                    }
                     break;
                 }
                 case MESSAGE_TYPE_PUBLISH: {
                     auto promise = find_from_map(request_id, publish_requests_, publish_requests_mutex_);
-
-                    std::exception_ptr exception = promise.has_value() ? application_error : invalid_error;
-                    promise->set_exception(exception);
+                    if (promise.has_value()) {
+                        promise->set_exception(application_error);
+                        found = true;
+                    }
                     break;
                 }
                 case MESSAGE_TYPE_SUBSCRIBE: {
                     auto request = find_from_map(request_id, subscribe_requests_, subscribe_requests_mutex_);
-
-                    std::exception_ptr exception = request.has_value() ? application_error : invalid_error;
-                    request->promise.set_exception(exception);
+                    if (request.has_value()) {
+                        request->promise.set_exception(application_error);
+                        found = true;
+                    }
                     break;
                 }
                 case MESSAGE_TYPE_UNSUBSCRIBE: {
                     auto request = find_from_map(request_id, unsubscribe_requests_, unsubscribe_requests_mutex_);
-
-                    std::exception_ptr exception = request.has_value() ? application_error : invalid_error;
-                    request->promise.set_exception(exception);
+                    if (request.has_value()) {
+                        request->promise.set_exception(application_error);
+                        found = true;
+                    }
                     break;
                 }
                 default:
-                    std::cout << "Result CODE: " << error->message_type << std::endl;
+                    XCONN_LOG(LogLevel::Warning, "Received ERROR for unsupported request type {}", error->message_type);
+            }
+
+            if (!found) {
+                XCONN_LOG(LogLevel::Warning, "Received {} message for invalid request ID", error->message_type);
             }
 
-            throw std::runtime_error(error->uri);
+            msg->free(msg);
+            break;
         }
 
         default: {
-            std::cout << "Message ID: " << msg->message_type << std::endl;
+            XCONN_LOG(LogLevel::Warning, "Received unexpected message type {}", msg->message_type);
         }
     }
 }
 
+bool Session::process_incoming_frame(const std::shared_ptr<const WireFrame>& frame, uint64_t received_at) {
+    TraceSink* sink = tracer();
+
+    switch (wire_message_type(*frame)) {
+        case WAMP_MESSAGE_RESULT: {
+            ChargeAllocs charge(metrics_.call_allocs);
+            ResultView result(frame);
+            trace(sink, TraceStage::ResultReceived, result.request_id, received_at);
+
+            auto maybe_promise = find_from_map(result.request_id, call_requests_, call_requests_mutex_);
+            if (maybe_promise.has_value()) {
+                trace(sink, TraceStage::ResultDecoded, result.request_id);
+                maybe_promise->complete(std::move(result));
+            }
+            return true;
+        }
+        case WAMP_MESSAGE_INVOCATION: {
+            ChargeAllocs charge(metrics_.invocation_allocs);
+            InvocationView invocation(frame);
+            trace(sink, TraceStage::InvocationReceived, invocation.request_id, received_at);
+
+            metrics_.invocations.add();
+
+            auto handler = find_from_map(invocation.registration_id, registrations_, registrations_mutex_, false);
+            if (handler.has_value()) {
+                uint64_t request_id = invocation.request_id;
+                uint64_t queued_at = trace_now_ns();
+                trace(sink, TraceStage::InvocationQueued, invocation.request_id, queued_at);
+                auto task = [this, handler, queued_at, invocation = std::move(invocation)]() mutable {
+                    ChargeAllocs charge(metrics_.invocation_allocs);
+                    running_invocation.lane = handler->priority;
+                    running_invocation.reply_deferred = false;
+                    TraceSink* sink = tracer();
+                    uint64_t started_at = trace_now_ns();
+                    metrics_.queue_latency.record(started_at - queued_at);
+                    trace(sink, TraceStage::HandlerStarted, invocation.request_id, started_at);
+
+                    EncodeBuffer lease;
+                    auto& buffer = lease.bytes();
+                    WireWriter writer(base_session_->serializer_type, buffer);
+
+                    try {
+                        handler->handler(invocation, writer);
+                    } catch (const ApplicationError& e) {
+                        metrics_.handler_errors.add();
+                        buffer.clear();
+                        encode_error(writer, WAMP_MESSAGE_INVOCATION, invocation.request_id, Dict(),
+                                     ERROR_RUNTIME_ERROR, e.list(), e.dict());
+                    } catch (...) {
+                        metrics_.handler_errors.add();
+                        buffer.clear();
+                        encode_error(writer, WAMP_MESSAGE_INVOCATION, invocation.request_id, Dict(),
+                                     ERROR_RUNTIME_ERROR, List(), Dict());
+                    }
+                    uint64_t finished_at = trace_now_ns();
+                    metrics_.handler_latency.record(finished_at - started_at);
+                    trace(sink, TraceStage::HandlerFinished, invocation.request_id, finished_at);
+                    if (running_invocation.reply_deferred) return;
+
+                    uint64_t locked_at = 0;
+                    send_reply(invocation.request_id, buffer, sink ? &locked_at : nullptr);
+                    trace(sink, TraceStage::YieldWriteLocked, invocation.request_id, locked_at);
+                    trace(sink, TraceStage::YieldWritten, invocation.request_id);
+                };
+                if (!handler->limiter) {
+                    pool_->post(handler->priority, std::move(task));
+                    return true;
+                }
+
+                std::function<void()> limited = std::move(task);
+                switch (handler->limiter->admit(limited)) {
+                    case ConcurrencyLimiter::Admission::Run:
+                        post_limited(handler->limiter, handler->priority, std::move(limited));
+                        break;
+                    case ConcurrencyLimiter::Admission::Queued:
+                        break;
+                    case ConcurrencyLimiter::Admission::Rejected: {
+                        metrics_.invocations_rejected.add();
+                        EncodeBuffer lease;
+                        auto& buffer = lease.bytes();
+                        WireWriter writer(base_session_->serializer_type, buffer);
+                        encode_error(writer, WAMP_MESSAGE_INVOCATION, request_id, Dict(), ERROR_UNAVAILABLE, List(),
+                                     Dict());
+                        send_reply(request_id, buffer);
+                        break;
+                    }
+                }
+            }
+            return true;
+        }
+        case WAMP_MESSAGE_EVENT: {
+            EventView event(frame);
+
+            metrics_.events.add();
+
+            auto handler = find_from_map(event.subscription_id, subscriptions_, subscriptions_mutex_, false);
+            if (handler && handler->batcher) {
+                uint64_t queued_at = trace_now_ns();
+                std::optional<std::string> key;
+                if (handler->conflation_key) {
+                    try {
+                        key = handler->conflation_key(event);
+                    } catch (const std::exception& e) {
+                        XCONN_LOG(LogLevel::Error, "Conflation key failed, event delivered as is: {}", e.what());
+                    }
+                }
+
+                bool post = false;
+                if (key) {
+                    bool replaced = false;
+                    post = handler->batcher->add(std::move(event), queued_at, std::move(*key), replaced);
+                    if (replaced) metrics_.events_conflated.add();
+                } else {
+                    post = handler->batcher->add(std::move(event), queued_at);
+                }
+                if (post) post_batch(*handler);
+            } else if (handler) {
+                uint64_t queued_at = trace_now_ns();
+                pool_->post(handler->priority, [this, handler, queued_at, event = std::move(event)]() mutable {
+                    uint64_t started_at = trace_now_ns();
+                    metrics_.queue_latency.record(started_at - queued_at);
+
+                    try {
+                        handler->handler(event);
+                    } catch (const std::exception& e) {
+                        metrics_.handler_errors.add();
+                        XCONN_LOG(LogLevel::Error, "Subscription handler execution failed: {}", e.what());
+                    } catch (...) {
+                        metrics_.handler_errors.add();
+                        XCONN_LOG(LogLevel::Error, "Subscription handler threw an unknown exception");
+                    }
+                    metrics_.handler_latency.record(trace_now_ns() - started_at);
+                });
+            }
+            return true;
+        }
+        case WAMP_MESSAGE_ERROR: {
+            ErrorView error(frame);
+            if (error.request_type != WAMP_MESSAGE_CALL) return false;
+            ChargeAllocs charge(metrics_.call_allocs);
+            trace(sink, TraceStage::ResultReceived, error.request_id, received_at);
+
+            // The error travels back as a value; nothing is thrown unless the caller asks for it.
+            auto maybe_promise = find_from_map(error.request_id, call_requests_, call_requests_mutex_);
+            if (maybe_promise.has_value()) {
+                trace(sink, TraceStage::ResultDecoded, error.request_id);
+                maybe_promise->complete(Unexpected(error.toError()));
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
 void Session::wait() {
     while (running_) {
         try {
-            Message* msg = base_session_->receive_message();
+            std::shared_ptr<WireFrame> frame = base_session_->receive_frame();
+            if (!frame) continue;
+            uint64_t received_at = tracer() ? trace_now_ns() : 0;
+            metrics_.record_received(frame->buffer.size());
+
+            if (process_incoming_frame(frame, received_at)) continue;
+
+            Message* msg = base_session_->deserialize(*frame);
             if (!msg) continue;
 
             process_incoming_message(msg);
         } catch (const std::system_error& e) {
-            std::cerr << "System closed the connection" << std::endl;
+            XCONN_LOG(LogLevel::Warning, "System closed the connection");
+            running_ = false;
         } catch (const std::exception& e) {
-            std::cerr << "Exception in wait(): " << e.what() << '\n';
+            XCONN_LOG(LogLevel::Error, "Exception in wait(): {}", e.what());
         } catch (...) {
-            std::cerr << "Unknown exception in wait()" << std::endl;
+            XCONN_LOG(LogLevel::Error, "Unknown exception in wait()");
         }
     }
+    // No reply can come now. Blocked callers find out from their own timeout.
+    fail_async_calls();
+}
+
+void Session::expire_call(uint64_t request_id) {
+    auto pending = find_from_map(request_id, call_requests_, call_requests_mutex_);
+    if (pending.has_value()) pending->complete(Unexpected(ApplicationError(ERROR_TIMEOUT)));
+}
+
+void Session::fail_async_calls() {
+    std::vector<PendingCall> closed;
+    {
+        std::lock_guard<std::mutex> lock(call_requests_mutex_);
+        for (auto it = call_requests_.begin(); it != call_requests_.end();) {
+            if (!it->second.on_reply) {
+                ++it;
+                continue;
+            }
+            closed.push_back(std::move(it->second));
+            it = call_requests_.erase(it);
+        }
+    }
+    for (PendingCall& pending : closed) pending.complete(Unexpected(ApplicationError(ERROR_CONNECTION_CLOSED)));
 }
 
 Session::CallRequest::CallRequest(Session& session, std::string procedure)
@@ -299,6 +629,7 @@ Session::CallRequest& Session::CallRequest::Arg(Value arg) {
 }
 
 Session::CallRequest& Session::CallRequest::Kwarg(std::string key, Value value) {
+    if (!typed_.kwargs.empty()) typed_.erase_kwarg(key);
     kwargs_[std::move(key)] = std::move(value);
     return *this;
 }
@@ -308,37 +639,203 @@ Session::CallRequest& Session::CallRequest::Option(std::string key, Value value)
     return *this;
 }
 
-Result Session::CallRequest::Do() const {
-    ::List* call_args = vector_to_list(args_);
-    ::Dict* call_kwargs = unordered_map_to_dict(kwargs_);
-    ::Dict* call_options = unordered_map_to_dict(options_);
+Session::CallRequest& Session::CallRequest::PassThru(std::string scheme, std::span<const uint8_t> payload,
+                                                    std::string serializer) {
+    set_passthru(options_, args_, kwargs_, typed_, std::move(scheme), payload, std::move(serializer));
+    return *this;
+}
+
+Result Session::CallRequest::Do() const { return DoView().toResult(); }
+
+ResultView Session::CallRequest::DoView() const { return value_or_throw(DoViewExpected()); }
+
+Expected<Result, ApplicationError> Session::CallRequest::DoExpected() const { return to_result(DoViewExpected()); }
+
+Expected<ResultView, ApplicationError> Session::CallRequest::DoViewExpected() const {
+    ChargeAllocs charge(session_.metrics_.call_allocs);
     uint64_t request_id = session_.id_generator->next();
+    trace(session_.tracer(), TraceStage::CallStarted, request_id);
 
-    ::Call* call = call_new(request_id, call_options, procedure_.c_str(), call_args, call_kwargs);
+    EncodeBuffer lease;
+    auto& buffer = lease.bytes();
+    WireWriter writer(session_.base_session_->serializer_type, buffer);
+    encode_call(writer, request_id, options_, procedure_, args_, kwargs_, &typed_);
+
+    return session_.send_call(request_id, buffer);
+}
 
-    std::promise<Result> promise;
-    std::future<Result> future = promise.get_future();
+Session::CallAwaiter Session::CallRequest::DoAsync(std::chrono::milliseconds timeout) const {
+    uint64_t request_id = session_.id_generator->next();
+    trace(session_.tracer(), TraceStage::CallStarted, request_id);
+
+    std::vector<uint8_t> message;
+    WireWriter writer(session_.base_session_->serializer_type, message);
+    encode_call(writer, request_id, options_, procedure_, args_, kwargs_, &typed_);
+    return CallAwaiter(session_, request_id, std::move(message), timeout);
+}
 
+Session::CallAwaiter::CallAwaiter(Session& session, uint64_t request_id, std::vector<uint8_t> message,
+                                  std::chrono::milliseconds timeout)
+    : session_(session), request_id_(request_id), message_(std::move(message)), timeout_(timeout) {}
+
+void Session::CallAwaiter::await_suspend(std::coroutine_handle<> awaiting) {
+    // The reply may resume the coroutine, and so destroy this awaiter, before send_bytes()
+    // returns; nothing below the send touches a member.
+    Session& session = session_;
+    uint64_t request_id = request_id_;
+    HandlerPriority lane = running_invocation.lane;
+    uint64_t sent_at = trace_now_ns();
+    auto deadline = DeadlineTimer::Clock::now() + timeout_;
+
+    PendingCall pending;
+    pending.on_reply = [this, &session, awaiting, lane, request_id, sent_at,
+                        deadline](Expected<ResultView, ApplicationError> outcome) {
+        session.call_deadlines_.cancel(deadline, request_id);
+        uint64_t completed_at = trace_now_ns();
+        session.metrics_.call_latency.record(completed_at - sent_at);
+        if (!outcome) session.metrics_.call_errors.add();
+        trace(session.tracer(), TraceStage::CallCompleted, request_id, completed_at);
+
+        outcome_.emplace(std::move(outcome));
+        session.pool_->post(lane, [awaiting, lane] {
+            running_invocation.lane = lane;
+            awaiting.resume();
+        });
+    };
     {
-        std::lock_guard<std::mutex> lock(session_.call_requests_mutex_);
-        session_.call_requests_.emplace(request_id, std::move(promise));
+        std::lock_guard<std::mutex> lock(session.call_requests_mutex_);
+        session.call_requests_.emplace(request_id, std::move(pending));
     }
+    session.call_deadlines_.schedule(deadline, request_id);
+
+    TraceSink* sink = session.tracer();
+    trace(sink, TraceStage::CallEncoded, request_id, sent_at);
+    try {
+        session.send_bytes(message_, nullptr);
+    } catch (...) {
+        // Not sent, so no reply will come; the coroutine resumes with the exception instead.
+        session.call_deadlines_.cancel(deadline, request_id);
+        std::lock_guard<std::mutex> lock(session.call_requests_mutex_);
+        if (session.call_requests_.erase(request_id) == 1) throw;
+        return;
+    }
+    session.metrics_.calls.add();
+    trace(sink, TraceStage::CallWritten, request_id);
+}
 
-    session_.send_message((Message*)call);
+Result Session::CallAwaiter::await_resume() { return value_or_throw(std::move(*outcome_)).toResult(); }
 
-    return session_.wait_with_timeout(future, TIMEOUT_SECONDS);
+Session::CallRequest Session::Call(std::string procedure) { return CallRequest(*this, std::move(procedure)); }
+
+Session::PreparedCall::PreparedCall(Session& session, std::string procedure, const Dict& options)
+    : session_(session),
+      constant_(encode_constant_fields(session.base_session_->serializer_type, options, procedure)) {}
+
+Result Session::PreparedCall::Do(const List& args, const Dict& kwargs) const { return DoView(args, kwargs).toResult(); }
+
+ResultView Session::PreparedCall::DoView(const List& args, const Dict& kwargs) const {
+    return value_or_throw(DoViewExpected(args, kwargs));
 }
 
-Session::CallRequest Session::Call(std::string procedure) { return CallRequest(*this, std::move(procedure)); }
+Expected<Result, ApplicationError> Session::PreparedCall::DoExpected(const List& args, const Dict& kwargs) const {
+    return to_result(DoViewExpected(args, kwargs));
+}
+
+Expected<ResultView, ApplicationError> Session::PreparedCall::DoViewExpected(const List& args,
+                                                                             const Dict& kwargs) const {
+    ChargeAllocs charge(session_.metrics_.call_allocs);
+    uint64_t request_id = session_.id_generator->next();
+    trace(session_.tracer(), TraceStage::CallStarted, request_id);
+
+    EncodeBuffer lease;
+    auto& buffer = lease.bytes();
+    WireWriter writer(session_.base_session_->serializer_type, buffer);
+    encode_prepared(writer, WAMP_MESSAGE_CALL, request_id, constant_, args, kwargs);
+
+    return session_.send_call(request_id, buffer);
+}
+
+Session::PreparedCall Session::PrepareCall(std::string procedure, const Dict& options) {
+    return PreparedCall(*this, std::move(procedure), options);
+}
+
+Expected<ResultView, ApplicationError> Session::send_call(uint64_t request_id, const std::vector<uint8_t>& message) {
+    PendingCall pending;
+    std::future<Expected<ResultView, ApplicationError>> future = pending.promise.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(call_requests_mutex_);
+        call_requests_.emplace(request_id, std::move(pending));
+    }
+
+    TraceSink* sink = tracer();
+    uint64_t sent_at = trace_now_ns();
+    trace(sink, TraceStage::CallEncoded, request_id, sent_at);
+
+    uint64_t locked_at = 0;
+    try {
+        send_bytes(message, sink ? &locked_at : nullptr);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(call_requests_mutex_);
+        call_requests_.erase(request_id);
+        throw;
+    }
+    metrics_.calls.add();
+    trace(sink, TraceStage::CallWriteLocked, request_id, locked_at);
+    trace(sink, TraceStage::CallWritten, request_id);
+
+    auto outcome = wait_with_timeout(future, TIMEOUT_SECONDS);
+    uint64_t completed_at = trace_now_ns();
+    metrics_.call_latency.record(completed_at - sent_at);
+    if (!outcome) metrics_.call_errors.add();
+    trace(sink, TraceStage::CallCompleted, request_id, completed_at);
+    return outcome;
+}
 
 Session::RegisterRequest::RegisterRequest(Session& session, const std::string procedure, ProcedureHandler handler)
+    : procedure_(std::move(procedure)),
+      session_(session),
+      handler_([handler = std::move(handler)](const InvocationView& invocation, WireWriter& writer) {
+          Result result = handler(invocation.toInvocation());
+          encode_yield(writer, invocation.request_id, result.details, result.args, result.kwargs);
+      }) {}
+
+Session::RegisterRequest::RegisterRequest(Session& session, const std::string procedure,
+                                          ProcedureViewHandler handler)
+    : procedure_(std::move(procedure)),
+      session_(session),
+      handler_([handler = std::move(handler)](const InvocationView& invocation, WireWriter& writer) {
+          Result result = handler(invocation);
+          encode_yield(writer, invocation.request_id, result.details, result.args, result.kwargs);
+      }) {}
+
+Session::RegisterRequest::RegisterRequest(Session& session, const std::string procedure, RawProcedureHandler handler)
     : procedure_(std::move(procedure)), session_(session), handler_(std::move(handler)) {}
 
+Session::RegisterRequest::RegisterRequest(Session& session, const std::string procedure,
+                                          AsyncProcedureHandler handler)
+    : procedure_(std::move(procedure)),
+      session_(session),
+      handler_([&session, handler = std::move(handler)](const InvocationView& invocation, WireWriter&) {
+          session.yield_async(invocation.request_id, handler(invocation.toInvocation()));
+      }) {}
+
 Session::RegisterRequest& Session::RegisterRequest::Option(std::string key, Value value) {
     options[std::move(key)] = std::move(value);
     return *this;
 }
 
+Session::RegisterRequest& Session::RegisterRequest::Priority(HandlerPriority priority) {
+    priority_ = priority;
+    return *this;
+}
+
+Session::RegisterRequest& Session::RegisterRequest::Concurrency(size_t limit, size_t max_queued) {
+    concurrency_ = limit;
+    max_queued_ = max_queued;
+    return *this;
+}
+
 Registration Session::RegisterRequest::Do() const {
     ::Dict* regsiter_options = unordered_map_to_dict(options);
     uint64_t request_id = session_.id_generator->next();
@@ -348,7 +845,10 @@ Registration Session::RegisterRequest::Do() const {
     std::promise<Registration> promise;
     std::future<Registration> future = promise.get_future();
 
-    xconn::RegisterRequest request(std::move(promise), handler_);
+    std::shared_ptr<ConcurrencyLimiter> limiter;
+    if (concurrency_ > 0) limiter = std::make_shared<ConcurrencyLimiter>(concurrency_, max_queued_);
+
+    xconn::RegisterRequest request(std::move(promise), handler_, priority_, std::move(limiter));
     {
         std::lock_guard<std::mutex> lock(session_.register_requests_mutex_);
         session_.register_requests_.emplace(request_id, std::move(request));
@@ -383,6 +883,51 @@ Session::RegisterRequest Session::Register(std::string procedure, ProcedureHandl
     return RegisterRequest(*this, std::move(procedure), std::move(handler));
 }
 
+Session::RegisterRequest Session::Register(std::string procedure, ProcedureViewHandler handler) {
+    return RegisterRequest(*this, std::move(procedure), std::move(handler));
+}
+
+Session::RegisterRequest Session::Register(std::string procedure, AsyncProcedureHandler handler) {
+    return RegisterRequest(*this, std::move(procedure), std::move(handler));
+}
+
+void Session::yield_async(uint64_t request_id, Task<Result> task) {
+    // Set before the task starts: whatever it sends before its first suspension, or its reply
+    // if it never suspends, must not be taken for the invocation's reply.
+    running_invocation.reply_deferred = true;
+    // The invocation's slot stays taken until the reply is out, not just until the task suspends.
+    auto limiter = std::move(running_invocation.limiter);
+    HandlerPriority lane = running_invocation.lane;
+    std::move(task).detach([this, request_id, limiter = std::move(limiter), lane](std::optional<Result> result,
+                                                                                std::exception_ptr error) mutable {
+        EncodeBuffer lease;
+        auto& message = lease.bytes();
+        WireWriter writer(base_session_->serializer_type, message);
+        if (result) {
+            encode_yield(writer, request_id, result->details, result->args, result->kwargs);
+        } else {
+            metrics_.handler_errors.add();
+            try {
+                std::rethrow_exception(error);
+            } catch (const ApplicationError& e) {
+                encode_error(writer, WAMP_MESSAGE_INVOCATION, request_id, Dict(), ERROR_RUNTIME_ERROR, e.list(),
+                             e.dict());
+            } catch (...) {
+                encode_error(writer, WAMP_MESSAGE_INVOCATION, request_id, Dict(), ERROR_RUNTIME_ERROR, List(), Dict());
+            }
+        }
+        // This runs inside the coroutine's final suspend, which must not throw.
+        try {
+            send_reply(request_id, message);
+        } catch (const std::exception& e) {
+            XCONN_LOG(LogLevel::Warning, "Could not send async handler reply: {}", e.what());
+        } catch (...) {
+            XCONN_LOG(LogLevel::Warning, "Could not send async handler reply");
+        }
+        if (limiter) release_slot(limiter, lane);
+    });
+}
+
 void Registration::unregister() { return session.Unregister(registration_id); }
 
 Session::PublishRequest::PublishRequest(Session& session, std::string topic)
@@ -394,6 +939,7 @@ Session::PublishRequest& Session::PublishRequest::Arg(Value arg) {
 }
 
 Session::PublishRequest& Session::PublishRequest::Kwarg(std::string key, Value value) {
+    if (!typed_.kwargs.empty()) typed_.erase_kwarg(key);
     kwargs_[std::move(key)] = std::move(value);
     return *this;
 }
@@ -403,47 +949,116 @@ Session::PublishRequest& Session::PublishRequest::Option(std::string key, Value
     return *this;
 }
 
+Session::PublishRequest& Session::PublishRequest::PassThru(std::string scheme, std::span<const uint8_t> payload,
+                                                          std::string serializer) {
+    set_passthru(options_, args_, kwargs_, typed_, std::move(scheme), payload, std::move(serializer));
+    return *this;
+}
+
 Session::PublishRequest& Session::PublishRequest::Acknowledge(bool value) {
     options_["acknowledge"] = std::move(value);
     return *this;
 }
 
 void Session::PublishRequest::Do() const {
-    ::List* publish_args = vector_to_list(args_);
-    ::Dict* publish_kwargs = unordered_map_to_dict(kwargs_);
-    ::Dict* publish_options = unordered_map_to_dict(options_);
+    ChargeAllocs charge(session_.metrics_.publish_allocs);
     uint64_t request_id = session_.id_generator->next();
 
-    ::Publish* publish = publish_new(request_id, publish_options, topic_.c_str(), publish_args, publish_kwargs);
+    EncodeBuffer lease;
+    auto& buffer = lease.bytes();
+    WireWriter writer(session_.base_session_->serializer_type, buffer);
+    encode_publish(writer, request_id, options_, topic_, args_, kwargs_, &typed_);
 
-    std::promise<void> promise;
-    std::future<void> future = promise.get_future();
+    session_.send_publish(request_id, buffer, wants_acknowledge(options_));
+}
+
+Session::PublishRequest Session::Publish(std::string topic) { return PublishRequest(*this, std::move(topic)); }
+
+Session::PreparedPublish::PreparedPublish(Session& session, std::string topic, const Dict& options)
+    : session_(session),
+      constant_(encode_constant_fields(session.base_session_->serializer_type, options, topic)),
+      acknowledge_(wants_acknowledge(options)) {}
+
+void Session::PreparedPublish::Do(const List& args, const Dict& kwargs) const {
+    ChargeAllocs charge(session_.metrics_.publish_allocs);
+    uint64_t request_id = session_.id_generator->next();
+
+    EncodeBuffer lease;
+    auto& buffer = lease.bytes();
+    WireWriter writer(session_.base_session_->serializer_type, buffer);
+    encode_prepared(writer, WAMP_MESSAGE_PUBLISH, request_id, constant_, args, kwargs);
+
+    session_.send_publish(request_id, buffer, acknowledge_);
+}
 
-    auto acknowledge = false;
+Session::PreparedPublish Session::PreparePublish(std::string topic, const Dict& options) {
+    return PreparedPublish(*this, std::move(topic), options);
+}
 
-    auto it = options_.find("acknowledge");
-    if (it != options_.end()) acknowledge = it->second.getBool().value();
+void Session::send_publish(uint64_t request_id, const std::vector<uint8_t>& message, bool acknowledge) {
+    std::promise<void> promise;
+    std::future<void> future = promise.get_future();
 
     if (acknowledge) {
-        std::lock_guard<std::mutex> lock(session_.publish_requests_mutex_);
-        session_.publish_requests_.emplace(request_id, std::move(promise));
+        std::lock_guard<std::mutex> lock(publish_requests_mutex_);
+        publish_requests_.emplace(request_id, std::move(promise));
     }
 
-    session_.send_message((Message*)publish);
+    try {
+        send_bytes(message);
+    } catch (...) {
+        if (acknowledge) {
+            std::lock_guard<std::mutex> lock(publish_requests_mutex_);
+            publish_requests_.erase(request_id);
+        }
+        throw;
+    }
+    metrics_.publishes.add();
 
-    if (acknowledge) session_.wait_with_timeout(future, TIMEOUT_SECONDS);
+    if (acknowledge) wait_with_timeout(future, TIMEOUT_SECONDS);
 }
 
-Session::PublishRequest Session::Publish(std::string topic) { return PublishRequest(*this, std::move(topic)); }
-
 Session::SubscribeRequest::SubscribeRequest(Session& session, std::string topic, EventHandler handler)
+    : session_(session),
+      topic_(std::move(topic)),
+      handler_([handler = std::move(handler)](const EventView& event) { handler(event.toEvent()); }) {}
+
+Session::SubscribeRequest::SubscribeRequest(Session& session, std::string topic, EventViewHandler handler)
     : session_(session), topic_(std::move(topic)), handler_(std::move(handler)) {}
 
+Session::SubscribeRequest::SubscribeRequest(Session& session, std::string topic, EventBatchHandler handler)
+    : session_(session),
+      topic_(std::move(topic)),
+      batch_handler_([handler = std::move(handler)](std::span<const EventView> views) {
+          std::vector<Event> events;
+          events.reserve(views.size());
+          for (const EventView& view : views) events.push_back(view.toEvent());
+          handler(std::span<const Event>(events));
+      }) {}
+
+Session::SubscribeRequest::SubscribeRequest(Session& session, std::string topic, EventViewBatchHandler handler)
+    : session_(session), topic_(std::move(topic)), batch_handler_(std::move(handler)) {}
+
 Session::SubscribeRequest& Session::SubscribeRequest::Option(std::string key, xconn::Value value) {
     options_[std::move(key)] = std::move(value);
     return *this;
 }
 
+Session::SubscribeRequest& Session::SubscribeRequest::Priority(HandlerPriority priority) {
+    priority_ = priority;
+    return *this;
+}
+
+Session::SubscribeRequest& Session::SubscribeRequest::MaxBatch(size_t max_events) {
+    max_batch_ = max_events;
+    return *this;
+}
+
+Session::SubscribeRequest& Session::SubscribeRequest::Conflate(ConflationKey key) {
+    conflation_key_ = std::move(key);
+    return *this;
+}
+
 Subscription Session::SubscribeRequest::Do() const {
     ::Dict* options = unordered_map_to_dict(options_);
     uint64_t request_id = session_.id_generator->next();
@@ -453,7 +1068,20 @@ Subscription Session::SubscribeRequest::Do() const {
     std::promise<Subscription> promise;
     std::future<Subscription> future = promise.get_future();
 
-    auto request = xconn::SubscribeRequest(std::move(promise), handler_);
+    // A conflating subscription with a per-event handler drains its batcher one event at a time.
+    EventViewBatchHandler batch_handler = batch_handler_;
+    std::shared_ptr<EventBatcher> batcher;
+    if (batch_handler) {
+        batcher = std::make_shared<EventBatcher>(max_batch_);
+    } else if (conflation_key_) {
+        batcher = std::make_shared<EventBatcher>(1);
+        batch_handler = [handler = handler_](std::span<const EventView> events) {
+            for (const EventView& event : events) handler(event);
+        };
+    }
+
+    auto request = xconn::SubscribeRequest(std::move(promise), handler_, priority_, std::move(batch_handler),
+                                           std::move(batcher), conflation_key_);
     {
         std::lock_guard<std::mutex> lock(session_.subscribe_requests_mutex_);
         session_.subscribe_requests_.emplace(request_id, std::move(request));
@@ -468,6 +1096,18 @@ Session::SubscribeRequest Session::Subscribe(std::string topic, EventHandler han
     return SubscribeRequest(*this, std::move(topic), std::move(handler));
 }
 
+Session::SubscribeRequest Session::Subscribe(std::string topic, EventViewHandler handler) {
+    return SubscribeRequest(*this, std::move(topic), std::move(handler));
+}
+
+Session::SubscribeRequest Session::Subscribe(std::string topic, EventBatchHandler handler) {
+    return SubscribeRequest(*this, std::move(topic), std::move(handler));
+}
+
+Session::SubscribeRequest Session::Subscribe(std::string topic, EventViewBatchHandler handler) {
+    return SubscribeRequest(*this, std::move(topic), std::move(handler));
+}
+
 void Session::Unsubscribe(uint64_t subscription_id) {
     uint64_t request_id = id_generator->next();
 
@@ -1,18 +1,24 @@
 #include "xconn_cpp/session_joiner.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
 #include <wampproto.h>
 
 #include "xconn_cpp/authenticators.hpp"
 #include "xconn_cpp/internal/base_session.hpp"
+#include "xconn_cpp/internal/log.hpp"
 #include "xconn_cpp/internal/socket_transport.hpp"
 #include "xconn_cpp/types.hpp"
 #include "xconn_cpp/url_parser.hpp"
 
 namespace xconn {
 
-SessionJoiner::SessionJoiner(Authenticator authenticator, SerializerType serializer_type)
-    : authenticator_(authenticator), serializer_type_(serializer_type), serializer_(nullptr) {
+SessionJoiner::SessionJoiner(Authenticator authenticator, SerializerType serializer_type, std::size_t max_msg_size)
+    : authenticator_(authenticator),
+      serializer_type_(serializer_type),
+      max_msg_size_(std::clamp<std::size_t>(max_msg_size, 512, MAX_MSG_SIZE)),
+      serializer_(nullptr) {
     switch (serializer_type_) {
         case xconn::SerializerType::JSON:
             serializer_ = json_serializer_new();
@@ -30,11 +36,19 @@ SessionJoiner::SessionJoiner(Authenticator authenticator, SerializerType seriali
 
 SessionJoiner::~SessionJoiner() {}
 
-std::unique_ptr<BaseSession> SessionJoiner::join(std::string& uri, std::string& realm) {
+std::unique_ptr<BaseSession> SessionJoiner::join(std::string& uri, std::string& realm, ConnectTimings* timings) {
+    using Clock = std::chrono::steady_clock;
+    auto started = Clock::now();
+
     auto transport = SocketTransport::Create(uri);
     UrlParser parser = parse_url(uri);
 
-    transport->connect(parser.host, parser.port, serializer_type_, MAX_MSG_SIZE);
+    if (!transport->connect(parser.host, parser.port, serializer_type_, max_msg_size_)) {
+        throw std::runtime_error("Failed to connect to " + uri);
+    }
+
+    auto connected = Clock::now();
+    if (timings) timings->transport += connected - started;
 
     Joiner* joiner = joiner_new(realm.c_str(), serializer_, authenticator_.authenticator);
     ::Bytes hello = joiner->send_hello(joiner);
@@ -46,8 +60,9 @@ std::unique_ptr<BaseSession> SessionJoiner::join(std::string& uri, std::string&
         ::Bytes to_send = joiner->receive(joiner, bytes);
 
         if (to_send.len == 0) {
-            std::cout << "Successfully created WAMP Session" << std::endl;
-            return std::make_unique<BaseSession>(transport, joiner->session_details, serializer_);
+            if (timings) timings->join += Clock::now() - connected;
+            XCONN_LOG(LogLevel::Info, "Successfully created WAMP Session");
+            return std::make_unique<BaseSession>(transport, joiner->session_details, serializer_, serializer_type_);
         }
         transport->write(to_send);
     }
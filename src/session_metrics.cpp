@@ -0,0 +1,188 @@
+#include "xconn_cpp/session_metrics.hpp"
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+namespace xconn {
+
+SessionMetricsSnapshot SessionMetrics::snapshot() const {
+    SessionMetricsSnapshot snap;
+    snap.messages_sent = messages_sent.value();
+    snap.bytes_sent = bytes_sent.value();
+    snap.messages_received = messages_received.value();
+    snap.bytes_received = bytes_received.value();
+
+    snap.calls = calls.value();
+    snap.call_errors = call_errors.value();
+    snap.publishes = publishes.value();
+    snap.invocations = invocations.value();
+    snap.events = events.value();
+    snap.handler_errors = handler_errors.value();
+    snap.invocations_rejected = invocations_rejected.value();
+    snap.event_batches = event_batches.value();
+    snap.events_conflated = events_conflated.value();
+
+    snap.call_latency = call_latency.snapshot();
+    snap.queue_latency = queue_latency.snapshot();
+    snap.handler_latency = handler_latency.snapshot();
+
+    snap.call_allocs = call_allocs.value();
+    snap.publish_allocs = publish_allocs.value();
+    snap.invocation_allocs = invocation_allocs.value();
+    return snap;
+}
+
+namespace {
+
+class PrometheusWriter {
+   public:
+    explicit PrometheusWriter(const std::vector<std::pair<std::string, std::string>>& labels) {
+        for (const auto& [name, value] : labels) {
+            if (!labels_.empty()) labels_ += ',';
+            labels_ += name;
+            labels_ += "=\"";
+            append_escaped(labels_, value);
+            labels_ += '"';
+        }
+    }
+
+    void header(std::string_view name, std::string_view type, std::string_view help) {
+        out_ += "# HELP ";
+        out_ += name;
+        out_ += ' ';
+        out_ += help;
+        out_ += "\n# TYPE ";
+        out_ += name;
+        out_ += ' ';
+        out_ += type;
+        out_ += '\n';
+    }
+
+    // Counts are printed as integers, so large counters keep their low digits.
+    void sample(std::string_view name, uint64_t value, std::string_view extra_label = {}) {
+        series(name, extra_label);
+        char number[32];
+        std::snprintf(number, sizeof(number), " %llu\n", static_cast<unsigned long long>(value));
+        out_ += number;
+    }
+
+    // Enough digits for the value to read back exactly.
+    void sample(std::string_view name, double value, std::string_view extra_label = {}) {
+        series(name, extra_label);
+        char number[40];
+        std::snprintf(number, sizeof(number), " %.17g\n", value);
+        out_ += number;
+    }
+
+    void counter(std::string_view name, uint64_t value, std::string_view help) {
+        header(name, "counter", help);
+        sample(name, value);
+    }
+
+    void gauge(std::string_view name, uint64_t value, std::string_view help) {
+        header(name, "gauge", help);
+        sample(name, value);
+    }
+
+    // Nanosecond histograms are exported as summaries in seconds.
+    void summary(const std::string& name, const HistogramSnapshot& snap, std::string_view help) {
+        header(name, "summary", help);
+        sample(name, snap.p50 / 1e9, "quantile=\"0.5\"");
+        sample(name, snap.p90 / 1e9, "quantile=\"0.9\"");
+        sample(name, snap.p99 / 1e9, "quantile=\"0.99\"");
+        sample(name, snap.p999 / 1e9, "quantile=\"0.999\"");
+        sample(name + "_sum", snap.mean * double(snap.count) / 1e9);
+        sample(name + "_count", snap.count);
+    }
+
+    std::string take() { return std::move(out_); }
+
+   private:
+    std::string labels_;
+    std::string out_;
+
+    void series(std::string_view name, std::string_view extra_label) {
+        out_ += name;
+        if (!labels_.empty() || !extra_label.empty()) {
+            out_ += '{';
+            out_ += labels_;
+            if (!labels_.empty() && !extra_label.empty()) out_ += ',';
+            out_ += extra_label;
+            out_ += '}';
+        }
+    }
+
+    static void append_escaped(std::string& out, std::string_view value) {
+        for (char c : value) {
+            if (c == '\\' || c == '"') {
+                out += '\\';
+                out += c;
+            } else if (c == '\n') {
+                out += "\\n";
+            } else {
+                out += c;
+            }
+        }
+    }
+};
+
+}  // namespace
+
+std::string to_prometheus(const SessionMetricsSnapshot& snapshot,
+                          const std::vector<std::pair<std::string, std::string>>& labels) {
+    PrometheusWriter writer(labels);
+
+    writer.counter("xconn_messages_sent_total", snapshot.messages_sent, "WAMP messages sent.");
+    writer.counter("xconn_bytes_sent_total", snapshot.bytes_sent, "Encoded message bytes sent.");
+    writer.counter("xconn_messages_received_total", snapshot.messages_received, "WAMP messages received.");
+    writer.counter("xconn_bytes_received_total", snapshot.bytes_received, "Encoded message bytes received.");
+    writer.counter("xconn_calls_total", snapshot.calls, "CALLs sent.");
+    writer.counter("xconn_call_errors_total", snapshot.call_errors, "CALLs answered with an ERROR.");
+    writer.counter("xconn_publishes_total", snapshot.publishes, "PUBLISHes sent.");
+    writer.counter("xconn_invocations_total", snapshot.invocations, "INVOCATIONs received.");
+    writer.counter("xconn_events_total", snapshot.events, "EVENTs received.");
+    writer.counter("xconn_handler_errors_total", snapshot.handler_errors, "Invocation and event handlers that threw.");
+    writer.counter("xconn_invocations_rejected_total", snapshot.invocations_rejected,
+                   "INVOCATIONs refused because their registration's concurrency queue was full.");
+    writer.counter("xconn_event_batches_total", snapshot.event_batches,
+                   "Batches handed to batch subscription handlers.");
+    writer.counter("xconn_events_conflated_total", snapshot.events_conflated,
+                   "EVENTs replaced by a newer one with the same conflation key before delivery.");
+
+    writer.header("xconn_pending_requests", "gauge", "Requests waiting for a reply from the router.");
+    writer.sample("xconn_pending_requests", uint64_t(snapshot.pending_calls), "request=\"call\"");
+    writer.sample("xconn_pending_requests", uint64_t(snapshot.pending_publishes), "request=\"publish\"");
+    writer.sample("xconn_pending_requests", uint64_t(snapshot.pending_registers), "request=\"register\"");
+    writer.sample("xconn_pending_requests", uint64_t(snapshot.pending_unregisters), "request=\"unregister\"");
+    writer.sample("xconn_pending_requests", uint64_t(snapshot.pending_subscribes), "request=\"subscribe\"");
+    writer.sample("xconn_pending_requests", uint64_t(snapshot.pending_unsubscribes), "request=\"unsubscribe\"");
+    writer.gauge("xconn_registrations", snapshot.registrations, "Procedures registered by the session.");
+    writer.gauge("xconn_subscriptions", snapshot.subscriptions, "Topics subscribed by the session.");
+    writer.gauge("xconn_pool_queue_depth", snapshot.pool_queue_depth, "Handlers waiting for a pool thread.");
+
+    writer.summary("xconn_call_latency_seconds", snapshot.call_latency, "CALL round trip as seen by the caller.");
+    writer.summary("xconn_queue_latency_seconds", snapshot.queue_latency, "Wait for a pool thread before a handler.");
+    writer.summary("xconn_handler_latency_seconds", snapshot.handler_latency, "Time spent in handlers.");
+    writer.summary("xconn_rtt_seconds", snapshot.rtt, "Transport PING/PONG round trip.");
+
+    if (alloc_accounting_enabled()) {
+        const std::pair<const char*, const AllocStats*> operations[] = {
+            {"operation=\"call\"", &snapshot.call_allocs},
+            {"operation=\"publish\"", &snapshot.publish_allocs},
+            {"operation=\"invocation\"", &snapshot.invocation_allocs},
+        };
+        writer.header("xconn_allocations_total", "counter", "Heap allocations made while serving operations.");
+        for (const auto& [label, stats] : operations) {
+            writer.sample("xconn_allocations_total", stats->allocations, label);
+        }
+        writer.header("xconn_allocated_bytes_total", "counter", "Heap bytes allocated while serving operations.");
+        for (const auto& [label, stats] : operations) {
+            writer.sample("xconn_allocated_bytes_total", stats->bytes, label);
+        }
+    }
+
+    return writer.take();
+}
+
+}  // namespace xconn
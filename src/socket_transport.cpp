@@ -1,12 +1,17 @@
 #include "xconn_cpp/internal/socket_transport.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
-#include <iostream>
 #include <memory>
-#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
 #include <vector>
 #include <wampproto.h>
 
+#include "xconn_cpp/internal/log.hpp"
+#include "xconn_cpp/tracing.hpp"
 #include "xconn_cpp/transports.hpp"
 #include "xconn_cpp/types.hpp"
 #include "xconn_cpp/url_parser.hpp"
@@ -15,7 +20,17 @@ namespace xconn {
 
 SocketTransport::SocketTransport(asio::io_context& io, UrlParser& url) : transport_(create_transport(io, url)) {}
 
-SocketTransport::~SocketTransport() { close(); }
+SocketTransport::SocketTransport(std::unique_ptr<Transport> transport, size_t max_recv_size, size_t max_send_size)
+    : transport_(std::move(transport)), max_recv_size_(max_recv_size), max_send_size_(max_send_size) {}
+
+SocketTransport::~SocketTransport() {
+    stop_keepalive();
+    try {
+        close();
+    } catch (const std::exception& e) {
+        XCONN_LOG(LogLevel::Error, "Close error: {}", e.what());
+    }
+}
 
 std::shared_ptr<SocketTransport> SocketTransport::Create(std::string& url) {
     static asio::io_context io;
@@ -23,6 +38,8 @@ std::shared_ptr<SocketTransport> SocketTransport::Create(std::string& url) {
     return std::make_shared<SocketTransport>(io, parser);
 }
 
+static size_t rawsocket_max_length(uint8_t handshake_octet) { return size_t(1) << (9 + (handshake_octet >> 4)); }
+
 bool SocketTransport::connect(const std::string& host, const std::string& port, xconn::SerializerType serializer_type,
                               int max_msg_size) {
     try {
@@ -52,39 +69,185 @@ bool SocketTransport::connect(const std::string& host, const std::string& port,
             return false;
         }
 
+        // The second handshake octet carries the maximum frame length as 2^(9 + n), our limit
+        // for what we accept and the router's for what we may send.
+        max_recv_size_ = rawsocket_max_length(hs_request[1]);
+        max_send_size_ = rawsocket_max_length(hs_response[1]);
+
         handshake_free(hs);
         handshake_free(response);
         return true;
     } catch (std::exception& e) {
-        std::cerr << "Connect error: " << e.what() << std::endl;
+        XCONN_LOG(LogLevel::Error, "Connect error: {}", e.what());
         return false;
     }
 }
 
 bool SocketTransport::recv_exactly(uint8_t* buffer, size_t n) {
-    if (transport_->read(buffer, n) != n) {
-        return false;
+    size_t received = 0;
+    while (received < n) {
+        size_t count = transport_->read(buffer + received, n - received);
+        if (count == 0) return false;
+        received += count;
     }
     return true;
 }
 
+static int64_t steady_now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
 std::vector<uint8_t> SocketTransport::read() {
-    uint8_t header_bytes[4];
-    if (!recv_exactly(header_bytes, 4)) return {};
+    std::vector<uint8_t> payload;
+    if (!read_into(payload)) return {};
+    return payload;
+}
 
-    MessageHeader* header = receive_message_header(header_bytes);
-    if (!header) return {};
+bool SocketTransport::read_into(std::vector<uint8_t>& payload) {
+    try {
+        if (read_frame(payload)) return true;
+    } catch (const std::system_error&) {
+        if (!keepalive_expired_) throw;
+    }
+    if (!keepalive_expired_) return false;
+
+    // Closed here rather than by the keepalive thread, so never under a read in progress.
+    close();
+    throw std::system_error(std::make_error_code(std::errc::timed_out), "Keepalive timeout, connection closed");
+}
+
+bool SocketTransport::read_frame(std::vector<uint8_t>& payload) {
+    while (true) {
+        uint8_t header_bytes[4];
+        if (!recv_exactly(header_bytes, 4)) return false;
+
+        uint8_t frame_type = header_bytes[0] & 0x07;
+        size_t length = (size_t(header_bytes[1]) << 16) | (size_t(header_bytes[2]) << 8) | size_t(header_bytes[3]);
+
+        if (length > max_recv_size_) {
+            // RawSocket requires dropping a peer that exceeds the limit it agreed to.
+            close();
+            throw std::system_error(std::make_error_code(std::errc::message_size),
+                                    "Received frame of " + std::to_string(length) + " bytes, limit is " +
+                                        std::to_string(max_recv_size_));
+        }
 
-    std::vector<uint8_t> payload(header->length);
-    if (!recv_exactly(payload.data(), payload.size())) {
-        message_header_free(header);
-        return {};
+        if (!recv_payload(payload, length)) return false;
+
+        if (frame_type == FRAME_TYPE_WAMP) return true;
+
+        // PING and PONG frames are handled here and never surface to the session.
+        if (frame_type == FRAME_TYPE_PING) {
+            write_frame(FRAME_TYPE_PONG, payload.data(), payload.size());
+        } else if (frame_type == FRAME_TYPE_PONG) {
+            handle_pong(payload);
+        }
     }
+}
 
-    message_header_free(header);
-    return payload;
+bool SocketTransport::recv_payload(std::vector<uint8_t>& payload, size_t length) {
+    // Grow the buffer as bytes arrive rather than trusting the header up front, so a large
+    // announced length does not turn into one big allocation before any data is received.
+    payload.clear();
+    while (payload.size() < length) {
+        size_t offset = payload.size();
+        size_t chunk = std::min(length - offset, std::max(offset, RECV_CHUNK_SIZE));
+        payload.resize(offset + chunk);
+        if (!recv_exactly(payload.data() + offset, chunk)) return false;
+    }
+    return true;
+}
+
+bool SocketTransport::write_frame(uint8_t frame_type, const uint8_t* data, size_t length, uint64_t* locked_at) {
+    uint8_t header_bytes[4] = {frame_type, uint8_t(length >> 16), uint8_t(length >> 8), uint8_t(length)};
+
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (locked_at) *locked_at = trace_now_ns();
+    try {
+        transport_->write(header_bytes, 4);
+        if (length > 0) transport_->write(data, length);
+        return true;
+    } catch (std::exception& e) {
+        XCONN_LOG(LogLevel::Error, "Write error: {}", e.what());
+        return false;
+    }
+}
+
+void SocketTransport::handle_pong(const std::vector<uint8_t>& payload) {
+    if (payload.size() != 8) return;
+
+    int64_t sent_at = 0;
+    for (uint8_t byte : payload) sent_at = (sent_at << 8) | byte;
+
+    int64_t rtt = steady_now_ns() - sent_at;
+    if (rtt >= 0) rtt_.record(static_cast<uint64_t>(rtt));
+
+    int64_t expected = sent_at;
+    ping_sent_at_.compare_exchange_strong(expected, 0);
+}
+
+void SocketTransport::start_keepalive(KeepaliveOptions options) {
+    stop_keepalive();
+
+    {
+        std::lock_guard<std::mutex> lock(keepalive_mutex_);
+        keepalive_stop_ = false;
+    }
+    ping_sent_at_ = 0;
+    keepalive_expired_ = false;
+    keepalive_thread_ = std::thread(&SocketTransport::keepalive_loop, this, options);
 }
 
+void SocketTransport::stop_keepalive() {
+    {
+        std::lock_guard<std::mutex> lock(keepalive_mutex_);
+        keepalive_stop_ = true;
+    }
+    keepalive_cv_.notify_all();
+
+    if (keepalive_thread_.joinable() && keepalive_thread_.get_id() != std::this_thread::get_id()) {
+        keepalive_thread_.join();
+    }
+}
+
+void SocketTransport::keepalive_loop(KeepaliveOptions options) {
+    const int64_t interval_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options.interval).count();
+    const int64_t timeout_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(options.timeout).count();
+    // Wake often enough to notice a missed PONG well within the timeout.
+    auto tick = std::max(std::min(options.interval, options.timeout / 4), std::chrono::milliseconds(1));
+
+    int64_t next_ping_at = steady_now_ns();
+
+    std::unique_lock<std::mutex> lock(keepalive_mutex_);
+    while (!keepalive_stop_) {
+        lock.unlock();
+
+        int64_t now = steady_now_ns();
+        int64_t outstanding = ping_sent_at_.load();
+        if (outstanding != 0 && now - outstanding > timeout_ns) {
+            XCONN_LOG(LogLevel::Warning, "Keepalive timeout, closing connection");
+            keepalive_expired_ = true;
+            transport_->shutdown();
+            return;
+        }
+
+        if (outstanding == 0 && now >= next_ping_at) {
+            uint8_t payload[8];
+            for (int i = 7; i >= 0; --i) payload[7 - i] = uint8_t(now >> (i * 8));
+
+            ping_sent_at_ = now;
+            next_ping_at = now + interval_ns;
+            if (!write_frame(FRAME_TYPE_PING, payload, sizeof(payload))) return;
+        }
+
+        lock.lock();
+        keepalive_cv_.wait_for(lock, tick, [this] { return keepalive_stop_; });
+    }
+}
+
+HistogramSnapshot SocketTransport::rtt() const { return rtt_.snapshot(); }
+
 ::Bytes SocketTransport::read_bytes() {
     std::vector<uint8_t> data = read();
     std::string str(data.begin(), data.end());
@@ -96,33 +259,20 @@ std::vector<uint8_t> SocketTransport::read() {
     return bytes;
 }
 
-bool SocketTransport::write(::Bytes& bytes) {
-    std::lock_guard<std::mutex> lock(write_mutex_);
-
-    // DEBUG LOGS MESSAGES
-    // std::cout << bytes.data << std::endl;
-
-    MessageType MSG_TYPE_WAMP = MESSAGE_WAMP;
-    MessageHeader* header = message_header_new(MSG_TYPE_WAMP, bytes.len);
-    if (!header) return false;
+bool SocketTransport::write(::Bytes& bytes) { return write(bytes.data, bytes.len); }
 
-    uint8_t header_bytes[4];
-    send_message_header(header, header_bytes);
-
-    try {
-        transport_->write(header_bytes, 4);
-        transport_->write(bytes.data, bytes.len);
-
-        message_header_free(header);
-        return true;
-    } catch (std::exception& e) {
-        std::cerr << "Write error: " << e.what() << std::endl;
-        message_header_free(header);
-        return false;
+bool SocketTransport::write(const uint8_t* data, size_t size, uint64_t* locked_at) {
+    if (size > max_send_size_) {
+        throw std::length_error("Message of " + std::to_string(size) + " bytes exceeds the router limit of " +
+                                std::to_string(max_send_size_));
     }
+
+    return write_frame(FRAME_TYPE_WAMP, data, size, locked_at);
 }
 
-void SocketTransport::close() { transport_->close(); }
+void SocketTransport::close() {
+    if (transport_->is_connected()) transport_->close();
+}
 
 bool SocketTransport::is_connected() const { return transport_->is_connected(); }
 }  // namespace xconn
@@ -0,0 +1,141 @@
+#include "xconn_cpp/internal/thread_placement.hpp"
+
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <ifaddrs.h>
+#include <net/if.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "xconn_cpp/internal/log.hpp"
+
+namespace xconn {
+
+static bool parse_int(std::string_view text, int& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+std::vector<int> parse_cpu_list(std::string_view list) {
+    std::vector<int> cpus;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        std::string_view entry = list.substr(0, comma);
+        list = comma == std::string_view::npos ? std::string_view() : list.substr(comma + 1);
+
+        while (!entry.empty() && (entry.back() == '\n' || entry.back() == ' ')) entry.remove_suffix(1);
+        size_t dash = entry.find('-');
+        int first = 0;
+        int last = 0;
+        if (!parse_int(entry.substr(0, dash), first)) continue;
+        if (dash == std::string_view::npos) {
+            last = first;
+        } else if (!parse_int(entry.substr(dash + 1), last)) {
+            continue;
+        }
+        if (first < 0 || last < first) continue;
+
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static std::string read_first_line(const std::string& path) {
+    std::ifstream file(path);
+    std::string line;
+    std::getline(file, line);
+    return line;
+}
+
+std::vector<int> numa_node_cpus(int node) {
+    if (node < 0) return {};
+    return parse_cpu_list(read_first_line("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+}
+
+#ifdef __linux__
+
+int socket_numa_node(int fd) {
+    if (fd < 0) return -1;
+
+    sockaddr_storage local{};
+    socklen_t length = sizeof(local);
+    if (getsockname(fd, reinterpret_cast<sockaddr*>(&local), &length) != 0) return -1;
+    if (local.ss_family != AF_INET && local.ss_family != AF_INET6) return -1;
+
+    ifaddrs* interfaces = nullptr;
+    if (getifaddrs(&interfaces) != 0) return -1;
+
+    // The interface owning the socket's local address is the one its traffic uses.
+    std::string name;
+    for (ifaddrs* entry = interfaces; entry && name.empty(); entry = entry->ifa_next) {
+        if (!entry->ifa_addr || entry->ifa_addr->sa_family != local.ss_family) continue;
+        if (local.ss_family == AF_INET) {
+            auto* a = reinterpret_cast<const sockaddr_in*>(entry->ifa_addr);
+            auto* b = reinterpret_cast<const sockaddr_in*>(&local);
+            if (a->sin_addr.s_addr == b->sin_addr.s_addr) name = entry->ifa_name;
+        } else {
+            auto* a = reinterpret_cast<const sockaddr_in6*>(entry->ifa_addr);
+            auto* b = reinterpret_cast<const sockaddr_in6*>(&local);
+            if (std::memcmp(&a->sin6_addr, &b->sin6_addr, sizeof(in6_addr)) == 0) name = entry->ifa_name;
+        }
+    }
+    freeifaddrs(interfaces);
+    if (name.empty()) return -1;
+
+    // Only interfaces backed by a device have a node; the kernel reports -1 when it does not know.
+    std::string text = read_first_line("/sys/class/net/" + name + "/device/numa_node");
+    int node = -1;
+    return parse_int(text, node) ? node : -1;
+}
+
+void place_current_thread(const std::string& name, const std::vector<int>& cpus, int numa_node) {
+    // Linux limits thread names to 15 characters.
+    int error = pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    if (error != 0) XCONN_LOG(LogLevel::Warning, "Could not name thread {}: {}", name, std::strerror(error));
+
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error != 0) XCONN_LOG(LogLevel::Warning, "Could not pin thread {}: {}", name, std::strerror(error));
+    }
+
+    if (numa_node >= 0) {
+        // set_mempolicy(MPOL_PREFERRED) for this thread only, without depending on libnuma.
+        constexpr int MPOL_PREFERRED_MODE = 1;
+        constexpr size_t BITS = 8 * sizeof(unsigned long);
+        std::vector<unsigned long> mask(size_t(numa_node) / BITS + 1);
+        mask[size_t(numa_node) / BITS] = 1UL << (size_t(numa_node) % BITS);
+        if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, mask.data(), mask.size() * BITS + 1) != 0) {
+            XCONN_LOG(LogLevel::Warning, "Could not prefer NUMA node {} for thread {}: {}", numa_node, name,
+                      std::strerror(errno));
+        }
+    }
+}
+
+#else
+
+int socket_numa_node(int) { return -1; }
+
+void place_current_thread(const std::string& name, const std::vector<int>& cpus, int numa_node) {
+    if (!cpus.empty() || numa_node >= 0) {
+        XCONN_LOG(LogLevel::Warning, "Thread placement is not supported on this platform, {} runs unpinned", name);
+    }
+}
+
+#endif
+
+}  // namespace xconn
@@ -0,0 +1,92 @@
+#include "xconn_cpp/tracing.hpp"
+
+#include <bit>
+
+namespace xconn {
+
+const char* trace_stage_name(TraceStage stage) {
+    switch (stage) {
+        case TraceStage::CallStarted:
+            return "call_started";
+        case TraceStage::CallEncoded:
+            return "call_encoded";
+        case TraceStage::CallWriteLocked:
+            return "call_write_locked";
+        case TraceStage::CallWritten:
+            return "call_written";
+        case TraceStage::ResultReceived:
+            return "result_received";
+        case TraceStage::ResultDecoded:
+            return "result_decoded";
+        case TraceStage::CallCompleted:
+            return "call_completed";
+        case TraceStage::InvocationReceived:
+            return "invocation_received";
+        case TraceStage::InvocationQueued:
+            return "invocation_queued";
+        case TraceStage::HandlerStarted:
+            return "handler_started";
+        case TraceStage::HandlerFinished:
+            return "handler_finished";
+        case TraceStage::YieldWriteLocked:
+            return "yield_write_locked";
+        case TraceStage::YieldWritten:
+            return "yield_written";
+    }
+    return "unknown";
+}
+
+RingBufferTraceSink::RingBufferTraceSink(size_t capacity) {
+    size_t size = std::bit_ceil(capacity < 2 ? size_t(2) : capacity);
+    slots_ = std::make_unique<Slot[]>(size);
+    mask_ = size - 1;
+}
+
+void RingBufferTraceSink::record(const TraceEvent& event) {
+    uint64_t position = head_.fetch_add(1, std::memory_order_relaxed);
+    Slot& slot = slots_[position & mask_];
+
+    slot.sequence.store(2 * position + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.request_id.store(event.request_id, std::memory_order_relaxed);
+    slot.timestamp_ns.store(event.timestamp_ns, std::memory_order_relaxed);
+    slot.stage.store(static_cast<uint8_t>(event.stage), std::memory_order_relaxed);
+    slot.sequence.store(2 * position + 2, std::memory_order_release);
+}
+
+std::vector<TraceEvent> RingBufferTraceSink::drain() {
+    std::lock_guard<std::mutex> lock(drain_mutex_);
+
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t capacity = mask_ + 1;
+    if (head - tail_ > capacity) {
+        dropped_.fetch_add(head - tail_ - capacity, std::memory_order_relaxed);
+        tail_ = head - capacity;
+    }
+
+    std::vector<TraceEvent> events;
+    events.reserve(head - tail_);
+    for (uint64_t position = tail_; position < head; ++position) {
+        const Slot& slot = slots_[position & mask_];
+
+        // Seqlock read: the event is only kept if the slot held this position throughout.
+        uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        TraceEvent event;
+        event.request_id = slot.request_id.load(std::memory_order_relaxed);
+        event.timestamp_ns = slot.timestamp_ns.load(std::memory_order_relaxed);
+        event.stage = static_cast<TraceStage>(slot.stage.load(std::memory_order_relaxed));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t after = slot.sequence.load(std::memory_order_relaxed);
+
+        if (before == 2 * position + 2 && after == before) {
+            events.push_back(event);
+        } else {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    tail_ = head;
+    return events;
+}
+
+}  // namespace xconn
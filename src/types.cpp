@@ -189,6 +189,14 @@ Result::Result(List args_, Dict kwargs_, Dict details_)
 Result::Result() : ArgsHelper(List{}), KwargsHelper(Dict{}) {}
 Result::Result(const Invocation& invocation) : Result(invocation.args, invocation.kwargs, invocation.details) {}
 
+Result passthru_result(std::string scheme, Bytes payload, std::string serializer) {
+    Result result;
+    result.details["ppt_scheme"] = std::move(scheme);
+    result.details["ppt_serializer"] = std::move(serializer);
+    result.args.emplace_back(std::move(payload));
+    return result;
+}
+
 Invocation::Invocation(void* c_invocation)
     : Invocation(from_c_list(((::Invocation*)c_invocation)->args), from_c_dict(((::Invocation*)c_invocation)->kwargs),
                  from_c_dict(((::Invocation*)c_invocation)->details)) {}
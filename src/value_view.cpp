@@ -0,0 +1,994 @@
+#include "xconn_cpp/value_view.hpp"
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/internal/json_scan.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+
+namespace xconn {
+
+namespace {
+
+constexpr int MAX_DEPTH = 128;
+
+// A decoded item head. For strings and bytes `data`/`length` describe the payload, for
+// lists and dicts `length` is the element (pair) count and `next` points at the first child.
+struct Item {
+    ValueKind kind = ValueKind::Invalid;
+    int64_t int_value = 0;
+    uint64_t uint_value = 0;
+    double double_value = 0;
+    bool bool_value = false;
+    const uint8_t* data = nullptr;
+    size_t length = 0;
+    bool indefinite = false;  // CBOR indefinite length list or dict, or any JSON container
+    bool escaped = false;     // JSON string containing escape sequences
+    const uint8_t* next = nullptr;
+};
+
+uint64_t read_be(const uint8_t* p, int width) {
+    uint64_t value = 0;
+    for (int i = 0; i < width; ++i) value = (value << 8) | p[i];
+    return value;
+}
+
+double half_to_double(uint16_t half) {
+    int exponent = (half >> 10) & 0x1f;
+    int mantissa = half & 0x3ff;
+
+    double value;
+    if (exponent == 0) {
+        value = std::ldexp(mantissa, -24);
+    } else if (exponent != 31) {
+        value = std::ldexp(mantissa + 1024, exponent - 25);
+    } else {
+        value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+    }
+    return (half & 0x8000) ? -value : value;
+}
+
+double bits_to_double(uint64_t bits, int width) {
+    if (width == 4) {
+        float value;
+        auto narrow = static_cast<uint32_t>(bits);
+        std::memcpy(&value, &narrow, sizeof(value));
+        return value;
+    }
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void set_integer(Item& item, uint64_t magnitude, bool negative) {
+    if (negative) {
+        // CBOR stores -1 - n.
+        if (magnitude > uint64_t(std::numeric_limits<int64_t>::max())) return;
+        item.kind = ValueKind::Int;
+        item.int_value = -1 - int64_t(magnitude);
+    } else if (magnitude > uint64_t(std::numeric_limits<int64_t>::max())) {
+        item.kind = ValueKind::UInt;
+        item.uint_value = magnitude;
+    } else {
+        item.kind = ValueKind::Int;
+        item.int_value = int64_t(magnitude);
+    }
+}
+
+// ---- CBOR ----
+
+bool read_cbor(const uint8_t* p, const uint8_t* end, Item& item) {
+    // Tags carry no meaning for WAMP, look through them.
+    while (p < end && (*p >> 5) == 6) {
+        uint8_t info = *p & 0x1f;
+        if (info > 27) return false;
+        int width = info < 24 ? 0 : 1 << (info - 24);
+        if (end - p < 1 + width) return false;
+        p += 1 + width;
+    }
+    if (p >= end) return false;
+
+    uint8_t major = *p >> 5;
+    uint8_t info = *p & 0x1f;
+    ++p;
+
+    uint64_t argument = info;
+    int width = 0;
+    if (info == 31) {
+        if (major != 4 && major != 5) return false;
+        item.indefinite = true;
+    } else if (info >= 24) {
+        if (info > 27) return false;
+        width = 1 << (info - 24);
+        if (end - p < width) return false;
+        argument = read_be(p, width);
+        p += width;
+    }
+
+    item.next = p;
+    switch (major) {
+        case 0:
+        case 1:
+            set_integer(item, argument, major == 1);
+            return item.kind != ValueKind::Invalid;
+        case 2:
+        case 3:
+            if (argument > uint64_t(end - p)) return false;
+            item.kind = major == 2 ? ValueKind::Bytes : ValueKind::String;
+            item.data = p;
+            item.length = argument;
+            item.next = p + argument;
+            return true;
+        case 4:
+            item.kind = ValueKind::List;
+            item.length = argument;
+            return true;
+        case 5:
+            item.kind = ValueKind::Dict;
+            item.length = argument;
+            return true;
+        case 7:
+            if (info == 20 || info == 21) {
+                item.kind = ValueKind::Bool;
+                item.bool_value = info == 21;
+            } else if (info == 22 || info == 23) {
+                item.kind = ValueKind::Null;
+            } else if (info == 25) {
+                item.kind = ValueKind::Double;
+                item.double_value = half_to_double(uint16_t(argument));
+            } else if (info == 26 || info == 27) {
+                item.kind = ValueKind::Double;
+                item.double_value = bits_to_double(argument, width);
+            } else {
+                return false;
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+// ---- MessagePack ----
+
+bool msgpack_payload(Item& item, ValueKind kind, const uint8_t* p, const uint8_t* end, int width) {
+    if (end - p < width) return false;
+    uint64_t length = read_be(p, width);
+    p += width;
+    if (length > uint64_t(end - p)) return false;
+
+    item.kind = kind;
+    item.data = p;
+    item.length = length;
+    item.next = p + length;
+    return true;
+}
+
+bool msgpack_container(Item& item, ValueKind kind, const uint8_t* p, const uint8_t* end, int width) {
+    if (end - p < width) return false;
+    item.kind = kind;
+    item.length = read_be(p, width);
+    item.next = p + width;
+    return true;
+}
+
+bool read_msgpack(const uint8_t* p, const uint8_t* end, Item& item) {
+    if (p >= end) return false;
+    uint8_t type = *p++;
+
+    if (type <= 0x7f || type >= 0xe0) {
+        item.kind = ValueKind::Int;
+        item.int_value = int8_t(type);
+        item.next = p;
+        return true;
+    }
+    if (type >= 0xa0 && type <= 0xbf) {
+        size_t length = type & 0x1f;
+        if (length > size_t(end - p)) return false;
+        item.kind = ValueKind::String;
+        item.data = p;
+        item.length = length;
+        item.next = p + length;
+        return true;
+    }
+    if (type >= 0x90 && type <= 0x9f) {
+        item.kind = ValueKind::List;
+        item.length = type & 0x0f;
+        item.next = p;
+        return true;
+    }
+    if (type >= 0x80 && type <= 0x8f) {
+        item.kind = ValueKind::Dict;
+        item.length = type & 0x0f;
+        item.next = p;
+        return true;
+    }
+
+    auto scalar = [&](int width) -> const uint8_t* {
+        if (end - p < width) return nullptr;
+        item.next = p + width;
+        return p;
+    };
+
+    switch (type) {
+        case 0xc0:
+            item.kind = ValueKind::Null;
+            item.next = p;
+            return true;
+        case 0xc2:
+        case 0xc3:
+            item.kind = ValueKind::Bool;
+            item.bool_value = type == 0xc3;
+            item.next = p;
+            return true;
+        case 0xc4:
+            return msgpack_payload(item, ValueKind::Bytes, p, end, 1);
+        case 0xc5:
+            return msgpack_payload(item, ValueKind::Bytes, p, end, 2);
+        case 0xc6:
+            return msgpack_payload(item, ValueKind::Bytes, p, end, 4);
+        case 0xca:
+        case 0xcb: {
+            int width = type == 0xca ? 4 : 8;
+            const uint8_t* data = scalar(width);
+            if (!data) return false;
+            item.kind = ValueKind::Double;
+            item.double_value = bits_to_double(read_be(data, width), width);
+            return true;
+        }
+        case 0xcc:
+        case 0xcd:
+        case 0xce:
+        case 0xcf: {
+            int width = 1 << (type - 0xcc);
+            const uint8_t* data = scalar(width);
+            if (!data) return false;
+            set_integer(item, read_be(data, width), false);
+            return true;
+        }
+        case 0xd0:
+        case 0xd1:
+        case 0xd2:
+        case 0xd3: {
+            int width = 1 << (type - 0xd0);
+            const uint8_t* data = scalar(width);
+            if (!data) return false;
+            // Sign-extend the big-endian two's complement value.
+            uint64_t bits = read_be(data, width);
+            int shift = 64 - width * 8;
+            item.kind = ValueKind::Int;
+            item.int_value = shift ? int64_t(bits << shift) >> shift : int64_t(bits);
+            return true;
+        }
+        case 0xd9:
+            return msgpack_payload(item, ValueKind::String, p, end, 1);
+        case 0xda:
+            return msgpack_payload(item, ValueKind::String, p, end, 2);
+        case 0xdb:
+            return msgpack_payload(item, ValueKind::String, p, end, 4);
+        case 0xdc:
+            return msgpack_container(item, ValueKind::List, p, end, 2);
+        case 0xdd:
+            return msgpack_container(item, ValueKind::List, p, end, 4);
+        case 0xde:
+            return msgpack_container(item, ValueKind::Dict, p, end, 2);
+        case 0xdf:
+            return msgpack_container(item, ValueKind::Dict, p, end, 4);
+        default:
+            // Extension types have no WAMP meaning.
+            return false;
+    }
+}
+
+// ---- JSON ----
+
+const uint8_t* json_skip_ws(const uint8_t* p, const uint8_t* end) {
+    while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) ++p;
+    return p;
+}
+
+// p points at the opening quote. Returns the position after the closing quote.
+const uint8_t* json_string_end(const uint8_t* p, const uint8_t* end, bool& escaped) {
+    for (++p; (p = json_find_quote_or_backslash(p, end)) < end; p += 2) {
+        if (*p == '"') return p + 1;
+        escaped = true;
+    }
+    return nullptr;
+}
+
+bool is_json_delimiter(uint8_t c) {
+    return c == ',' || c == ']' || c == '}' || c == ':' || c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool read_json(const uint8_t* p, const uint8_t* end, Item& item) {
+    p = json_skip_ws(p, end);
+    if (p >= end) return false;
+
+    switch (*p) {
+        case '"': {
+            const uint8_t* close = json_string_end(p, end, item.escaped);
+            if (!close) return false;
+            item.data = p + 1;
+            item.length = size_t(close - p - 2);
+            item.next = close;
+            // WAMP carries binary in JSON as a string of a NUL character followed by base64.
+            static constexpr char BINARY_PREFIX[] = "\\u0000";
+            bool binary = item.length >= 6 && std::memcmp(item.data, BINARY_PREFIX, 6) == 0;
+            item.kind = binary ? ValueKind::Bytes : ValueKind::String;
+            return true;
+        }
+        case '[':
+        case '{':
+            item.kind = *p == '[' ? ValueKind::List : ValueKind::Dict;
+            item.indefinite = true;
+            item.next = p + 1;
+            return true;
+        default:
+            break;
+    }
+
+    const uint8_t* token_end = p;
+    while (token_end < end && !is_json_delimiter(*token_end)) ++token_end;
+    std::string_view token(reinterpret_cast<const char*>(p), size_t(token_end - p));
+    item.next = token_end;
+
+    if (token == "null") {
+        item.kind = ValueKind::Null;
+        return true;
+    }
+    if (token == "true" || token == "false") {
+        item.kind = ValueKind::Bool;
+        item.bool_value = token == "true";
+        return true;
+    }
+
+    const char* first = token.data();
+    const char* last = token.data() + token.size();
+    if (token.find_first_of(".eE") == std::string_view::npos) {
+        int64_t value;
+        auto result = std::from_chars(first, last, value);
+        if (result.ec == std::errc() && result.ptr == last) {
+            item.kind = ValueKind::Int;
+            item.int_value = value;
+            return true;
+        }
+
+        uint64_t unsigned_value;
+        result = std::from_chars(first, last, unsigned_value);
+        if (result.ec == std::errc() && result.ptr == last) {
+            item.kind = ValueKind::UInt;
+            item.uint_value = unsigned_value;
+            return true;
+        }
+    }
+
+    double value;
+    auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last) return false;
+    item.kind = ValueKind::Double;
+    item.double_value = value;
+    return true;
+}
+
+// Skips a JSON container by bracket depth, stepping over strings. p is past the opening bracket.
+const uint8_t* json_skip_container(const uint8_t* p, const uint8_t* end) {
+    int depth = 1;
+    bool escaped = false;
+    while ((p = json_find_structural(p, end)) < end) {
+        switch (*p) {
+            case '"':
+                p = json_string_end(p, end, escaped);
+                if (!p) return nullptr;
+                continue;
+            case '[':
+            case '{':
+                ++depth;
+                break;
+            case ']':
+            case '}':
+                if (--depth == 0) return p + 1;
+                break;
+            default:
+                break;
+        }
+        ++p;
+    }
+    return nullptr;
+}
+
+void append_utf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += char(code);
+    } else if (code < 0x800) {
+        out += char(0xc0 | (code >> 6));
+        out += char(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+        out += char(0xe0 | (code >> 12));
+        out += char(0x80 | ((code >> 6) & 0x3f));
+        out += char(0x80 | (code & 0x3f));
+    } else {
+        out += char(0xf0 | (code >> 18));
+        out += char(0x80 | ((code >> 12) & 0x3f));
+        out += char(0x80 | ((code >> 6) & 0x3f));
+        out += char(0x80 | (code & 0x3f));
+    }
+}
+
+bool parse_hex4(const char* p, const char* end, uint32_t& code) {
+    if (end - p < 4) return false;
+    auto result = std::from_chars(p, p + 4, code, 16);
+    return result.ec == std::errc() && result.ptr == p + 4;
+}
+
+// Decodes the escape sequences of a JSON string body.
+bool json_unescape(std::string_view raw, std::string& out) {
+    out.reserve(raw.size());
+    const char* p = raw.data();
+    const char* end = raw.data() + raw.size();
+    while (p < end) {
+        // Copy the run up to the next escape in one go. A body only holds escaped quotes,
+        // so the scan stops at backslashes.
+        auto run_end = reinterpret_cast<const char*>(
+            json_find_quote_or_backslash(reinterpret_cast<const uint8_t*>(p), reinterpret_cast<const uint8_t*>(end)));
+        out.append(p, run_end);
+        p = run_end;
+        if (p >= end) break;
+
+        if (++p >= end) return false;
+        switch (*p++) {
+            case '"':
+                out += '"';
+                break;
+            case '\\':
+                out += '\\';
+                break;
+            case '/':
+                out += '/';
+                break;
+            case 'b':
+                out += '\b';
+                break;
+            case 'f':
+                out += '\f';
+                break;
+            case 'n':
+                out += '\n';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'u': {
+                uint32_t code;
+                if (!parse_hex4(p, end, code)) return false;
+                p += 4;
+                if (code >= 0xd800 && code < 0xdc00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                    uint32_t low;
+                    if (parse_hex4(p + 2, end, low) && low >= 0xdc00 && low < 0xe000) {
+                        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+                        p += 6;
+                    }
+                }
+                append_utf8(out, code);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool base64_decode(std::string_view text, std::string& out) {
+    auto sextet = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+' || c == '-') return 62;
+        if (c == '/' || c == '_') return 63;
+        return -1;
+    };
+
+    out.reserve(text.size() / 4 * 3);
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : text) {
+        if (c == '=') break;
+        int value = sextet(c);
+        if (value < 0) return false;
+        buffer = (buffer << 6) | uint32_t(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += char((buffer >> bits) & 0xff);
+        }
+    }
+    return true;
+}
+
+// ---- format dispatch ----
+
+bool read_item(const WireFrame& frame, const uint8_t* p, Item& item) {
+    switch (frame.format) {
+        case SerializerType::CBOR:
+            return read_cbor(p, frame.end(), item);
+        case SerializerType::MSGPACK:
+            return read_msgpack(p, frame.end(), item);
+        case SerializerType::JSON:
+            return read_json(p, frame.end(), item);
+    }
+    return false;
+}
+
+const uint8_t* skip_item(const WireFrame& frame, const uint8_t* p, int depth = 0);
+
+// Walks the children of a list or dict. Dict children alternate between key and value.
+class Children {
+   public:
+    Children(const WireFrame& frame, const Item& container)
+        : frame_(frame),
+          pos_(container.next),
+          after_(container.next),
+          remaining_(container.kind == ValueKind::Dict ? container.length * 2 : container.length),
+          indefinite_(container.indefinite),
+          object_(container.kind == ValueKind::Dict) {}
+
+    // Returns the next child, or nullptr once the container is exhausted or malformed.
+    const uint8_t* next(int depth = 0) {
+        const uint8_t* end = frame_.end();
+        const uint8_t* p = pos_;
+        if (current_) {
+            p = skip_item(frame_, current_, depth + 1);
+            after_ = p;
+            if (!p) return nullptr;
+        }
+
+        if (frame_.format != SerializerType::JSON) {
+            if (indefinite_) {
+                if (p >= end || *p == 0xff) return nullptr;
+            } else {
+                if (remaining_ == 0) return nullptr;
+                --remaining_;
+            }
+            current_ = p;
+            return p;
+        }
+
+        p = json_skip_ws(p, end);
+        if (p >= end) return nullptr;
+        if (!current_) {
+            if (*p == ']' || *p == '}') return nullptr;
+        } else if (object_ && !expect_key_) {
+            if (*p != ':') return nullptr;
+            p = json_skip_ws(p + 1, end);
+        } else {
+            if (*p != ',') return nullptr;
+            p = json_skip_ws(p + 1, end);
+        }
+        if (object_) expect_key_ = !expect_key_;
+
+        current_ = p;
+        return p;
+    }
+
+    // Where the children returned so far end; nullptr if one of them was malformed. Once
+    // next() has returned nullptr for a binary container, that is past the last child.
+    const uint8_t* after() const { return after_; }
+
+   private:
+    const WireFrame& frame_;
+    const uint8_t* pos_;
+    const uint8_t* after_;
+    const uint8_t* current_ = nullptr;
+    uint64_t remaining_;
+    bool indefinite_;
+    bool object_;
+    bool expect_key_ = true;
+};
+
+const uint8_t* skip_item(const WireFrame& frame, const uint8_t* p, int depth) {
+    if (depth > MAX_DEPTH) return nullptr;
+
+    Item item;
+    if (!read_item(frame, p, item)) return nullptr;
+    if (item.kind != ValueKind::List && item.kind != ValueKind::Dict) return item.next;
+
+    if (frame.format == SerializerType::JSON) return json_skip_container(item.next, frame.end());
+
+    // Every child is at least one byte, so a count beyond the remaining input is malformed.
+    if (!item.indefinite && item.length > uint64_t(frame.end() - item.next)) return nullptr;
+
+    // Each child is skipped once, by next(); skipping the last one again would double the
+    // work at every level of nesting.
+    Children children(frame, item);
+    while (children.next(depth)) {
+    }
+
+    const uint8_t* after = children.after();
+    if (!after) return nullptr;
+    if (item.indefinite) {
+        if (after >= frame.end() || *after != 0xff) return nullptr;
+        ++after;
+    }
+    return after;
+}
+
+}  // namespace
+
+ValueView WireFrame::root() const {
+    const uint8_t* p = begin();
+    if (format == SerializerType::JSON) p = json_skip_ws(p, end());
+    return ValueView(this, p < end() ? p : nullptr);
+}
+
+uint64_t wire_message_type(const WireFrame& frame) {
+    ValueView type = frame.root().at(0);
+    return type.getUInt64().value_or(0);
+}
+
+ValueKind ValueView::kind() const {
+    if (!pos_) return ValueKind::Invalid;
+
+    Item item;
+    if (!read_item(*frame_, pos_, item)) return ValueKind::Invalid;
+    return item.kind;
+}
+
+std::optional<int64_t> ValueView::getInt64() const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item) || item.kind != ValueKind::Int) return std::nullopt;
+    return item.int_value;
+}
+
+std::optional<uint64_t> ValueView::getUInt64() const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item)) return std::nullopt;
+    if (item.kind == ValueKind::UInt) return item.uint_value;
+    if (item.kind == ValueKind::Int && item.int_value >= 0) return uint64_t(item.int_value);
+    return std::nullopt;
+}
+
+std::optional<double> ValueView::getDouble() const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item) || item.kind != ValueKind::Double) return std::nullopt;
+    return item.double_value;
+}
+
+std::optional<bool> ValueView::getBool() const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item) || item.kind != ValueKind::Bool) return std::nullopt;
+    return item.bool_value;
+}
+
+std::optional<std::string_view> ValueView::getString() const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item) || item.kind != ValueKind::String) return std::nullopt;
+
+    std::string_view raw(reinterpret_cast<const char*>(item.data), item.length);
+    if (!item.escaped) return raw;
+
+    // Decoded in a reused buffer, then copied once into the frame's arena.
+    thread_local std::string decoded;
+    decoded.clear();
+    if (!json_unescape(raw, decoded)) return std::nullopt;
+    return frame_->keep(decoded);
+}
+
+std::optional<std::span<const uint8_t>> ValueView::getBytes() const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item) || item.kind != ValueKind::Bytes) return std::nullopt;
+
+    if (frame_->format != SerializerType::JSON) return std::span<const uint8_t>(item.data, item.length);
+
+    thread_local std::string text;
+    thread_local std::string decoded;
+    text.clear();
+    decoded.clear();
+    std::string_view raw(reinterpret_cast<const char*>(item.data), item.length);
+    if (!json_unescape(raw, text) || !base64_decode(std::string_view(text).substr(1), decoded)) return std::nullopt;
+
+    std::string_view kept = frame_->keep(decoded);
+    return std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(kept.data()), kept.size());
+}
+
+size_t ValueView::size() const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item)) return 0;
+    if (item.kind != ValueKind::List && item.kind != ValueKind::Dict) return 0;
+    if (!item.indefinite) return item.length;
+
+    size_t count = 0;
+    Children children(*frame_, item);
+    while (children.next()) ++count;
+    return item.kind == ValueKind::Dict ? count / 2 : count;
+}
+
+ValueView ValueView::at(size_t index) const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item) || item.kind != ValueKind::List) return ValueView();
+
+    Children children(*frame_, item);
+    for (size_t i = 0;; ++i) {
+        const uint8_t* child = children.next();
+        if (!child) return ValueView();
+        if (i == index) return ValueView(frame_, child);
+    }
+}
+
+ValueView ValueView::get(std::string_view key) const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item) || item.kind != ValueKind::Dict) return ValueView();
+
+    Children children(*frame_, item);
+    while (const uint8_t* child_key = children.next()) {
+        const uint8_t* child_value = children.next();
+        if (!child_value) break;
+        if (ValueView(frame_, child_key).getString() == key) return ValueView(frame_, child_value);
+    }
+    return ValueView();
+}
+
+void ValueView::iterate(IterateCallback callback, void* context) const {
+    Item item;
+    if (!pos_ || !read_item(*frame_, pos_, item)) return;
+
+    Children children(*frame_, item);
+    if (item.kind == ValueKind::List) {
+        while (const uint8_t* child = children.next()) callback(context, std::string_view(), ValueView(frame_, child));
+    } else if (item.kind == ValueKind::Dict) {
+        while (const uint8_t* child_key = children.next()) {
+            const uint8_t* child_value = children.next();
+            if (!child_value) break;
+            auto key = ValueView(frame_, child_key).getString();
+            if (key) callback(context, *key, ValueView(frame_, child_value));
+        }
+    }
+}
+
+Value ValueView::toValue() const { return toValue(0); }
+
+List ValueView::toList() const { return toList(0); }
+
+Dict ValueView::toDict() const { return toDict(0); }
+
+CompactValue ValueView::toCompact(Arena& arena) const { return toCompact(arena, 0); }
+
+Value ValueView::toValue(int depth) const {
+    Item item;
+    if (depth > MAX_DEPTH || !pos_ || !read_item(*frame_, pos_, item)) return std::monostate{};
+
+    switch (item.kind) {
+        case ValueKind::Int:
+            return item.int_value;
+        case ValueKind::UInt:
+            return item.uint_value;
+        case ValueKind::Double:
+            return item.double_value;
+        case ValueKind::Bool:
+            return item.bool_value;
+        case ValueKind::String: {
+            std::string text;
+            std::string_view raw(reinterpret_cast<const char*>(item.data), item.length);
+            if (!item.escaped) {
+                text.assign(raw);
+            } else if (!json_unescape(raw, text)) {
+                text.clear();
+            }
+            return text;
+        }
+        case ValueKind::Bytes: {
+            auto bytes = getBytes();
+            return bytes ? Bytes(bytes->begin(), bytes->end()) : Bytes();
+        }
+        case ValueKind::List:
+            return std::make_shared<List>(toList(depth));
+        case ValueKind::Dict:
+            return std::make_shared<Dict>(toDict(depth));
+        default:
+            return std::monostate{};
+    }
+}
+
+List ValueView::toList(int depth) const {
+    List list;
+    forEach([&list, depth](const ValueView& item) { list.push_back(item.toValue(depth + 1)); });
+    return list;
+}
+
+Dict ValueView::toDict(int depth) const {
+    Dict dict;
+    if (kind() != ValueKind::Dict) return dict;
+    forEach([&dict, depth](std::string_view key, const ValueView& item) {
+        dict.emplace(std::string(key), item.toValue(depth + 1));
+    });
+    return dict;
+}
+
+CompactValue ValueView::toCompact(Arena& arena, int depth) const {
+    Item item;
+    if (depth > MAX_DEPTH || !pos_ || !read_item(*frame_, pos_, item)) return CompactValue();
+
+    switch (item.kind) {
+        case ValueKind::Int:
+            return item.int_value;
+        case ValueKind::UInt:
+            return item.uint_value;
+        case ValueKind::Double:
+            return item.double_value;
+        case ValueKind::Bool:
+            return item.bool_value;
+        case ValueKind::String: {
+            std::string_view raw(reinterpret_cast<const char*>(item.data), item.length);
+            if (!item.escaped) return CompactValue(arena, raw);
+
+            std::string decoded;
+            return json_unescape(raw, decoded) ? CompactValue(arena, decoded) : CompactValue();
+        }
+        case ValueKind::Bytes: {
+            auto bytes = frame_->format == SerializerType::JSON ? getBytes()
+                                                                 : std::span<const uint8_t>(item.data, item.length);
+            return bytes ? CompactValue::bytes(arena, *bytes) : CompactValue();
+        }
+        case ValueKind::List:
+        case ValueKind::Dict:
+            break;
+        default:
+            return CompactValue();
+    }
+
+    bool is_dict = item.kind == ValueKind::Dict;
+    Children children(*frame_, item);
+
+    if (!item.indefinite) {
+        // The element count is known up front, decode straight into the arena. It comes from
+        // the wire, so one beyond the remaining input is malformed rather than allocated.
+        if (item.length > uint64_t(frame_->end() - item.next)) return CompactValue();
+        if (!is_dict) {
+            CompactValue list = CompactValue::list(arena, item.length);
+            for (CompactValue& element : list.items()) {
+                const uint8_t* child = children.next();
+                if (!child) break;
+                element = ValueView(frame_, child).toCompact(arena, depth + 1);
+            }
+            return list;
+        }
+
+        CompactValue dict = CompactValue::dict(arena, item.length);
+        for (CompactEntry& entry : dict.entries()) {
+            const uint8_t* key = children.next();
+            const uint8_t* value = key ? children.next() : nullptr;
+            if (!value) break;
+            entry = {ValueView(frame_, key).toCompact(arena, depth + 1),
+                     ValueView(frame_, value).toCompact(arena, depth + 1)};
+        }
+        dict.sort_entries();
+        return dict;
+    }
+
+    // JSON and indefinite CBOR containers are collected on a per-thread stack first, so
+    // they are walked only once. Nested containers push and pop above this one's mark.
+    thread_local std::vector<CompactValue> stack;
+    size_t mark = stack.size();
+    while (const uint8_t* child = children.next()) {
+        stack.push_back(ValueView(frame_, child).toCompact(arena, depth + 1));
+    }
+
+    size_t count = stack.size() - mark;
+    CompactValue container;
+    if (!is_dict) {
+        container = CompactValue::list(arena, count);
+        std::copy(stack.begin() + mark, stack.end(), container.items().begin());
+    } else {
+        container = CompactValue::dict(arena, count / 2);
+        auto entries = container.entries();
+        for (size_t i = 0; i < entries.size(); ++i) entries[i] = {stack[mark + 2 * i], stack[mark + 2 * i + 1]};
+        container.sort_entries();
+    }
+    stack.resize(mark);
+    return container;
+}
+
+// Splits a message array into its fields in a single pass.
+template <size_t N>
+static size_t split_fields(const ValueView& message, std::array<ValueView, N>& fields) {
+    size_t count = 0;
+    message.forEach([&](const ValueView& field) {
+        if (count < N) fields[count] = field;
+        ++count;
+    });
+    return count;
+}
+
+static uint64_t required_id(const ValueView& field, const char* message) {
+    auto id = field.getUInt64();
+    if (!id) throw std::runtime_error(std::string("Malformed ") + message + " message");
+    return *id;
+}
+
+Arena& PayloadView::arena() const { return frame_->arena(); }
+
+std::optional<PassThruView> PayloadView::passThru() const {
+    auto scheme = details_.get("ppt_scheme").getString();
+    if (!scheme) return std::nullopt;
+
+    auto payload = args_.at(0).getBytes();
+    if (!payload) return std::nullopt;
+
+    return PassThruView{*scheme, details_.get("ppt_serializer").getString().value_or(PPT_SERIALIZER_NATIVE), *payload};
+}
+
+InvocationView::InvocationView(std::shared_ptr<const WireFrame> frame) {
+    frame_ = std::move(frame);
+
+    std::array<ValueView, 6> fields;
+    if (split_fields(frame_->root(), fields) < 4) throw std::runtime_error("Malformed INVOCATION message");
+
+    request_id = required_id(fields[1], "INVOCATION");
+    registration_id = required_id(fields[2], "INVOCATION");
+    details_ = fields[3];
+    args_ = fields[4];
+    kwargs_ = fields[5];
+}
+
+Invocation InvocationView::toInvocation() const {
+    return Invocation(args_.toList(), kwargs_.toDict(), details_.toDict());
+}
+
+EventView::EventView(std::shared_ptr<const WireFrame> frame) {
+    frame_ = std::move(frame);
+
+    std::array<ValueView, 6> fields;
+    if (split_fields(frame_->root(), fields) < 4) throw std::runtime_error("Malformed EVENT message");
+
+    subscription_id = required_id(fields[1], "EVENT");
+    publication_id = required_id(fields[2], "EVENT");
+    details_ = fields[3];
+    args_ = fields[4];
+    kwargs_ = fields[5];
+}
+
+Event EventView::toEvent() const { return Event(args_.toList(), kwargs_.toDict(), details_.toDict()); }
+
+ResultView::ResultView(std::shared_ptr<const WireFrame> frame) {
+    frame_ = std::move(frame);
+
+    std::array<ValueView, 5> fields;
+    if (split_fields(frame_->root(), fields) < 3) throw std::runtime_error("Malformed RESULT message");
+
+    request_id = required_id(fields[1], "RESULT");
+    details_ = fields[2];
+    args_ = fields[3];
+    kwargs_ = fields[4];
+}
+
+Result ResultView::toResult() const { return Result(args_.toList(), kwargs_.toDict(), details_.toDict()); }
+
+ErrorView::ErrorView(std::shared_ptr<const WireFrame> frame) {
+    frame_ = std::move(frame);
+
+    std::array<ValueView, 7> fields;
+    if (split_fields(frame_->root(), fields) < 5) throw std::runtime_error("Malformed ERROR message");
+
+    request_type = required_id(fields[1], "ERROR");
+    request_id = required_id(fields[2], "ERROR");
+    details_ = fields[3];
+    auto error_uri = fields[4].getString();
+    if (!error_uri) throw std::runtime_error("Malformed ERROR message");
+    uri = *error_uri;
+    args_ = fields[5];
+    kwargs_ = fields[6];
+}
+
+ApplicationError ErrorView::toError() const {
+    return ApplicationError(std::string(uri), args_.toList(), kwargs_.toDict());
+}
+
+}  // namespace xconn
@@ -0,0 +1,583 @@
+#include "xconn_cpp/internal/wire_encoder.hpp"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "xconn_cpp/internal/json_scan.hpp"
+
+namespace xconn {
+
+void WireWriter::put_be(uint64_t value, int width) {
+    for (int shift = (width - 1) * 8; shift >= 0; shift -= 8) put(uint8_t(value >> shift));
+}
+
+void WireWriter::cbor_head(uint8_t major, uint64_t value) {
+    major = uint8_t(major << 5);
+    if (value < 24) {
+        put(major | uint8_t(value));
+    } else if (value <= 0xff) {
+        put(major | 24);
+        put_be(value, 1);
+    } else if (value <= 0xffff) {
+        put(major | 25);
+        put_be(value, 2);
+    } else if (value <= 0xffffffff) {
+        put(major | 26);
+        put_be(value, 4);
+    } else {
+        put(major | 27);
+        put_be(value, 8);
+    }
+}
+
+void WireWriter::begin_array(size_t size) {
+    switch (type_) {
+        case SerializerType::CBOR:
+            cbor_head(4, size);
+            break;
+        case SerializerType::MSGPACK:
+            if (size < 16) {
+                put(0x90 | uint8_t(size));
+            } else if (size <= 0xffff) {
+                put(0xdc);
+                put_be(size, 2);
+            } else {
+                put(0xdd);
+                put_be(size, 4);
+            }
+            break;
+        case SerializerType::JSON:
+            put('[');
+            break;
+    }
+}
+
+void WireWriter::end_array() {
+    if (type_ == SerializerType::JSON) put(']');
+}
+
+void WireWriter::begin_map(size_t size) {
+    switch (type_) {
+        case SerializerType::CBOR:
+            cbor_head(5, size);
+            break;
+        case SerializerType::MSGPACK:
+            if (size < 16) {
+                put(0x80 | uint8_t(size));
+            } else if (size <= 0xffff) {
+                put(0xde);
+                put_be(size, 2);
+            } else {
+                put(0xdf);
+                put_be(size, 4);
+            }
+            break;
+        case SerializerType::JSON:
+            put('{');
+            break;
+    }
+}
+
+void WireWriter::end_map() {
+    if (type_ == SerializerType::JSON) put('}');
+}
+
+void WireWriter::separator() {
+    if (type_ == SerializerType::JSON) put(',');
+}
+
+void WireWriter::write_key(std::string_view key) {
+    write_string(key);
+    if (type_ == SerializerType::JSON) put(':');
+}
+
+void WireWriter::write_null() {
+    switch (type_) {
+        case SerializerType::CBOR:
+            put(0xf6);
+            break;
+        case SerializerType::MSGPACK:
+            put(0xc0);
+            break;
+        case SerializerType::JSON:
+            put_text("null");
+            break;
+    }
+}
+
+void WireWriter::write_bool(bool value) {
+    switch (type_) {
+        case SerializerType::CBOR:
+            put(value ? 0xf5 : 0xf4);
+            break;
+        case SerializerType::MSGPACK:
+            put(value ? 0xc3 : 0xc2);
+            break;
+        case SerializerType::JSON:
+            put_text(value ? "true" : "false");
+            break;
+    }
+}
+
+void WireWriter::write_uint(uint64_t value) {
+    switch (type_) {
+        case SerializerType::CBOR:
+            cbor_head(0, value);
+            break;
+        case SerializerType::MSGPACK:
+            if (value < 0x80) {
+                put(uint8_t(value));
+            } else if (value <= 0xff) {
+                put(0xcc);
+                put_be(value, 1);
+            } else if (value <= 0xffff) {
+                put(0xcd);
+                put_be(value, 2);
+            } else if (value <= 0xffffffff) {
+                put(0xce);
+                put_be(value, 4);
+            } else {
+                put(0xcf);
+                put_be(value, 8);
+            }
+            break;
+        case SerializerType::JSON: {
+            char text[24];
+            auto result = std::to_chars(text, text + sizeof(text), value);
+            put_text(std::string_view(text, result.ptr - text));
+            break;
+        }
+    }
+}
+
+void WireWriter::write_int(int64_t value) {
+    if (value >= 0) return write_uint(uint64_t(value));
+
+    switch (type_) {
+        case SerializerType::CBOR:
+            cbor_head(1, ~uint64_t(value));
+            break;
+        case SerializerType::MSGPACK:
+            if (value >= -32) {
+                put(uint8_t(value));
+            } else if (value >= INT8_MIN) {
+                put(0xd0);
+                put_be(uint64_t(value), 1);
+            } else if (value >= INT16_MIN) {
+                put(0xd1);
+                put_be(uint64_t(value), 2);
+            } else if (value >= INT32_MIN) {
+                put(0xd2);
+                put_be(uint64_t(value), 4);
+            } else {
+                put(0xd3);
+                put_be(uint64_t(value), 8);
+            }
+            break;
+        case SerializerType::JSON: {
+            char text[24];
+            auto result = std::to_chars(text, text + sizeof(text), value);
+            put_text(std::string_view(text, result.ptr - text));
+            break;
+        }
+    }
+}
+
+void WireWriter::write_double(double value) {
+    switch (type_) {
+        case SerializerType::CBOR:
+        case SerializerType::MSGPACK: {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            put(type_ == SerializerType::CBOR ? 0xfb : 0xcb);
+            put_be(bits, 8);
+            break;
+        }
+        case SerializerType::JSON: {
+            // JSON has no representation for infinities and NaN.
+            if (!std::isfinite(value)) return write_null();
+
+            char text[32];
+            auto result = std::to_chars(text, text + sizeof(text), value);
+            std::string_view number(text, result.ptr - text);
+            put_text(number);
+            // Keep integral doubles recognisable as floating point.
+            if (number.find_first_of(".eE") == std::string_view::npos) put_text(".0");
+            break;
+        }
+    }
+}
+
+void WireWriter::json_string(std::string_view value) {
+    static constexpr char HEX[] = "0123456789abcdef";
+
+    put('"');
+    auto begin = reinterpret_cast<const uint8_t*>(value.data());
+    auto end = begin + value.size();
+    size_t start = 0;
+    for (const uint8_t* p = begin; (p = json_find_unsafe(p, end)) < end; ++p) {
+        size_t i = static_cast<size_t>(p - begin);
+        auto c = static_cast<unsigned char>(*p);
+
+        put_text(value.substr(start, i - start));
+        switch (c) {
+            case '"':
+                put_text("\\\"");
+                break;
+            case '\\':
+                put_text("\\\\");
+                break;
+            case '\n':
+                put_text("\\n");
+                break;
+            case '\r':
+                put_text("\\r");
+                break;
+            case '\t':
+                put_text("\\t");
+                break;
+            case '\b':
+                put_text("\\b");
+                break;
+            case '\f':
+                put_text("\\f");
+                break;
+            default:
+                put_text("\\u00");
+                put(HEX[c >> 4]);
+                put(HEX[c & 0xf]);
+        }
+        start = i + 1;
+    }
+    put_text(value.substr(start));
+    put('"');
+}
+
+void WireWriter::write_string(std::string_view value) {
+    switch (type_) {
+        case SerializerType::CBOR:
+            cbor_head(3, value.size());
+            break;
+        case SerializerType::MSGPACK:
+            if (value.size() < 32) {
+                put(0xa0 | uint8_t(value.size()));
+            } else if (value.size() <= 0xff) {
+                put(0xd9);
+                put_be(value.size(), 1);
+            } else if (value.size() <= 0xffff) {
+                put(0xda);
+                put_be(value.size(), 2);
+            } else {
+                put(0xdb);
+                put_be(value.size(), 4);
+            }
+            break;
+        case SerializerType::JSON:
+            return json_string(value);
+    }
+    put_text(value);
+}
+
+void WireWriter::write_bytes(const uint8_t* data, size_t size) {
+    switch (type_) {
+        case SerializerType::CBOR:
+            cbor_head(2, size);
+            break;
+        case SerializerType::MSGPACK:
+            if (size <= 0xff) {
+                put(0xc4);
+                put_be(size, 1);
+            } else if (size <= 0xffff) {
+                put(0xc5);
+                put_be(size, 2);
+            } else {
+                put(0xc6);
+                put_be(size, 4);
+            }
+            break;
+        case SerializerType::JSON:
+            // WAMP carries binary in JSON as a string of a NUL character followed by base64.
+            put_text("\"\\u0000");
+            append_base64(out_, data, size);
+            put('"');
+            return;
+    }
+    write_raw(data, size);
+}
+
+void WireWriter::write_list(const List& list) {
+    begin_array(list.size());
+    bool first = true;
+    for (const auto& item : list) {
+        if (!first) separator();
+        write_value(item);
+        first = false;
+    }
+    end_array();
+}
+
+void WireWriter::write_dict(const Dict& dict) {
+    begin_map(dict.size());
+    bool first = true;
+    for (const auto& [key, item] : dict) {
+        if (!first) separator();
+        write_key(key);
+        write_value(item);
+        first = false;
+    }
+    end_map();
+}
+
+void WireWriter::write_value(const Value& value) {
+    std::visit(
+        [this](auto&& item) {
+            using T = std::decay_t<decltype(item)>;
+
+            if constexpr (std::is_same_v<T, std::monostate>)
+                write_null();
+            else if constexpr (std::is_same_v<T, int64_t>)
+                write_int(item);
+            else if constexpr (std::is_same_v<T, uint64_t>)
+                write_uint(item);
+            else if constexpr (std::is_same_v<T, double>)
+                write_double(item);
+            else if constexpr (std::is_same_v<T, std::string>)
+                write_string(item);
+            else if constexpr (std::is_same_v<T, bool>)
+                write_bool(item);
+            else if constexpr (std::is_same_v<T, Bytes>)
+                write_bytes(item.data(), item.size());
+            else if constexpr (std::is_same_v<T, std::shared_ptr<List>>)
+                item ? write_list(*item) : write_null();
+            else if constexpr (std::is_same_v<T, std::shared_ptr<Dict>>)
+                item ? write_dict(*item) : write_null();
+        },
+        value.data);
+}
+
+void WireWriter::write_value(const CompactValue& value) {
+    switch (value.type()) {
+        case CompactValue::Type::Null:
+            write_null();
+            return;
+        case CompactValue::Type::Int:
+            write_int(*value.getInt64());
+            return;
+        case CompactValue::Type::UInt:
+            write_uint(*value.getUInt64());
+            return;
+        case CompactValue::Type::Double:
+            write_double(*value.getDouble());
+            return;
+        case CompactValue::Type::Bool:
+            write_bool(*value.getBool());
+            return;
+        case CompactValue::Type::String:
+            write_string(*value.getString());
+            return;
+        case CompactValue::Type::Bytes: {
+            auto bytes = *value.getBytes();
+            write_bytes(bytes.data(), bytes.size());
+            return;
+        }
+        case CompactValue::Type::List: {
+            auto items = *value.getList();
+            begin_array(items.size());
+            for (size_t i = 0; i < items.size(); ++i) {
+                if (i) separator();
+                write_value(items[i]);
+            }
+            end_array();
+            return;
+        }
+        case CompactValue::Type::Dict: {
+            auto entries = *value.getDict();
+            begin_map(entries.size());
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (i) separator();
+                write_key(*entries[i].key.getString());
+                write_value(entries[i].value);
+            }
+            end_map();
+            return;
+        }
+    }
+}
+
+size_t payload_fields(const List& args, const Dict& kwargs, const TypedPayload* typed) {
+    if (!kwargs.empty() || (typed && !typed->kwargs.empty())) return 2;
+    if (!args.empty() || (typed && !typed->args.empty())) return 1;
+    return 0;
+}
+
+namespace {
+
+// Interleaves Values and typed arguments by their recorded positions.
+void write_typed_args(WireWriter& writer, const List& args, const TypedPayload& typed) {
+    size_t total = args.size() + typed.args.size();
+    auto value = args.begin();
+    auto next = typed.args.begin();
+
+    writer.begin_array(total);
+    for (size_t i = 0; i < total; ++i) {
+        if (i) writer.separator();
+        if (next != typed.args.end() && next->first == i) {
+            next->second(writer);
+            ++next;
+        } else {
+            writer.write_value(*value++);
+        }
+    }
+    writer.end_array();
+}
+
+void write_typed_kwargs(WireWriter& writer, const Dict& kwargs, const TypedPayload& typed) {
+    writer.begin_map(kwargs.size() + typed.kwargs.size());
+    bool first = true;
+    for (const auto& [key, item] : kwargs) {
+        if (!first) writer.separator();
+        writer.write_key(key);
+        writer.write_value(item);
+        first = false;
+    }
+    for (const auto& [key, write] : typed.kwargs) {
+        if (!first) writer.separator();
+        writer.write_key(key);
+        write(writer);
+        first = false;
+    }
+    writer.end_map();
+}
+
+}  // namespace
+
+void write_payload(WireWriter& writer, const List& args, const Dict& kwargs, const TypedPayload* typed) {
+    size_t fields = payload_fields(args, kwargs, typed);
+    if (fields == 0) return;
+
+    bool has_typed = typed && !typed->empty();
+
+    writer.separator();
+    if (has_typed) {
+        write_typed_args(writer, args, *typed);
+    } else {
+        writer.write_list(args);
+    }
+
+    if (fields == 2) {
+        writer.separator();
+        if (has_typed) {
+            write_typed_kwargs(writer, kwargs, *typed);
+        } else {
+            writer.write_dict(kwargs);
+        }
+    }
+}
+
+void encode_call(WireWriter& writer, uint64_t request_id, const Dict& options, std::string_view procedure,
+                 const List& args, const Dict& kwargs, const TypedPayload* typed) {
+    writer.begin_array(4 + payload_fields(args, kwargs, typed));
+    writer.write_uint(WAMP_MESSAGE_CALL);
+    writer.separator();
+    writer.write_uint(request_id);
+    writer.separator();
+    writer.write_dict(options);
+    writer.separator();
+    writer.write_string(procedure);
+    write_payload(writer, args, kwargs, typed);
+    writer.end_array();
+}
+
+void encode_publish(WireWriter& writer, uint64_t request_id, const Dict& options, std::string_view topic,
+                    const List& args, const Dict& kwargs, const TypedPayload* typed) {
+    writer.begin_array(4 + payload_fields(args, kwargs, typed));
+    writer.write_uint(WAMP_MESSAGE_PUBLISH);
+    writer.separator();
+    writer.write_uint(request_id);
+    writer.separator();
+    writer.write_dict(options);
+    writer.separator();
+    writer.write_string(topic);
+    write_payload(writer, args, kwargs, typed);
+    writer.end_array();
+}
+
+std::vector<uint8_t> encode_constant_fields(SerializerType type, const Dict& options, std::string_view uri) {
+    std::vector<uint8_t> out;
+    WireWriter writer(type, out);
+    writer.write_dict(options);
+    writer.separator();
+    writer.write_string(uri);
+    return out;
+}
+
+void encode_prepared(WireWriter& writer, uint64_t message_type, uint64_t request_id,
+                     const std::vector<uint8_t>& constant, const List& args, const Dict& kwargs,
+                     const TypedPayload* typed) {
+    writer.begin_array(4 + payload_fields(args, kwargs, typed));
+    writer.write_uint(message_type);
+    writer.separator();
+    writer.write_uint(request_id);
+    writer.separator();
+    writer.write_raw(constant.data(), constant.size());
+    write_payload(writer, args, kwargs, typed);
+    writer.end_array();
+}
+
+void encode_yield(WireWriter& writer, uint64_t request_id, const Dict& options, const List& args,
+                  const Dict& kwargs) {
+    writer.begin_array(3 + payload_fields(args, kwargs));
+    writer.write_uint(WAMP_MESSAGE_YIELD);
+    writer.separator();
+    writer.write_uint(request_id);
+    writer.separator();
+    writer.write_dict(options);
+    write_payload(writer, args, kwargs);
+    writer.end_array();
+}
+
+void encode_error(WireWriter& writer, uint64_t request_type, uint64_t request_id, const Dict& details,
+                  std::string_view uri, const List& args, const Dict& kwargs) {
+    writer.begin_array(5 + payload_fields(args, kwargs));
+    writer.write_uint(WAMP_MESSAGE_ERROR);
+    writer.separator();
+    writer.write_uint(request_type);
+    writer.separator();
+    writer.write_uint(request_id);
+    writer.separator();
+    writer.write_dict(details);
+    writer.separator();
+    writer.write_string(uri);
+    write_payload(writer, args, kwargs);
+    writer.end_array();
+}
+
+void append_base64(std::vector<uint8_t>& out, const uint8_t* data, size_t size) {
+    static constexpr char ALPHABET[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    out.reserve(out.size() + (size + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 2 < size; i += 3) {
+        uint32_t chunk = (uint32_t(data[i]) << 16) | (uint32_t(data[i + 1]) << 8) | data[i + 2];
+        out.push_back(ALPHABET[(chunk >> 18) & 0x3f]);
+        out.push_back(ALPHABET[(chunk >> 12) & 0x3f]);
+        out.push_back(ALPHABET[(chunk >> 6) & 0x3f]);
+        out.push_back(ALPHABET[chunk & 0x3f]);
+    }
+
+    if (i < size) {
+        uint32_t chunk = uint32_t(data[i]) << 16;
+        if (i + 1 < size) chunk |= uint32_t(data[i + 1]) << 8;
+
+        out.push_back(ALPHABET[(chunk >> 18) & 0x3f]);
+        out.push_back(ALPHABET[(chunk >> 12) & 0x3f]);
+        out.push_back(i + 1 < size ? ALPHABET[(chunk >> 6) & 0x3f] : '=');
+        out.push_back('=');
+    }
+}
+
+}  // namespace xconn
@@ -0,0 +1,75 @@
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+#include "xconn_cpp/alloc_accounting.hpp"
+
+using namespace xconn;
+
+// Keeps the compiler from pairing up and removing allocations whose result is unused.
+static void* volatile escape;
+
+void test_disabled_build_counts_nothing() {
+    AllocScope scope;
+    auto value = std::make_unique<int64_t>(7);
+    escape = value.get();
+
+    assert(scope.elapsed().allocations == 0);
+    assert(process_alloc_stats().allocations == 0);
+}
+
+void test_counts_operator_new() {
+    AllocScope scope;
+    auto value = std::make_unique<int64_t>(7);
+    escape = value.get();
+
+    AllocStats stats = scope.elapsed();
+    assert(stats.allocations == 1);
+    assert(stats.bytes == sizeof(int64_t));
+}
+
+void test_counts_malloc() {
+#if defined(__GLIBC__)
+    AllocScope scope;
+    void* buffer = std::malloc(100);
+    escape = buffer;
+    buffer = std::realloc(buffer, 200);
+    escape = buffer;
+    std::free(buffer);
+
+    AllocStats stats = scope.elapsed();
+    assert(stats.allocations == 2);
+    assert(stats.bytes == 300);
+#endif
+}
+
+void test_threads_count_separately() {
+    AllocStats process_before = process_alloc_stats();
+    AllocStats other;
+    std::thread thread([&other] {
+        AllocScope scope;
+        for (int i = 0; i < 10; ++i) escape = std::make_unique<int32_t>(i).get();
+        other = scope.elapsed();
+    });
+
+    AllocScope scope;
+    thread.join();
+
+    assert(other.allocations == 10 && other.bytes == 10 * sizeof(int32_t));
+    assert(scope.elapsed().allocations == 0);
+    assert((process_alloc_stats() - process_before).allocations >= 10);
+}
+
+int main() {
+    if (!alloc_accounting_enabled()) {
+        test_disabled_build_counts_nothing();
+        return 0;
+    }
+
+    test_counts_operator_new();
+    test_counts_malloc();
+    test_threads_count_separately();
+    return 0;
+}
@@ -0,0 +1,122 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/arena.hpp"
+#include "xconn_cpp/compact_value.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+using namespace xconn;
+
+void test_arena() {
+    Arena arena(64);
+    void* first = arena.allocate(10, 1);
+    auto* aligned = arena.allocate_array<uint64_t>(2);
+    assert(reinterpret_cast<uintptr_t>(aligned) % alignof(uint64_t) == 0);
+
+    // Larger than a block gets a block of its own.
+    arena.allocate(1000);
+    assert(arena.capacity() >= 1064);
+
+    size_t capacity = arena.capacity();
+    arena.reset();
+    assert(arena.used() == 0);
+    assert(arena.allocate(10, 1) == first);
+    assert(arena.capacity() == capacity);
+}
+
+void test_scalars_and_strings() {
+    Arena arena;
+    assert(CompactValue().isNull());
+    assert(CompactValue(int64_t(-7)).getInt64() == -7);
+    assert(CompactValue(uint64_t(1) << 63).getUInt64() == uint64_t(1) << 63);
+    assert(CompactValue(1.25).getDouble() == 1.25);
+    assert(CompactValue(true).getBool() == true);
+    assert(!CompactValue(5).getString());
+
+    std::string small = "fourteen bytes";
+    std::string large(100, 'x');
+    assert(arena.used() == 0);
+    assert(CompactValue(arena, small).getString() == small);
+    assert(arena.used() == 0);
+    assert(CompactValue(arena, large).getString() == large);
+    assert(arena.used() == large.size());
+
+    Bytes bytes{0, 1, 2};
+    CompactValue inline_bytes = CompactValue::bytes(arena, bytes);
+    auto view = *inline_bytes.getBytes();
+    assert(Bytes(view.begin(), view.end()) == bytes);
+}
+
+void test_containers() {
+    Arena arena;
+    CompactValue dict =
+        CompactValue::dict(arena, {{"zeta", 1}, {"alpha", 2}, {"mid", CompactValue(arena, "m")}, {"alpha", 3}});
+    assert(dict.size() == 3);
+    assert(dict.get("alpha")->getInt64() == 3);
+    assert(dict.get("zeta")->getInt64() == 1);
+    assert(dict.get("mid")->getString() == "m");
+    assert(dict.get("missing") == nullptr);
+    assert(dict.getDict()->front().key.getString() == "alpha");
+
+    CompactValue list = CompactValue::list(arena, {1, dict, CompactValue()});
+    assert(list.size() == 3);
+    assert(list.at(1)->get("zeta")->getInt64() == 1);
+    assert(list.at(3) == nullptr);
+}
+
+void test_value_round_trip() {
+    Arena arena;
+    Value value = make_list({int64_t(1), "a string that is not inline", Bytes{9, 8},
+                             make_dict({{"k", make_list({true, Value()})}, {"d", 0.5}})});
+
+    CompactValue compact = CompactValue::from(arena, value);
+    Value back = compact.toValue();
+    auto list = back.getList();
+    assert(list && list->size() == 4);
+    assert((*list)[1].getString() == "a string that is not inline");
+    assert((*list)[3].getDict()->get("d")->getDouble() == 0.5);
+
+    // Encodes exactly like the Value it came from (single-key dicts, so order is fixed).
+    for (SerializerType type : {SerializerType::JSON, SerializerType::MSGPACK, SerializerType::CBOR}) {
+        std::vector<uint8_t> expected, actual;
+        Value ordered = make_list({int64_t(1), "x", make_dict({{"k", Bytes{1}}})});
+        WireWriter(type, expected).write_value(ordered);
+        WireWriter(type, actual).write_value(CompactValue::from(arena, ordered));
+        assert(expected == actual);
+
+        WireFrame frame(type, expected);
+        CompactValue decoded = frame.root().toCompact(arena);
+        assert(decoded.at(1)->getString() == "x");
+        assert(decoded.at(2)->get("k")->getBytes()->size() == 1);
+    }
+}
+
+void test_oversized_count_is_not_allocated() {
+    // Lists and dicts claiming far more elements than the frame holds.
+    std::vector<std::pair<SerializerType, std::vector<uint8_t>>> frames = {
+        {SerializerType::CBOR, {0x9b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01}},
+        {SerializerType::CBOR, {0xbb, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01}},
+        {SerializerType::MSGPACK, {0xdd, 0xff, 0xff, 0xff, 0xff, 0x01}},
+        {SerializerType::MSGPACK, {0xdf, 0xff, 0xff, 0xff, 0xff, 0x01, 0x01}},
+    };
+    for (auto& [type, bytes] : frames) {
+        Arena arena;
+        WireFrame frame(type, bytes);
+        assert(frame.root().toCompact(arena).isNull());
+        assert(arena.used() == 0);
+    }
+}
+
+int main() {
+    test_arena();
+    test_scalars_and_strings();
+    test_containers();
+    test_value_round_trip();
+    test_oversized_count_is_not_allocated();
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "xconn_cpp/internal/concurrency_limiter.hpp"
+
+using namespace xconn;
+
+using Admission = ConcurrencyLimiter::Admission;
+
+void test_admits_up_to_limit() {
+    ConcurrencyLimiter limiter(2, SIZE_MAX);
+    std::function<void()> task = [] {};
+
+    assert(limiter.admit(task) == Admission::Run);
+    assert(limiter.admit(task) == Admission::Run);
+    assert(limiter.running() == 2);
+    assert(limiter.queued() == 0);
+
+    assert(!limiter.release().has_value());
+    assert(limiter.running() == 1);
+    assert(limiter.admit(task) == Admission::Run);
+}
+
+void test_queued_tasks_run_in_order() {
+    ConcurrencyLimiter limiter(1, SIZE_MAX);
+    std::string order;
+    std::function<void()> first = [&] { order += 'a'; };
+    std::function<void()> second = [&] { order += 'b'; };
+    std::function<void()> third = [&] { order += 'c'; };
+
+    assert(limiter.admit(first) == Admission::Run);
+    assert(limiter.admit(second) == Admission::Queued);
+    assert(limiter.admit(third) == Admission::Queued);
+    assert(limiter.queued() == 2);
+
+    // Each release hands the slot straight to the next waiting task.
+    while (auto next = limiter.release()) {
+        assert(limiter.running() == 1);
+        (*next)();
+    }
+    assert(order == "bc");
+    assert(limiter.running() == 0);
+    assert(limiter.queued() == 0);
+}
+
+void test_rejects_past_max_queued() {
+    ConcurrencyLimiter limiter(1, 1);
+    std::function<void()> task = [] {};
+    bool ran = false;
+    std::function<void()> rejected = [&] { ran = true; };
+
+    assert(limiter.admit(task) == Admission::Run);
+    assert(limiter.admit(task) == Admission::Queued);
+    assert(limiter.admit(rejected) == Admission::Rejected);
+
+    // A rejected task is left with the caller.
+    assert(rejected);
+    rejected();
+    assert(ran);
+    assert(limiter.queued() == 1);
+}
+
+void test_zero_limit_runs_one() {
+    ConcurrencyLimiter limiter(0, 0);
+    std::function<void()> task = [] {};
+    assert(limiter.admit(task) == Admission::Run);
+    assert(limiter.admit(task) == Admission::Rejected);
+}
+
+int main() {
+    test_admits_up_to_limit();
+    test_queued_tasks_run_in_order();
+    test_rejects_past_max_queued();
+    test_zero_limit_runs_one();
+    return 0;
+}
@@ -0,0 +1,89 @@
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "xconn_cpp/internal/deadline_timer.hpp"
+
+using namespace xconn;
+using namespace std::chrono_literals;
+
+struct Expired {
+    std::mutex mutex;
+    std::vector<uint64_t> ids;
+
+    void add(uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ids.push_back(id);
+    }
+    std::vector<uint64_t> get() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return ids;
+    }
+};
+
+void test_expires_in_deadline_order() {
+    Expired expired;
+    DeadlineTimer timer([&](uint64_t id) { expired.add(id); });
+
+    auto now = DeadlineTimer::Clock::now();
+    timer.schedule(now + 60ms, 3);
+    timer.schedule(now + 20ms, 1);
+    timer.schedule(now + 40ms, 2);
+    while (expired.get().size() < 3) std::this_thread::sleep_for(1ms);
+
+    assert((expired.get() == std::vector<uint64_t>{1, 2, 3}));
+    assert(timer.pending() == 0);
+}
+
+void test_cancelled_deadline_does_not_expire() {
+    Expired expired;
+    DeadlineTimer timer([&](uint64_t id) { expired.add(id); });
+
+    auto now = DeadlineTimer::Clock::now();
+    timer.schedule(now + 20ms, 1);
+    timer.schedule(now + 40ms, 2);
+    timer.cancel(now + 20ms, 1);
+    assert(timer.pending() == 1);
+    while (expired.get().empty()) std::this_thread::sleep_for(1ms);
+    std::this_thread::sleep_for(30ms);
+
+    assert((expired.get() == std::vector<uint64_t>{2}));
+}
+
+void test_earlier_deadline_wakes_timer() {
+    Expired expired;
+    DeadlineTimer timer([&](uint64_t id) { expired.add(id); });
+
+    // The timer is asleep until the first deadline when the earlier one comes in.
+    auto now = DeadlineTimer::Clock::now();
+    timer.schedule(now + 10s, 1);
+    std::this_thread::sleep_for(10ms);
+    timer.schedule(DeadlineTimer::Clock::now() + 10ms, 2);
+    while (expired.get().empty()) std::this_thread::sleep_for(1ms);
+
+    assert((expired.get() == std::vector<uint64_t>{2}));
+    assert(timer.pending() == 1);
+}
+
+void test_destroyed_with_pending_deadlines() {
+    Expired expired;
+    {
+        DeadlineTimer timer([&](uint64_t id) { expired.add(id); });
+        timer.schedule(DeadlineTimer::Clock::now() + 10s, 1);
+    }
+    assert(expired.get().empty());
+
+    // Never scheduled, so no thread was started to join.
+    DeadlineTimer unused([](uint64_t) {});
+}
+
+int main() {
+    test_expires_in_deadline_order();
+    test_cancelled_deadline_does_not_expire();
+    test_earlier_deadline_wakes_timer();
+    test_destroyed_with_pending_deadlines();
+    return 0;
+}
@@ -0,0 +1,47 @@
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "xconn_cpp/internal/encode_buffer.hpp"
+
+using namespace xconn;
+
+void test_nested_leases_do_not_share() {
+    EncodeBuffer outer;
+    outer.bytes().assign({1, 2, 3});
+    {
+        // What a CALL made from inside a procedure handler does while its YIELD is encoded.
+        EncodeBuffer inner;
+        assert(inner.bytes().empty());
+        assert(&inner.bytes() != &outer.bytes());
+        inner.bytes().assign({9, 9});
+        {
+            EncodeBuffer deepest;
+            deepest.bytes().push_back(7);
+            assert(EncodeBuffer::held() == 3);
+        }
+    }
+    assert((outer.bytes() == std::vector<uint8_t>{1, 2, 3}));
+    assert(EncodeBuffer::held() == 1);
+}
+
+void test_buffers_are_reused() {
+    const uint8_t* data = nullptr;
+    {
+        EncodeBuffer lease;
+        lease.bytes().resize(256);
+        data = lease.bytes().data();
+    }
+    EncodeBuffer again;
+    assert(again.bytes().empty());
+    assert(again.bytes().capacity() >= 256);
+    again.bytes().resize(1);
+    assert(again.bytes().data() == data);
+}
+
+int main() {
+    test_nested_leases_do_not_share();
+    test_buffers_are_reused();
+    assert(EncodeBuffer::held() == 0);
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "xconn_cpp/internal/event_batcher.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+using namespace xconn;
+
+static EventView event(int64_t publication_id) {
+    auto frame = std::make_shared<WireFrame>(SerializerType::CBOR);
+    WireWriter(frame->format, frame->buffer)
+        .write_value(make_list({int64_t(36), int64_t(1), publication_id, make_dict({}), make_list({publication_id})}));
+    return EventView(frame);
+}
+
+void test_first_event_starts_a_drain() {
+    EventBatcher batcher(8);
+    assert(batcher.add(event(1), 100));
+    // Further events join the drain already under way.
+    assert(!batcher.add(event(2), 200));
+    assert(!batcher.add(event(3), 300));
+
+    std::vector<EventView> batch;
+    assert(batcher.take(batch) == 100);
+    assert(batch.size() == 3);
+    for (size_t i = 0; i < batch.size(); ++i) assert(batch[i].publication_id == i + 1);
+    assert(batch[2].argInt64(0) == 3);
+
+    assert(!batcher.finish());
+    assert(batcher.add(event(4), 400));
+}
+
+void test_batches_are_capped() {
+    EventBatcher batcher(2);
+    batcher.add(event(1), 1);
+    batcher.add(event(2), 2);
+    batcher.add(event(3), 3);
+
+    std::vector<EventView> batch;
+    batcher.take(batch);
+    assert(batch.size() == 2);
+    assert(batcher.pending() == 1);
+
+    // The rest is left for the next batch, which the same drain posts again.
+    assert(batcher.finish());
+    batch.clear();
+    assert(batcher.take(batch) == 3);
+    assert(batch.size() == 1 && batch[0].publication_id == 3);
+    assert(!batcher.finish());
+}
+
+void test_events_during_a_batch_are_kept() {
+    EventBatcher batcher(4);
+    batcher.add(event(1), 1);
+
+    std::vector<EventView> batch;
+    batcher.take(batch);
+    // Arrives while the handler runs: no second drain, the running one picks it up.
+    assert(!batcher.add(event(2), 2));
+    assert(batcher.finish());
+
+    batch.clear();
+    batcher.take(batch);
+    assert(batch.size() == 1 && batch[0].publication_id == 2);
+    assert(!batcher.finish());
+}
+
+void test_conflation_keeps_latest_per_key() {
+    EventBatcher batcher(8);
+    bool replaced = true;
+    assert(batcher.add(event(1), 1, "a", replaced) && !replaced);
+    assert(!batcher.add(event(2), 2, "b", replaced) && !replaced);
+    assert(!batcher.add(event(3), 3, "a", replaced) && replaced);
+    // Unkeyed events are never replaced.
+    assert(!batcher.add(event(4), 4));
+    assert(!batcher.add(event(5), 5, "b", replaced) && replaced);
+    assert(batcher.pending() == 3);
+
+    // The newer events took the older ones' places.
+    std::vector<EventView> batch;
+    assert(batcher.take(batch) == 1);
+    assert(batch.size() == 3);
+    assert(batch[0].publication_id == 3);
+    assert(batch[1].publication_id == 5);
+    assert(batch[2].publication_id == 4);
+    assert(!batcher.finish());
+}
+
+void test_taken_keys_are_released() {
+    EventBatcher batcher(1);
+    bool replaced = false;
+    batcher.add(event(1), 1, "a", replaced);
+    batcher.add(event(2), 2, "", replaced);
+
+    std::vector<EventView> batch;
+    batcher.take(batch);
+    assert(batch[0].publication_id == 1);
+
+    // "a" is with the handler now, so a new event for it waits behind the rest.
+    batcher.add(event(3), 3, "a", replaced);
+    assert(!replaced);
+    batcher.add(event(4), 4, "", replaced);
+    assert(replaced);
+
+    batch.clear();
+    batcher.take(batch);
+    assert(batch[0].publication_id == 4);
+    batch.clear();
+    batcher.take(batch);
+    assert(batch[0].publication_id == 3);
+    assert(batcher.pending() == 0);
+}
+
+int main() {
+    test_first_event_starts_a_drain();
+    test_batches_are_capped();
+    test_events_during_a_batch_are_kept();
+    test_conflation_keeps_latest_per_key();
+    test_taken_keys_are_released();
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/alloc_accounting.hpp"
+#include "xconn_cpp/internal/frame_pool.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+using namespace xconn;
+
+static void fill(WireFrame& frame, const Value& message) {
+    WireWriter(frame.format, frame.buffer).write_value(message);
+}
+
+void test_frames_are_reused() {
+    FramePool pool(SerializerType::CBOR, 2);
+
+    auto frame = pool.acquire();
+    WireFrame* address = frame.get();
+    fill(*frame, make_list({int64_t(36), int64_t(1), int64_t(2), make_dict({}), make_list({"tick"})}));
+    size_t capacity = frame->buffer.capacity();
+    frame->arena().allocate(100);
+
+    // Views keep the frame out of the pool until the last one is gone.
+    {
+        EventView event(frame);
+        frame.reset();
+        assert(pool.idle() == 0);
+        assert(event.argString(0) == "tick");
+    }
+    assert(pool.idle() == 1);
+
+    auto reused = pool.acquire();
+    assert(reused.get() == address);
+    assert(reused->format == SerializerType::CBOR);
+    assert(reused->buffer.empty());
+    assert(reused->buffer.capacity() == capacity);
+    assert(reused->arena().used() == 0);
+    assert(reused->arena().capacity() > 0);
+}
+
+void test_idle_limit_and_retain_size() {
+    FramePool pool(SerializerType::MSGPACK, 2, 1024);
+
+    {
+        std::vector<std::shared_ptr<WireFrame>> frames;
+        for (int i = 0; i < 4; ++i) frames.push_back(pool.acquire());
+        frames[0]->buffer.resize(4096);
+        frames[1]->buffer.resize(512);
+    }
+    assert(pool.idle() == 2);
+
+    // The oversized buffer was released, the small one kept.
+    auto first = pool.acquire();
+    auto second = pool.acquire();
+    assert(first->buffer.capacity() + second->buffer.capacity() <= 1024);
+}
+
+void test_warm_acquire_does_not_allocate() {
+    if (!alloc_accounting_enabled()) return;
+    FramePool pool(SerializerType::CBOR, 2);
+    pool.acquire()->buffer.push_back(0);
+
+    // Neither the frame nor its shared_ptr control block is allocated again.
+    AllocScope scope;
+    for (int i = 0; i < 100; ++i) {
+        auto frame = pool.acquire();
+        frame->buffer.push_back(uint8_t(i));
+    }
+    assert(scope.elapsed().allocations == 0);
+}
+
+void test_pool_destroyed_first() {
+    std::shared_ptr<WireFrame> frame;
+    {
+        FramePool pool(SerializerType::JSON);
+        frame = pool.acquire();
+    }
+    fill(*frame, make_list({int64_t(1)}));
+    frame.reset();
+}
+
+void test_decoded_text_lives_in_arena() {
+    FramePool pool(SerializerType::JSON);
+
+    auto frame = pool.acquire();
+    fill(*frame, make_list({int64_t(36), int64_t(1), int64_t(2), make_dict({}),
+                            make_list({"line\nbreak", Bytes{1, 2, 3}})}));
+
+    EventView event(frame);
+    assert(event.argString(0) == "line\nbreak");
+    auto bytes = event.argBytes(1);
+    assert(bytes && bytes->size() == 3 && (*bytes)[2] == 3);
+    assert(frame->arena().used() > 0);
+
+    // Handlers can decode into the same arena.
+    CompactValue args = event.args().toCompact(event.arena());
+    assert(args.size() == 2);
+}
+
+int main() {
+    test_frames_are_reused();
+    test_idle_limit_and_retain_size();
+    test_warm_acquire_does_not_allocate();
+    test_pool_destroyed_first();
+    test_decoded_text_lives_in_arena();
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <cassert>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/internal/json_scan.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+using namespace xconn;
+
+static std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> result{SimdLevel::Scalar};
+    if (json_simd_supported() >= SimdLevel::SSE42) result.push_back(SimdLevel::SSE42);
+    if (json_simd_supported() >= SimdLevel::AVX2) result.push_back(SimdLevel::AVX2);
+    return result;
+}
+
+// Every level finds the same byte as a plain loop, at every offset and across chunk tails.
+void test_scanners_match_reference() {
+    const char specials[] = {'"', '\\', '\n', '\x01', '[', ']', '{', '}', 'y', '_', 'Y', '\x7f', '\xfb', '\xdd'};
+    std::mt19937 rng(7);
+
+    for (SimdLevel level : levels()) {
+        set_json_simd_level(level);
+        assert(json_simd_level() == level);
+
+        for (size_t length = 0; length < 100; ++length) {
+            std::vector<uint8_t> buffer(length);
+            for (auto& byte : buffer) byte = 'a' + rng() % 26;
+
+            for (char special : specials) {
+                for (size_t position = 0; position <= length; ++position) {
+                    uint8_t saved = position < length ? buffer[position] : 0;
+                    if (position < length) buffer[position] = uint8_t(special);
+
+                    const uint8_t* begin = buffer.data();
+                    const uint8_t* end = begin + length;
+
+                    auto find = [&](auto match) {
+                        const uint8_t* p = begin;
+                        while (p < end && !match(*p)) ++p;
+                        return p;
+                    };
+
+                    assert(json_find_quote_or_backslash(begin, end) ==
+                           find([](uint8_t c) { return c == '"' || c == '\\'; }));
+                    assert(json_find_unsafe(begin, end) ==
+                           find([](uint8_t c) { return c < 0x20 || c == '"' || c == '\\'; }));
+                    assert(json_find_structural(begin, end) == find([](uint8_t c) {
+                               return c == '"' || c == '[' || c == ']' || c == '{' || c == '}';
+                           }));
+
+                    if (position < length) buffer[position] = saved;
+                }
+            }
+        }
+    }
+    set_json_simd_level(json_simd_supported());
+}
+
+void test_round_trip_per_level() {
+    std::string text(300, 'x');
+    text[17] = '"';
+    text[40] = '\\';
+    text[99] = '\n';
+    text[200] = '\x02';
+    text += "{]}";
+
+    for (SimdLevel level : levels()) {
+        set_json_simd_level(level);
+
+        std::vector<uint8_t> out;
+        WireWriter(SerializerType::JSON, out).write_value(make_list({text, make_dict({{"k", text}}), int64_t(1)}));
+
+        WireFrame frame(SerializerType::JSON, out);
+        ValueView root = frame.root();
+        assert(root.size() == 3);
+        assert(root.at(0).getString() == text);
+        assert(root.at(1).get("k").getString() == text);
+        assert(root.at(2).getInt64() == 1);
+    }
+    set_json_simd_level(json_simd_supported());
+}
+
+int main() {
+    test_scanners_match_reference();
+    test_round_trip_per_level();
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "xconn_cpp/latency_histogram.hpp"
+
+using namespace xconn;
+
+void test_empty_snapshot() {
+    LatencyHistogram histogram;
+    HistogramSnapshot snapshot = histogram.snapshot();
+
+    assert(snapshot.count == 0);
+    assert(snapshot.p99 == 0);
+}
+
+void test_bucket_bounds() {
+    for (uint64_t value : std::vector<uint64_t>{0, 1, 15, 16, 17, 1000, 123456789, UINT64_MAX}) {
+        std::size_t index = LatencyHistogram::bucket_index(value);
+        assert(index < LatencyHistogram::NUM_BUCKETS);
+        assert(LatencyHistogram::bucket_upper_bound(index) >= value);
+        // Buckets are at most 1/16 wide relative to their values.
+        assert(LatencyHistogram::bucket_upper_bound(index) - value <= value / 16);
+    }
+}
+
+void test_percentiles() {
+    LatencyHistogram histogram;
+    for (uint64_t i = 1; i <= 1000; ++i) histogram.record(i * 1000);
+
+    HistogramSnapshot snapshot = histogram.snapshot();
+    assert(snapshot.count == 1000);
+    assert(snapshot.min == 1000);
+    assert(snapshot.max == 1000000);
+    assert(snapshot.mean == 500500.0);
+    assert(snapshot.p50 >= 500000 && snapshot.p50 <= 500000 + 500000 / 16);
+    assert(snapshot.p99 >= 990000 && snapshot.p99 <= snapshot.max);
+}
+
+void test_concurrent_record() {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&histogram] {
+            for (uint64_t i = 0; i < 10000; ++i) histogram.record(i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    assert(histogram.snapshot().count == 40000);
+
+    histogram.reset();
+    assert(histogram.snapshot().count == 0);
+}
+
+int main() {
+    test_empty_snapshot();
+    test_bucket_bounds();
+    test_percentiles();
+    test_concurrent_record();
+
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "xconn_cpp/internal/log.hpp"
+#include "xconn_cpp/logging.hpp"
+
+using namespace xconn;
+
+class CaptureSink : public LogSink {
+   public:
+    void write(const LogRecord& record) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        records_.push_back(record);
+    }
+
+    std::vector<LogRecord> take() {
+        flush_logs();
+        std::lock_guard<std::mutex> lock(mutex_);
+        return std::move(records_);
+    }
+
+   private:
+    std::mutex mutex_;
+    std::vector<LogRecord> records_;
+};
+
+void test_levels() {
+    auto sink = std::make_shared<CaptureSink>();
+    set_log_sink(sink);
+
+    assert(log_level() == LogLevel::Info);
+    log(LogLevel::Debug, "hidden");
+    log(LogLevel::Info, "shown");
+
+    set_log_level(LogLevel::Error);
+    assert(!log_enabled(LogLevel::Warning));
+    log(LogLevel::Warning, "hidden");
+    log(LogLevel::Error, "failure");
+
+    set_log_level(LogLevel::Off);
+    assert(!log_enabled(LogLevel::Error));
+    log(LogLevel::Error, "hidden");
+    set_log_level(LogLevel::Info);
+
+    auto records = sink->take();
+    assert(records.size() == 2);
+    assert(records[0].message == "shown" && records[0].level == LogLevel::Info);
+    assert(records[1].message == "failure" && records[1].level == LogLevel::Error);
+    assert(records[0].timestamp_ns != 0);
+}
+
+void test_rate_limit() {
+    LogRateLimit limit(3);
+    uint64_t suppressed = 99;
+    const uint64_t second = 1'000'000'000;
+
+    for (int i = 0; i < 3; ++i) {
+        assert(limit.allow(5 * second + i, suppressed));
+        assert(suppressed == 0);
+    }
+    for (int i = 0; i < 4; ++i) assert(!limit.allow(5 * second + 10, suppressed));
+
+    // A new window lets messages through again and reports what was held back.
+    assert(limit.allow(6 * second, suppressed));
+    assert(suppressed == 4);
+    assert(limit.allow(6 * second, suppressed));
+    assert(suppressed == 0);
+}
+
+void test_macro_rate_limits_per_site() {
+    auto sink = std::make_shared<CaptureSink>();
+    set_log_sink(sink);
+
+    int formatted = 0;
+    auto count = [&] { return ++formatted; };
+    for (int i = 0; i < 100; ++i) XCONN_LOG(LogLevel::Warning, "site one {}", count());
+    XCONN_LOG(LogLevel::Warning, "site two");
+
+    // Arguments of refused messages are never evaluated.
+    assert(formatted <= 20);
+    auto records = sink->take();
+    assert(records.size() == size_t(formatted) + 1);
+    assert(records.back().message == "site two");
+
+    set_log_level(LogLevel::Error);
+    XCONN_LOG(LogLevel::Warning, "filtered {}", count());
+    set_log_level(LogLevel::Info);
+    assert(formatted <= 20);
+    assert(sink->take().empty());
+}
+
+void test_concurrent_producers() {
+    auto sink = std::make_shared<CaptureSink>();
+    set_log_sink(sink);
+
+    constexpr int THREADS = 4;
+    constexpr int PER_THREAD = 3000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < PER_THREAD; ++i) log(LogLevel::Info, std::to_string(t) + ":" + std::to_string(i));
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    // Whatever did not fit in the queue is reported as dropped instead of blocking producers.
+    uint64_t written = 0;
+    uint64_t dropped = 0;
+    for (const auto& record : sink->take()) {
+        if (record.message.find("log messages dropped") != std::string::npos) {
+            dropped += std::stoull(record.message);
+        } else {
+            ++written;
+        }
+    }
+    assert(written + dropped == THREADS * PER_THREAD);
+}
+
+void test_null_sink_discards() {
+    set_log_sink(nullptr);
+    log(LogLevel::Error, "discarded");
+    flush_logs();
+    set_log_sink(std::make_shared<StderrLogSink>());
+}
+
+int main() {
+    test_levels();
+    test_rate_limit();
+    test_macro_rate_limits_per_site();
+    test_concurrent_producers();
+    test_null_sink_discards();
+    return 0;
+}
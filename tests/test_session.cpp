@@ -1,13 +1,28 @@
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <exception>
+#include <future>
 #include <iostream>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <thread>
 #include <vector>
 
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+#include "xconn_cpp/alloc_accounting.hpp"
 #include "xconn_cpp/authenticators.hpp"
 #include "xconn_cpp/client.hpp"
 #include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
 
 using namespace xconn;
 
@@ -16,6 +31,27 @@ void test_call_request();
 void test_subscripiton_request();
 void test_all_authenticator_and_serializers();
 void test_bytes_over_network();
+void test_connect_many();
+void test_prepared_requests();
+void test_passthru_requests();
+void test_expected_call_errors();
+void test_session_metrics();
+void test_call_tracing();
+void test_alloc_budgets();
+void test_threading_options();
+void test_handler_priorities();
+void test_concurrency_limit();
+void test_async_handlers();
+void test_batched_events();
+void test_conflated_events();
+void test_nested_requests_in_handler();
+void test_nested_call_in_typed_handler();
+void test_oversized_yield();
+void test_oversized_call();
+void test_async_handler_sends_before_suspending();
+void test_async_handler_concurrency_limit();
+void test_async_call_timeout();
+void test_async_call_on_close();
 
 int main() {
     test_client_session_lifecycle();
@@ -23,6 +59,27 @@ int main() {
     test_subscripiton_request();
     test_all_authenticator_and_serializers();
     test_bytes_over_network();
+    test_connect_many();
+    test_prepared_requests();
+    test_passthru_requests();
+    test_expected_call_errors();
+    test_session_metrics();
+    test_call_tracing();
+    test_alloc_budgets();
+    test_threading_options();
+    test_handler_priorities();
+    test_concurrency_limit();
+    test_async_handlers();
+    test_batched_events();
+    test_conflated_events();
+    test_nested_requests_in_handler();
+    test_nested_call_in_typed_handler();
+    test_oversized_yield();
+    test_oversized_call();
+    test_async_handler_sends_before_suspending();
+    test_async_handler_concurrency_limit();
+    test_async_call_timeout();
+    test_async_call_on_close();
 
     return 0;
 }
@@ -186,3 +243,638 @@ void test_bytes_over_network() {
 
     assert(!session->is_connected());
 }
+
+void test_connect_many() {
+    auto client = Client(CryptosignAuthenticator(cryptosign_auth_id, private_key_hex), SerializerType::CBOR);
+
+    ConnectTimings timings;
+    auto sessions = client.connect_many(url, realm, 8, 4, &timings);
+
+    assert(sessions.size() == 8);
+    for (auto& session : sessions) {
+        assert(session->session_id > 0);
+        Result result = session->Call(procedure).Arg(2).Arg(4).Do();
+        assert(result.argInt64(0).value() == 6);
+    }
+
+    assert(timings.join.count() > 0);
+    assert(timings.wall.count() > 0);
+
+    for (auto& session : sessions) session->leave();
+}
+
+void test_prepared_requests() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    auto add = session->PrepareCall(procedure);
+    for (int64_t i = 0; i < 3; ++i) {
+        Result result = add.Do(List{i, int64_t(10)});
+        assert(result.argInt64(0).value() == i + 10);
+    }
+
+    std::atomic<int> received{0};
+    auto subscription = session->Subscribe("xconn.io.prepared", [&received](const Event&) { received++; }).Do();
+
+    auto publish = session->PreparePublish("xconn.io.prepared", Dict{{"acknowledge", true}, {"exclude_me", false}});
+    for (int i = 0; i < 3; ++i) publish.Do(List{i});
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    assert(received == 3);
+
+    subscription.unsubscribe();
+    session->leave();
+}
+
+void test_passthru_requests() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+    Bytes message{0x08, 0x96, 0x01, 0x12, 0x02, 'o', 'k'};
+
+    ProcedureViewHandler echo = [](const InvocationView& invocation) -> Result {
+        auto passthru = invocation.passThru().value();
+        return passthru_result(std::string(passthru.scheme), Bytes(passthru.payload.begin(), passthru.payload.end()));
+    };
+    auto registration = session->Register("xconn.io.passthru", echo).Do();
+
+    ResultView result = session->Call("xconn.io.passthru").PassThru("x_protobuf", message).DoView();
+    auto passthru = result.passThru().value();
+    assert(passthru.scheme == "x_protobuf");
+    assert(Bytes(passthru.payload.begin(), passthru.payload.end()) == message);
+
+    registration.unregister();
+    session->leave();
+}
+
+void test_expected_call_errors() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    auto missing = session->Call("xconn.io.missing").Arg(1).DoExpected();
+    assert(!missing);
+    assert(missing.error().uri() == "wamp.error.no_such_procedure");
+
+    auto prepared = session->PrepareCall("xconn.io.missing").DoViewExpected();
+    assert(!prepared && prepared.error().uri() == "wamp.error.no_such_procedure");
+
+    auto sum = session->Call(procedure).Arg(2).Arg(4).DoExpected();
+    assert(sum && sum->argInt64(0).value() == 6);
+
+    // The throwing API still reports the same error.
+    bool thrown = false;
+    try {
+        session->Call("xconn.io.missing").Do();
+    } catch (const std::runtime_error& e) {
+        thrown = std::string(e.what()).starts_with("wamp.error.no_such_procedure");
+    }
+    assert(thrown);
+
+    session->leave();
+}
+
+void test_session_metrics() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    for (int i = 0; i < 5; ++i) session->Call(procedure).Arg(int64_t(i)).Arg(int64_t(1)).Do();
+    session->Call("xconn.io.missing").DoExpected();
+
+    SessionMetricsSnapshot snap = session->metrics();
+    assert(snap.calls == 6);
+    assert(snap.call_errors == 1);
+    assert(snap.call_latency.count == 6);
+    assert(snap.messages_sent >= 6 && snap.messages_received >= 6);
+    assert(snap.bytes_sent > 0 && snap.bytes_received > 0);
+    assert(snap.pending_calls == 0);
+
+    std::string text = session->prometheus_metrics();
+    assert(text.find("xconn_calls_total{session_id=\"" + std::to_string(session->session_id)) != std::string::npos);
+
+    session->leave();
+}
+
+void test_call_tracing() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+    auto sink = std::make_shared<RingBufferTraceSink>();
+    session->set_trace_sink(sink);
+
+    ProcedureViewHandler echo = [](const InvocationView& invocation) -> Result {
+        return Result(invocation.args().toList(), Dict(), Dict());
+    };
+    auto registration = session->Register("xconn.io.traced", echo).Do();
+    session->Call("xconn.io.traced").Arg(int64_t(1)).Do();
+
+    // Every stage is recorded exactly once, for the CALL and for the INVOCATION it caused. The
+    // worker records YieldWritten after its send returns, which may be after the RESULT is here.
+    std::map<TraceStage, uint64_t> timestamps;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(TIMEOUT_SECONDS);
+    while (!timestamps.count(TraceStage::YieldWritten) && std::chrono::steady_clock::now() < deadline) {
+        for (const TraceEvent& event : sink->drain()) {
+            assert(timestamps.emplace(event.stage, event.timestamp_ns).second);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    assert(timestamps.size() == size_t(TraceStage::YieldWritten) + 1);
+    assert(timestamps[TraceStage::CallStarted] <= timestamps[TraceStage::CallWritten]);
+    assert(timestamps[TraceStage::CallWritten] <= timestamps[TraceStage::CallCompleted]);
+    assert(timestamps[TraceStage::InvocationReceived] <= timestamps[TraceStage::HandlerFinished]);
+
+    session->set_trace_sink(nullptr);
+    session->Call("xconn.io.traced").Arg(int64_t(2)).Do();
+    assert(sink->drain().empty());
+
+    registration.unregister();
+    session->leave();
+}
+
+// Steady-state ceilings on heap allocations per operation, summed over every thread that
+// serves it. Raising one should be a deliberate decision.
+constexpr uint64_t CALL_ALLOC_BUDGET = 8;
+constexpr uint64_t PUBLISH_ALLOC_BUDGET = 2;
+constexpr uint64_t INVOCATION_ALLOC_BUDGET = 16;
+
+void test_alloc_budgets() {
+    if (!alloc_accounting_enabled()) return;
+
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+    ProcedureViewHandler handler = [](const InvocationView&) -> Result { return Result(); };
+    auto registration = session->Register("xconn.io.budget", handler).Do();
+
+    auto call = session->Call("xconn.io.budget").Arg(int64_t(1));
+    auto publish = session->Publish("xconn.io.budget.topic").Arg(int64_t(1));
+
+    // Let frame pools, encode buffers and hash tables reach their working size first.
+    for (int i = 0; i < 100; ++i) {
+        call.Do();
+        publish.Do();
+    }
+
+    constexpr uint64_t N = 1000;
+    SessionMetricsSnapshot before = session->metrics();
+    AllocScope calls;
+    for (uint64_t i = 0; i < N; ++i) call.Do();
+    AllocStats caller = calls.elapsed();
+    AllocScope publishes;
+    for (uint64_t i = 0; i < N; ++i) publish.Do();
+    AllocStats publisher = publishes.elapsed();
+    SessionMetricsSnapshot after = session->metrics();
+
+    assert(caller.allocations <= CALL_ALLOC_BUDGET * N);
+    assert((after.call_allocs - before.call_allocs).allocations <= CALL_ALLOC_BUDGET * N);
+    assert(publisher.allocations <= PUBLISH_ALLOC_BUDGET * N);
+    assert((after.publish_allocs - before.publish_allocs).allocations <= PUBLISH_ALLOC_BUDGET * N);
+    assert((after.invocation_allocs - before.invocation_allocs).allocations <= INVOCATION_ALLOC_BUDGET * N);
+
+    // The counters do see the work: queuing each handler on the pool allocates.
+    assert(after.invocation_allocs.allocations > before.invocation_allocs.allocations);
+    std::string text = session->prometheus_metrics();
+    assert(text.find("xconn_allocations_total") != std::string::npos);
+
+    registration.unregister();
+    session->leave();
+}
+
+void test_threading_options() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 2;
+    client.threading.name_prefix = "tsess";
+    client.threading.worker_cpus = {0};
+
+    auto session = client.connect(url, realm);
+
+    std::atomic<int> handled{0};
+    ProcedureViewHandler handler = [&handled](const InvocationView&) -> Result {
+#ifdef __linux__
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        assert(std::string(name).rfind("tsess-w", 0) == 0);
+#endif
+        ++handled;
+        return Result();
+    };
+    auto registration = session->Register("xconn.io.placed", handler).Do();
+    session->Call("xconn.io.placed").Do();
+    assert(handled == 1);
+
+    registration.unregister();
+    session->leave();
+}
+
+void test_handler_priorities() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 1;
+    client.threading.high_priority_workers = 1;
+    auto session = client.connect(url, realm);
+
+    // The only general worker is stuck in a slow event handler; the High procedure still answers.
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> events{0};
+    EventHandler bulk = [released, &events](const Event&) {
+        released.wait();
+        ++events;
+    };
+    auto subscription = session->Subscribe("xconn.io.bulk", bulk).Priority(HandlerPriority::Low).Do();
+
+    ProcedureViewHandler health = [](const InvocationView&) -> Result { return Result(List{"ok"}, Dict(), Dict()); };
+    auto registration = session->Register("xconn.io.health", health).Priority(HandlerPriority::High).Do();
+
+    session->Publish("xconn.io.bulk").Option("exclude_me", false).Do();
+    Result result = session->Call("xconn.io.health").Do();
+    assert(result.argString(0) == "ok");
+
+    release.set_value();
+    while (events == 0) std::this_thread::yield();
+
+    registration.unregister();
+    subscription.unsubscribe();
+    session->leave();
+}
+
+void test_concurrency_limit() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 4;
+    auto session = client.connect(url, realm);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> active{0};
+    std::atomic<int> peak{0};
+    ProcedureViewHandler slow = [&, released](const InvocationView&) -> Result {
+        int now = ++active;
+        int seen = peak;
+        while (now > seen && !peak.compare_exchange_weak(seen, now)) {
+        }
+        released.wait();
+        --active;
+        return Result(List{"done"}, Dict(), Dict());
+    };
+    auto registration = session->Register("xconn.io.limited", slow).Concurrency(1, 1).Do();
+
+    // The first call takes the only slot, the second waits for it and the third finds the queue full.
+    auto first = std::async(std::launch::async, [&] { return session->Call("xconn.io.limited").Do(); });
+    while (active == 0) std::this_thread::yield();
+    auto second = std::async(std::launch::async, [&] { return session->Call("xconn.io.limited").Do(); });
+    while (session->metrics().invocations < 2) std::this_thread::yield();
+
+    auto rejected = session->Call("xconn.io.limited").DoExpected();
+    assert(!rejected && rejected.error().uri() == "wamp.error.unavailable");
+    assert(session->metrics().invocations_rejected == 1);
+
+    release.set_value();
+    assert(first.get().argString(0) == "done");
+    assert(second.get().argString(0) == "done");
+    assert(peak == 1);
+
+    registration.unregister();
+    session->leave();
+}
+
+void test_async_handlers() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 1;
+    auto session = client.connect(url, realm);
+
+    // Each level calls the next one; with blocking handlers the single worker would be
+    // stuck in the first Do() until it timed out.
+    AsyncProcedureHandler chain = [&session](Invocation invocation) -> Task<Result> {
+        int64_t depth = invocation.argInt64(0).value();
+        if (depth == 0) {
+            Result sum = co_await session->Call(procedure).Arg(2).Arg(4).DoAsync();
+            co_return sum;
+        }
+        Result inner = co_await session->Call("xconn.io.chain").Arg(depth - 1).DoAsync();
+        co_return Result(List{inner.argInt64(0).value() + 1}, Dict(), Dict());
+    };
+    auto chained = session->Register("xconn.io.chain", chain).Do();
+
+    AsyncProcedureHandler failing = [&session](Invocation) -> Task<Result> {
+        co_await session->Call("xconn.io.missing").DoAsync();
+        co_return Result();
+    };
+    auto failed = session->Register("xconn.io.failing", failing).Do();
+
+    Result result = session->Call("xconn.io.chain").Arg(3).Do();
+    assert(result.argInt64(0).value() == 9);
+
+    auto error = session->Call("xconn.io.failing").DoExpected();
+    assert(!error && error.error().uri() == "wamp.error.runtime_error");
+
+    chained.unregister();
+    failed.unregister();
+    session->leave();
+}
+
+void test_batched_events() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 1;
+    auto session = client.connect(url, realm);
+
+    // Holds the only worker so the ticks pile up behind it.
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    EventHandler gate = [released](const Event&) { released.wait(); };
+    auto gated = session->Subscribe("xconn.io.gate", gate).Do();
+
+    std::mutex mutex;
+    std::vector<size_t> sizes;
+    std::vector<int64_t> ticks;
+    EventBatchHandler batched = [&](std::span<const Event> events) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sizes.push_back(events.size());
+        for (const Event& event : events) ticks.push_back(event.argInt64(0).value());
+    };
+    auto subscription = session->Subscribe("xconn.io.ticks", batched).MaxBatch(4).Do();
+
+    session->Publish("xconn.io.gate").Option("exclude_me", false).Do();
+    for (int64_t i = 0; i < 10; ++i) session->Publish("xconn.io.ticks").Arg(i).Option("exclude_me", false).Do();
+    while (session->metrics().events < 11) std::this_thread::yield();
+    release.set_value();
+
+    while (true) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (ticks.size() == 10) break;
+    }
+    for (int64_t i = 0; i < 10; ++i) assert(ticks[i] == i);
+    // At least nine ticks were waiting when the worker came free, so the first batch is full.
+    assert(sizes.front() == 4);
+    for (size_t size : sizes) assert(size <= 4);
+    assert(session->metrics().event_batches == sizes.size());
+
+    subscription.unsubscribe();
+    gated.unsubscribe();
+    session->leave();
+}
+
+void test_conflated_events() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 1;
+    auto session = client.connect(url, realm);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    EventHandler gate = [released](const Event&) { released.wait(); };
+    auto gated = session->Subscribe("xconn.io.gate", gate).Do();
+
+    std::mutex mutex;
+    std::vector<std::pair<std::string, int64_t>> quotes;
+    EventHandler latest = [&](const Event& event) {
+        std::lock_guard<std::mutex> lock(mutex);
+        quotes.emplace_back(event.argString(0).value(), event.argInt64(1).value());
+    };
+    ConflationKey instrument = [](const EventView& event) { return std::string(event.argString(0).value_or("")); };
+    auto subscription = session->Subscribe("xconn.io.quotes", latest).Conflate(instrument).Do();
+
+    // Five updates each for three instruments, while the handler cannot keep up.
+    session->Publish("xconn.io.gate").Option("exclude_me", false).Do();
+    for (int64_t price = 0; price < 5; ++price) {
+        for (std::string symbol : {"a", "b", "c"}) {
+            session->Publish("xconn.io.quotes").Arg(symbol).Arg(price).Option("exclude_me", false).Do();
+        }
+    }
+    while (session->metrics().events_conflated < 12) std::this_thread::yield();
+    release.set_value();
+
+    while (true) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (quotes.size() == 3) break;
+    }
+    std::vector<std::pair<std::string, int64_t>> expected{{"a", 4}, {"b", 4}, {"c", 4}};
+    assert(quotes == expected);
+    assert(session->metrics().events_conflated == 12);
+
+    subscription.unsubscribe();
+    gated.unsubscribe();
+    session->leave();
+}
+
+void test_nested_requests_in_handler() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    std::atomic<int> notified{0};
+    EventHandler on_audit = [&notified](const Event& event) {
+        assert(event.argString(0) == "relay");
+        ++notified;
+    };
+    auto audit = session->Subscribe("xconn.io.audit", on_audit).Do();
+
+    // Both nested requests encode while the invocation's YIELD buffer is held; the reply must
+    // still reach the caller as a message of its own.
+    ProcedureHandler relay = [&session](const Invocation& invocation) -> Result {
+        session->Publish("xconn.io.audit").Arg("relay").Option("exclude_me", false).Do();
+        Result sum = session->Call(procedure).Arg(invocation.argInt64(0).value()).Arg(int64_t(1)).Do();
+        return Result(List{sum.argInt64(0).value(), "relayed"}, Dict(), Dict());
+    };
+    auto registration = session->Register("xconn.io.relay", relay).Do();
+
+    for (int64_t i = 0; i < 3; ++i) {
+        Result result = session->Call("xconn.io.relay").Arg(i).Do();
+        assert(result.argInt64(0).value() == i + 1);
+        assert(result.argString(1) == "relayed");
+    }
+    while (notified < 3) std::this_thread::yield();
+
+    registration.unregister();
+    audit.unsubscribe();
+    session->leave();
+}
+
+void test_nested_call_in_typed_handler() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    auto relay = [&session](int64_t a, int64_t b) {
+        Result sum = session->Call(procedure).Arg(a).Arg(b).Do();
+        return sum.argInt64(0).value() * 10;
+    };
+    auto registration = session->Register<int64_t(int64_t, int64_t)>("xconn.io.typed_relay", relay).Do();
+
+    for (int64_t i = 0; i < 3; ++i) {
+        Result result = session->Call("xconn.io.typed_relay").Arg(i).Arg(int64_t(2)).Do();
+        assert(result.argInt64(0).value() == (i + 2) * 10);
+    }
+
+    registration.unregister();
+    session->leave();
+}
+
+void test_oversized_yield() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    // Larger than any RawSocket frame, so the YIELD can never be sent.
+    ProcedureHandler huge = [](const Invocation&) -> Result {
+        return Result(List{Bytes(17 * 1024 * 1024, 0xab)}, Dict(), Dict());
+    };
+    auto registration = session->Register("xconn.io.huge", huge).Do();
+
+    auto reply = session->Call("xconn.io.huge").DoExpected();
+    assert(!reply && reply.error().uri() == "wamp.error.payload_size_exceeded");
+
+    // The worker that failed to send is still there.
+    Result sum = session->Call(procedure).Arg(1).Arg(2).Do();
+    assert(sum.argInt64(0).value() == 3);
+
+    registration.unregister();
+    session->leave();
+}
+
+void test_oversized_call() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    bool thrown = false;
+    try {
+        session->Call(procedure).Arg(Bytes(17 * 1024 * 1024, 0xab)).Do();
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // The CALL that was never sent leaves nothing waiting for a reply, and is not counted.
+    SessionMetricsSnapshot snap = session->metrics();
+    assert(snap.pending_calls == 0);
+    assert(snap.calls == 0);
+
+    Result sum = session->Call(procedure).Arg(1).Arg(2).Do();
+    assert(sum.argInt64(0).value() == 3);
+    session->leave();
+}
+
+void test_async_handler_sends_before_suspending() {
+    auto session = connectTicket(url, realm, ticket_auth_id, ticket);
+
+    std::atomic<int> notified{0};
+    EventHandler on_started = [&notified](const Event&) { ++notified; };
+    auto started = session->Subscribe("xconn.io.started", on_started).Do();
+
+    // Publishes synchronously before its first co_await, and once without suspending at all;
+    // neither PUBLISH may be mistaken for the reply.
+    AsyncProcedureHandler announce = [&session](Invocation invocation) -> Task<Result> {
+        session->Publish("xconn.io.started").Option("exclude_me", false).Do();
+        if (invocation.argInt64(0).value() == 0) co_return Result(List{"immediate"}, Dict(), Dict());
+        Result sum = co_await session->Call(procedure).Arg(1).Arg(1).DoAsync();
+        co_return Result(List{"awaited", sum.argInt64(0).value()}, Dict(), Dict());
+    };
+    auto registration = session->Register("xconn.io.announce", announce).Do();
+
+    Result immediate = session->Call("xconn.io.announce").Arg(int64_t(0)).Do();
+    assert(immediate.argString(0) == "immediate");
+    Result awaited = session->Call("xconn.io.announce").Arg(int64_t(1)).Do();
+    assert(awaited.argString(0) == "awaited" && awaited.argInt64(1).value() == 2);
+    while (notified < 2) std::this_thread::yield();
+
+    registration.unregister();
+    started.unsubscribe();
+    session->leave();
+}
+
+void test_async_handler_concurrency_limit() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 2;
+    auto session = client.connect(url, realm);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> blocking{false};
+    ProcedureViewHandler blocker = [&, released](const InvocationView&) -> Result {
+        blocking = true;
+        released.wait();
+        return Result(List{"done"}, Dict(), Dict());
+    };
+    auto blocked = session->Register("xconn.io.blocker", blocker).Do();
+
+    // Suspended in its co_await, the first invocation still holds the only slot.
+    AsyncProcedureHandler waiting = [&session](Invocation) -> Task<Result> {
+        Result inner = co_await session->Call("xconn.io.blocker").DoAsync();
+        co_return inner;
+    };
+    auto limited = session->Register("xconn.io.async_limited", waiting).Concurrency(1, 0).Do();
+
+    auto first = std::async(std::launch::async, [&] { return session->Call("xconn.io.async_limited").Do(); });
+    while (!blocking) std::this_thread::yield();
+
+    auto rejected = session->Call("xconn.io.async_limited").DoExpected();
+    assert(!rejected && rejected.error().uri() == "wamp.error.unavailable");
+
+    release.set_value();
+    assert(first.get().argString(0) == "done");
+
+    // The slot is given back just after the first reply is sent, so a call may still find it taken.
+    auto again = session->Call("xconn.io.async_limited").DoExpected();
+    while (!again && again.error().uri() == "wamp.error.unavailable") {
+        std::this_thread::yield();
+        again = session->Call("xconn.io.async_limited").DoExpected();
+    }
+    assert(again && again->argString(0) == "done");
+
+    limited.unregister();
+    blocked.unregister();
+    session->leave();
+}
+
+// Awaits one call of `uri` and hands back its first argument, or the message it failed with.
+static Task<std::string> await_call(Session& session, std::string uri, std::chrono::milliseconds timeout) {
+    try {
+        Result result = co_await session.Call(uri).DoAsync(timeout);
+        co_return result.argString(0).value();
+    } catch (const std::runtime_error& e) {
+        co_return std::string(e.what());
+    }
+}
+
+void test_async_call_timeout() {
+    auto authenticator = std::make_unique<TicketAuthenticator>(ticket_auth_id, ticket);
+    Client client(*authenticator, SerializerType::CBOR);
+    client.threading.worker_threads = 2;
+    auto session = client.connect(url, realm);
+
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ProcedureViewHandler blocker = [released](const InvocationView&) -> Result {
+        released.wait();
+        return Result(List{"done"}, Dict(), Dict());
+    };
+    auto blocked = session->Register("xconn.io.blocker", blocker).Do();
+
+    std::promise<std::string> outcome;
+    await_call(*session, "xconn.io.blocker", std::chrono::milliseconds(100))
+        .detach([&outcome](std::optional<std::string> value, std::exception_ptr) { outcome.set_value(*value); });
+    std::string error = outcome.get_future().get();
+    assert(error.rfind("wamp.error.timeout", 0) == 0);
+    assert(session->metrics().pending_calls == 0);
+
+    // The late RESULT finds no call waiting for it.
+    release.set_value();
+    assert(session->Call(procedure).Arg(1).Arg(1).Do().argInt64(0).value() == 2);
+
+    blocked.unregister();
+    session->leave();
+}
+
+void test_async_call_on_close() {
+    auto callee = connectTicket(url, realm, ticket_auth_id, ticket);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<bool> blocking{false};
+    ProcedureViewHandler blocker = [&blocking, released](const InvocationView&) -> Result {
+        blocking = true;
+        released.wait();
+        return Result(List{"done"}, Dict(), Dict());
+    };
+    auto blocked = callee->Register("xconn.io.blocker", blocker).Do();
+
+    auto caller = connectTicket(url, realm, ticket_auth_id, ticket);
+    std::promise<std::string> outcome;
+    await_call(*caller, "xconn.io.blocker", std::chrono::seconds(TIMEOUT_SECONDS))
+        .detach([&outcome](std::optional<std::string> value, std::exception_ptr) { outcome.set_value(*value); });
+    while (!blocking) std::this_thread::yield();
+
+    caller->leave();
+    std::string error = outcome.get_future().get();
+    assert(error.rfind("xconn.error.connection_closed", 0) == 0);
+
+    release.set_value();
+    blocked.unregister();
+    callee->leave();
+}
@@ -0,0 +1,106 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "xconn_cpp/session_metrics.hpp"
+
+using namespace xconn;
+
+static bool contains(const std::string& text, const std::string& line) { return text.find(line) != std::string::npos; }
+
+void test_snapshot() {
+    SessionMetrics metrics;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&metrics] {
+            for (int i = 0; i < 1000; ++i) {
+                metrics.record_sent(10);
+                metrics.calls.add();
+                metrics.call_latency.record(2000);
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    metrics.record_received(7);
+    metrics.events.add(3);
+
+    SessionMetricsSnapshot snap = metrics.snapshot();
+    assert(snap.messages_sent == 4000);
+    assert(snap.bytes_sent == 40000);
+    assert(snap.messages_received == 1 && snap.bytes_received == 7);
+    assert(snap.calls == 4000 && snap.call_errors == 0);
+    assert(snap.events == 3);
+    assert(snap.call_latency.count == 4000);
+    assert(snap.call_latency.p50 == 2000);
+    assert(snap.handler_latency.count == 0);
+}
+
+void test_prometheus_format() {
+    SessionMetricsSnapshot snap;
+    snap.messages_sent = 12;
+    snap.pending_calls = 2;
+    snap.pool_queue_depth = 5;
+    snap.call_latency.count = 4;
+    snap.call_latency.mean = 1500;
+    snap.call_latency.p50 = 1000;
+
+    std::string text = to_prometheus(snap, {{"session_id", "42"}, {"realm", "a\"b"}});
+
+    assert(contains(text, "# TYPE xconn_messages_sent_total counter\n"));
+    assert(contains(text, "xconn_messages_sent_total{session_id=\"42\",realm=\"a\\\"b\"} 12\n"));
+    assert(contains(text, "xconn_pending_requests{session_id=\"42\",realm=\"a\\\"b\",request=\"call\"} 2\n"));
+    assert(contains(text, "xconn_pool_queue_depth{session_id=\"42\",realm=\"a\\\"b\"} 5\n"));
+    assert(contains(text, "# TYPE xconn_call_latency_seconds summary\n"));
+    // Seconds are printed with every digit needed to read the value back exactly.
+    assert(contains(text, "xconn_call_latency_seconds{session_id=\"42\",realm=\"a\\\"b\",quantile=\"0.5\"} "
+                          "9.9999999999999995e-07\n"));
+    assert(contains(text, "xconn_call_latency_seconds_sum{session_id=\"42\",realm=\"a\\\"b\"} "
+                          "6.0000000000000002e-06\n"));
+    assert(contains(text, "xconn_call_latency_seconds_count{session_id=\"42\",realm=\"a\\\"b\"} 4\n"));
+
+    // Without labels there are no braces at all.
+    std::string bare = to_prometheus(SessionMetricsSnapshot());
+    assert(contains(bare, "\nxconn_events_total 0\n"));
+    assert(contains(bare, "xconn_pending_requests{request=\"publish\"} 0\n"));
+}
+
+void test_large_counters() {
+    SessionMetricsSnapshot snap;
+    snap.bytes_sent = 5000000123;
+    snap.messages_received = (uint64_t(1) << 53) + 1;
+    snap.pending_calls = 4294967297;
+    snap.call_latency.count = 4294967299;
+
+    // Every digit is kept; a float format would round these off.
+    std::string text = to_prometheus(snap);
+    assert(contains(text, "\nxconn_bytes_sent_total 5000000123\n"));
+    assert(contains(text, "\nxconn_messages_received_total 9007199254740993\n"));
+    assert(contains(text, "xconn_pending_requests{request=\"call\"} 4294967297\n"));
+    assert(contains(text, "\nxconn_call_latency_seconds_count 4294967299\n"));
+}
+
+void test_alloc_series() {
+    SessionMetrics metrics;
+    metrics.call_allocs.add({3, 96});
+    metrics.call_allocs.add({1, 32});
+
+    SessionMetricsSnapshot snap = metrics.snapshot();
+    assert(snap.call_allocs.allocations == 4 && snap.call_allocs.bytes == 128);
+    assert(snap.publish_allocs.allocations == 0);
+
+    // Only instrumentation builds export allocation counters.
+    std::string text = to_prometheus(snap);
+    assert(contains(text, "xconn_allocations_total{operation=\"call\"} 4\n") == alloc_accounting_enabled());
+    assert(contains(text, "xconn_allocated_bytes_total{operation=\"call\"} 128\n") == alloc_accounting_enabled());
+}
+
+int main() {
+    test_snapshot();
+    test_prometheus_format();
+    test_large_counters();
+    test_alloc_series();
+    return 0;
+}
@@ -0,0 +1,294 @@
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "xconn_cpp/internal/socket_transport.hpp"
+#include "xconn_cpp/transports/transport.hpp"
+
+using namespace xconn;
+
+// The far end of a FakeTransport: bytes pushed here are what the transport reads, and what
+// it writes ends up here.
+struct Peer {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<uint8_t> inbound;
+    std::vector<uint8_t> written;
+    // Most bytes a single read() returns, to make SocketTransport cope with short reads.
+    size_t max_read = SIZE_MAX;
+    // The size asked for by every read().
+    std::vector<size_t> requested;
+    // Once set and `inbound` is drained, read() reports the end of the stream.
+    bool eof = false;
+    // Answer every PING written with a PONG carrying its payload.
+    bool answer_pings = false;
+    bool shut_down = false;
+    bool closed = false;
+    // Reads in progress, and whether the transport was closed under one.
+    int reading = 0;
+    bool closed_during_read = false;
+    std::thread::id closed_by;
+    // How much of `written` has been looked at for PINGs.
+    size_t parsed = 0;
+
+    void push(const std::vector<uint8_t>& bytes) {
+        std::lock_guard<std::mutex> lock(mutex);
+        inbound.insert(inbound.end(), bytes.begin(), bytes.end());
+        changed.notify_all();
+    }
+    void end() {
+        std::lock_guard<std::mutex> lock(mutex);
+        eof = true;
+        changed.notify_all();
+    }
+    std::vector<uint8_t> output() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return written;
+    }
+};
+
+class FakeTransport : public Transport {
+   public:
+    explicit FakeTransport(std::shared_ptr<Peer> peer) : peer_(std::move(peer)) {}
+
+    void connect(const std::string&, const std::string&) override {}
+
+    std::size_t read(uint8_t* buffer, std::size_t n) override {
+        std::unique_lock<std::mutex> lock(peer_->mutex);
+        peer_->requested.push_back(n);
+        ++peer_->reading;
+        peer_->changed.wait(lock, [this] {
+            return !peer_->inbound.empty() || peer_->eof || peer_->shut_down || peer_->closed;
+        });
+        --peer_->reading;
+        if (peer_->shut_down) return 0;
+        size_t count = std::min({n, peer_->max_read, peer_->inbound.size()});
+        std::copy_n(peer_->inbound.begin(), count, buffer);
+        peer_->inbound.erase(peer_->inbound.begin(), peer_->inbound.begin() + count);
+        return count;
+    }
+
+    std::size_t write(const std::vector<uint8_t>& data) override { return write(data.data(), data.size()); }
+
+    std::size_t write(const uint8_t* data, std::size_t length) override {
+        std::lock_guard<std::mutex> lock(peer_->mutex);
+        peer_->written.insert(peer_->written.end(), data, data + length);
+        answer_pings();
+        return length;
+    }
+
+    std::size_t close() override {
+        std::lock_guard<std::mutex> lock(peer_->mutex);
+        peer_->closed_during_read = peer_->closed_during_read || peer_->reading > 0;
+        peer_->closed_by = std::this_thread::get_id();
+        peer_->closed = true;
+        peer_->changed.notify_all();
+        return 0;
+    }
+
+    void shutdown() override {
+        std::lock_guard<std::mutex> lock(peer_->mutex);
+        peer_->shut_down = true;
+        peer_->changed.notify_all();
+    }
+
+    bool is_connected() const override {
+        std::lock_guard<std::mutex> lock(peer_->mutex);
+        return !peer_->closed;
+    }
+
+   private:
+    std::shared_ptr<Peer> peer_;
+
+    // Called with the peer's mutex held, after every write.
+    void answer_pings() {
+        std::vector<uint8_t>& out = peer_->written;
+        while (out.size() - peer_->parsed >= 4) {
+            const uint8_t* head = out.data() + peer_->parsed;
+            size_t length = (size_t(head[1]) << 16) | (size_t(head[2]) << 8) | size_t(head[3]);
+            if (out.size() - peer_->parsed - 4 < length) return;
+            if (head[0] == FRAME_TYPE_PING && peer_->answer_pings) {
+                peer_->inbound.insert(peer_->inbound.end(), {FRAME_TYPE_PONG, head[1], head[2], head[3]});
+                peer_->inbound.insert(peer_->inbound.end(), head + 4, head + 4 + length);
+                peer_->changed.notify_all();
+            }
+            peer_->parsed += 4 + length;
+        }
+    }
+};
+
+static std::vector<uint8_t> header(uint8_t type, size_t length) {
+    return {type, uint8_t(length >> 16), uint8_t(length >> 8), uint8_t(length)};
+}
+
+static std::vector<uint8_t> frame(uint8_t type, const std::vector<uint8_t>& payload) {
+    std::vector<uint8_t> bytes = header(type, payload.size());
+    bytes.insert(bytes.end(), payload.begin(), payload.end());
+    return bytes;
+}
+
+static std::vector<uint8_t> pattern(size_t length) {
+    std::vector<uint8_t> bytes(length);
+    for (size_t i = 0; i < length; ++i) bytes[i] = uint8_t(i * 7);
+    return bytes;
+}
+
+void test_oversized_send_is_refused() {
+    auto peer = std::make_shared<Peer>();
+    SocketTransport transport(std::make_unique<FakeTransport>(peer), 1024, 16);
+
+    std::vector<uint8_t> message = pattern(17);
+    bool thrown = false;
+    try {
+        transport.write(message.data(), message.size());
+    } catch (const std::length_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    assert(peer->output().empty());
+
+    message.pop_back();
+    assert(transport.write(message.data(), message.size()));
+    assert(peer->output() == frame(FRAME_TYPE_WAMP, message));
+}
+
+void test_oversized_frame_closes_connection() {
+    auto peer = std::make_shared<Peer>();
+    SocketTransport transport(std::make_unique<FakeTransport>(peer), 1024, 1024);
+    peer->push(header(FRAME_TYPE_WAMP, 1025));
+
+    std::vector<uint8_t> payload;
+    std::error_code error;
+    try {
+        transport.read_into(payload);
+    } catch (const std::system_error& e) {
+        error = e.code();
+    }
+    assert(error == std::errc::message_size);
+    assert(!transport.is_connected());
+    // Only the header was read, nothing of the payload.
+    assert((peer->requested == std::vector<size_t>{4}));
+}
+
+void test_short_reads_are_resumed() {
+    auto peer = std::make_shared<Peer>();
+    peer->max_read = 3;
+    SocketTransport transport(std::make_unique<FakeTransport>(peer), 1024, 1024);
+
+    std::vector<uint8_t> first = pattern(300);
+    std::vector<uint8_t> second = pattern(5);
+    peer->push(frame(FRAME_TYPE_WAMP, first));
+    peer->push(frame(FRAME_TYPE_WAMP, second));
+
+    std::vector<uint8_t> payload;
+    assert(transport.read_into(payload) && payload == first);
+    assert(transport.read_into(payload) && payload == second);
+
+    // A stream that ends mid-frame is a closed connection, not a frame.
+    peer->push({FRAME_TYPE_WAMP, 0, 0});
+    peer->end();
+    assert(!transport.read_into(payload));
+}
+
+void test_payload_grows_in_chunks() {
+    auto peer = std::make_shared<Peer>();
+    SocketTransport transport(std::make_unique<FakeTransport>(peer), RAWSOCKET_MAX_LENGTH, RAWSOCKET_MAX_LENGTH);
+
+    // The buffer grows by one chunk, then doubles, as the payload arrives.
+    std::vector<uint8_t> large = pattern(3 * RECV_CHUNK_SIZE + 5);
+    peer->push(frame(FRAME_TYPE_WAMP, large));
+    std::vector<uint8_t> payload;
+    assert(transport.read_into(payload) && payload == large);
+    assert((peer->requested == std::vector<size_t>{4, RECV_CHUNK_SIZE, RECV_CHUNK_SIZE, RECV_CHUNK_SIZE + 5}));
+
+    // A frame announcing far more than ever arrives allocates for what came, not what was announced.
+    peer->push(header(FRAME_TYPE_WAMP, RAWSOCKET_MAX_LENGTH - 1));
+    peer->push(pattern(10));
+    peer->end();
+    std::vector<uint8_t> truncated;
+    assert(!transport.read_into(truncated));
+    assert(truncated.capacity() <= RECV_CHUNK_SIZE);
+}
+
+void test_ping_is_answered() {
+    auto peer = std::make_shared<Peer>();
+    SocketTransport transport(std::make_unique<FakeTransport>(peer), 1024, 1024);
+
+    std::vector<uint8_t> message = pattern(6);
+    peer->push(frame(FRAME_TYPE_PING, {'a', 'b', 'c'}));
+    peer->push(frame(FRAME_TYPE_WAMP, message));
+
+    // The PING is answered and skipped; the WAMP frame after it is returned.
+    std::vector<uint8_t> payload;
+    assert(transport.read_into(payload) && payload == message);
+    assert(peer->output() == frame(FRAME_TYPE_PONG, {'a', 'b', 'c'}));
+}
+
+void test_keepalive_round_trip() {
+    auto peer = std::make_shared<Peer>();
+    peer->answer_pings = true;
+    SocketTransport transport(std::make_unique<FakeTransport>(peer), 1024, 1024);
+
+    // PONGs are taken in by the read loop, so one must be running.
+    std::vector<uint8_t> payload;
+    bool received = false;
+    std::thread reader([&] { received = transport.read_into(payload); });
+    transport.start_keepalive({std::chrono::milliseconds(5), std::chrono::milliseconds(5000)});
+    while (transport.rtt().count < 3) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    peer->push(frame(FRAME_TYPE_WAMP, {1}));
+    reader.join();
+    transport.stop_keepalive();
+    assert(received && payload == std::vector<uint8_t>{1});
+    assert(transport.is_connected());
+    assert(transport.rtt().max > 0);
+}
+
+void test_keepalive_timeout_closes_from_reader() {
+    auto peer = std::make_shared<Peer>();
+    SocketTransport transport(std::make_unique<FakeTransport>(peer), 1024, 1024);
+
+    // The PINGs go unanswered while the reader waits in read().
+    std::error_code error;
+    std::thread::id reader_id;
+    std::thread reader([&] {
+        reader_id = std::this_thread::get_id();
+        std::vector<uint8_t> payload;
+        try {
+            transport.read_into(payload);
+        } catch (const std::system_error& e) {
+            error = e.code();
+        }
+    });
+    transport.start_keepalive({std::chrono::milliseconds(5), std::chrono::milliseconds(20)});
+    reader.join();
+    transport.stop_keepalive();
+
+    assert(error == std::errc::timed_out);
+    assert(!transport.is_connected());
+    std::lock_guard<std::mutex> lock(peer->mutex);
+    assert(peer->shut_down);
+    // Closed by the reader once woken, never by the keepalive thread under its read.
+    assert(peer->closed_by == reader_id);
+    assert(!peer->closed_during_read);
+}
+
+int main() {
+    test_oversized_send_is_refused();
+    test_oversized_frame_closes_connection();
+    test_short_reads_are_resumed();
+    test_payload_grows_in_chunks();
+    test_ping_is_answered();
+    test_keepalive_round_trip();
+    test_keepalive_timeout_closes_from_reader();
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/struct_fields.hpp"
+#include "xconn_cpp/typed_handler.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+using namespace xconn;
+
+namespace market {
+
+struct Quote {
+    std::string symbol;
+    double price = 0;
+    int64_t volume = 0;
+    std::optional<std::string> venue;
+};
+XCONN_FIELDS(Quote, symbol, price, volume, venue)
+
+struct Level {
+    double price = 0;
+    uint32_t size = 0;
+};
+XCONN_ARRAY_FIELDS(Level, price, size)
+
+struct Book {
+    Quote last;
+    std::vector<Level> bids;
+};
+XCONN_FIELDS(Book, last, bids)
+
+}  // namespace market
+
+static_assert(HasFields<market::Quote>);
+static_assert(!HasFields<Dict>);
+static_assert(struct_field_count<market::Book>() == 2);
+static_assert(struct_layout<market::Level>() == StructLayout::Array);
+
+static const SerializerType FORMATS[] = {SerializerType::JSON, SerializerType::MSGPACK, SerializerType::CBOR};
+
+template <typename T>
+static std::vector<uint8_t> encode(SerializerType type, const T& value) {
+    std::vector<uint8_t> out;
+    WireWriter writer(type, out);
+    ValueCodec<T>::encode(writer, value);
+    return out;
+}
+
+void test_round_trip() {
+    market::Book book{{"XCON", 12.5, 300, std::nullopt}, {{12.25, 10}, {12.0, 40}}};
+
+    for (SerializerType type : FORMATS) {
+        WireFrame frame(type, encode(type, book));
+
+        // Encoded as an ordinary dict, readable by untyped peers.
+        Dict dict = frame.root().toDict();
+        assert(dict.at("last").getDict()->at("symbol").getString() == "XCON");
+        assert(dict.at("last").getDict()->at("venue").isNull());
+        assert(dict.at("bids").getList()->at(1).getList()->at(1).getInt64() == 40);
+
+        auto decoded = value_as<market::Book>(frame.root());
+        assert(decoded);
+        assert(decoded->last.symbol == "XCON");
+        assert(decoded->last.price == 12.5);
+        assert(decoded->last.volume == 300);
+        assert(!decoded->last.venue);
+        assert(decoded->bids.size() == 2);
+        assert(decoded->bids[0].price == 12.25);
+        assert(decoded->bids[1].size == 40);
+    }
+}
+
+void test_decode_rules() {
+    for (SerializerType type : FORMATS) {
+        // Fields in any order, unknown keys ignored, optional fields may be absent.
+        auto bytes =
+            encode<Value>(type, make_dict({{"volume", int64_t(1)}, {"extra", true}, {"price", 2.0}, {"symbol", "A"}}));
+        auto quote = value_as<market::Quote>(WireFrame(type, bytes).root());
+        assert(quote && quote->symbol == "A" && quote->volume == 1 && !quote->venue);
+
+        // A required field is missing, or has the wrong type.
+        bytes = encode<Value>(type, make_dict({{"symbol", "A"}, {"price", 2.0}}));
+        assert(!value_as<market::Quote>(WireFrame(type, bytes).root()));
+        bytes = encode<Value>(type, make_dict({{"symbol", int64_t(1)}, {"price", 2.0}, {"volume", int64_t(1)}}));
+        assert(!value_as<market::Quote>(WireFrame(type, bytes).root()));
+
+        // Array layout takes positional values, and no more of them than there are fields.
+        bytes = encode<Value>(type, make_list({1.5, int64_t(3)}));
+        auto level = value_as<market::Level>(WireFrame(type, bytes).root());
+        assert(level && level->price == 1.5 && level->size == 3);
+        bytes = encode<Value>(type, make_list({1.5, int64_t(3), int64_t(4)}));
+        assert(!value_as<market::Level>(WireFrame(type, bytes).root()));
+        bytes = encode<Value>(type, make_dict({{"price", 1.5}, {"size", int64_t(3)}}));
+        assert(!value_as<market::Level>(WireFrame(type, bytes).root()));
+    }
+}
+
+void test_typed_payload() {
+    market::Quote quote{"XCON", 1.5, 7, std::string("xnys")};
+
+    TypedPayload typed;
+    typed.args.emplace_back(1, field_writer(quote));
+    typed.set_kwarg("level", field_writer(market::Level{2.5, 9}));
+
+    for (SerializerType type : FORMATS) {
+        std::vector<uint8_t> out;
+        WireWriter writer(type, out);
+        encode_publish(writer, 3, Dict(), "market.quotes", List{"before", "after"}, Dict{{"plain", int64_t(1)}},
+                       &typed);
+
+        WireFrame frame(type, std::move(out));
+        ValueView root = frame.root();
+        assert(root.size() == 6);
+
+        ValueView args = root.at(4);
+        assert(args.size() == 3);
+        assert(args.at(0).getString() == "before");
+        assert(value_as<market::Quote>(args.at(1))->venue == "xnys");
+        assert(args.at(2).getString() == "after");
+
+        ValueView kwargs = root.at(5);
+        assert(kwargs.size() == 2);
+        assert(kwargs.get("plain").getInt64() == 1);
+        assert(value_as<market::Level>(kwargs.get("level"))->size == 9);
+    }
+}
+
+void test_struct_result() {
+    auto lookup = TypedProcedure<market::Quote(std::string)>::wrap([](std::string symbol) {
+        return market::Quote{std::move(symbol), 3.0, 10, std::nullopt};
+    });
+
+    for (SerializerType type : FORMATS) {
+        std::vector<uint8_t> request;
+        WireWriter(type, request)
+            .write_value(make_list({int64_t(68), int64_t(1), int64_t(2), make_dict({}), make_list({"XCON"})}));
+        InvocationView invocation(std::make_shared<WireFrame>(type, std::move(request)));
+
+        std::vector<uint8_t> out;
+        WireWriter writer(type, out);
+        lookup(invocation, writer);
+
+        WireFrame reply(type, std::move(out));
+        auto quote = value_as<market::Quote>(reply.root().at(3).at(0));
+        assert(quote && quote->symbol == "XCON" && quote->volume == 10);
+    }
+}
+
+int main() {
+    test_round_trip();
+    test_decode_rules();
+    test_typed_payload();
+    test_struct_result();
+    return 0;
+}
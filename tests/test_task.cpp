@@ -0,0 +1,108 @@
+#include <cassert>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "xconn_cpp/task.hpp"
+
+using namespace xconn;
+
+// Suspends the awaiting coroutine until the test resumes it, like a call waiting for its reply.
+class Deferred {
+   public:
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> awaiting) { awaiting_ = awaiting; }
+    int await_resume() const { return value_; }
+
+    bool waiting() const { return bool(awaiting_); }
+    void resume(int value) {
+        value_ = value;
+        std::exchange(awaiting_, nullptr).resume();
+    }
+
+   private:
+    std::coroutine_handle<> awaiting_;
+    int value_ = 0;
+};
+
+Task<int> constant(int value, bool& started) {
+    started = true;
+    co_return value;
+}
+
+Task<int> deferred(Deferred& reply) { co_return co_await reply; }
+
+Task<int> add(Deferred& first, Deferred& second) {
+    int a = co_await deferred(first);
+    int b = co_await deferred(second);
+    co_return a + b;
+}
+
+Task<int> failing() {
+    throw std::runtime_error("failed");
+    co_return 0;
+}
+
+Task<std::string> rethrowing() {
+    try {
+        co_await failing();
+    } catch (const std::runtime_error& e) {
+        co_return std::string("caught ") + e.what();
+    }
+    co_return "";
+}
+
+void test_lazy_start() {
+    bool started = false;
+    Task<int> task = constant(7, started);
+    assert(!started);
+
+    std::optional<int> result;
+    std::move(task).detach([&](std::optional<int> value, std::exception_ptr) { result = value; });
+    assert(started);
+    assert(result == 7);
+}
+
+void test_unstarted_task_is_destroyed() {
+    bool started = false;
+    { Task<int> task = constant(7, started); }
+    assert(!started);
+}
+
+void test_completes_after_resume() {
+    Deferred first, second;
+    std::optional<int> result;
+    add(first, second).detach([&](std::optional<int> value, std::exception_ptr) { result = value; });
+
+    // Each await leaves the task suspended with no thread involved until it is resumed.
+    assert(first.waiting() && !second.waiting() && !result);
+    first.resume(2);
+    assert(second.waiting() && !result);
+    second.resume(3);
+    assert(result == 5);
+}
+
+void test_exceptions() {
+    std::exception_ptr error;
+    bool has_value = true;
+    failing().detach([&](std::optional<int> value, std::exception_ptr e) {
+        has_value = value.has_value();
+        error = e;
+    });
+    assert(!has_value && error);
+
+    std::optional<std::string> result;
+    rethrowing().detach([&](std::optional<std::string> value, std::exception_ptr) { result = value; });
+    assert(result == "caught failed");
+}
+
+int main() {
+    test_lazy_start();
+    test_unstarted_task_is_destroyed();
+    test_completes_after_resume();
+    test_exceptions();
+    return 0;
+}
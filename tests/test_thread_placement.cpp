@@ -0,0 +1,85 @@
+#include <atomic>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#include "xconn_cpp/internal/thread_placement.hpp"
+#include "xconn_cpp/internal/thread_pool.hpp"
+
+using namespace xconn;
+
+void test_parse_cpu_list() {
+    assert(parse_cpu_list("") == std::vector<int>{});
+    assert(parse_cpu_list("3") == std::vector<int>{3});
+    assert((parse_cpu_list("0-3,8,10-11\n") == std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    // Malformed entries are skipped, the rest still count.
+    assert((parse_cpu_list("x,2,5-4,7-") == std::vector<int>{2}));
+}
+
+void test_numa_queries() {
+    assert(numa_node_cpus(-1).empty());
+    // No NIC behind an invalid descriptor.
+    assert(socket_numa_node(-1) == -1);
+}
+
+#ifdef __linux__
+static std::string thread_name() {
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    return name;
+}
+#endif
+
+void test_place_current_thread() {
+#ifdef __linux__
+    std::thread thread([] {
+        cpu_set_t allowed;
+        sched_getaffinity(0, sizeof(allowed), &allowed);
+        int cpu = 0;
+        while (!CPU_ISSET(cpu, &allowed)) ++cpu;
+
+        place_current_thread("placement-test-thread", {cpu}, -1);
+        assert(thread_name() == "placement-test-");
+
+        cpu_set_t pinned;
+        sched_getaffinity(0, sizeof(pinned), &pinned);
+        assert(CPU_COUNT(&pinned) == 1 && CPU_ISSET(cpu, &pinned));
+    });
+    thread.join();
+#endif
+}
+
+void test_pool_start_hook() {
+    std::atomic<int> started{0};
+    std::atomic<size_t> index_sum{0};
+    {
+        ThreadPool pool(3, [&](size_t index) {
+            index_sum += index;
+            ++started;
+#ifdef __linux__
+            place_current_thread("pool-w" + std::to_string(index), {}, -1);
+#endif
+        });
+        pool.enqueue([] {
+#ifdef __linux__
+            assert(thread_name().rfind("pool-w", 0) == 0);
+#endif
+        }).get();
+    }
+    assert(started == 3);
+    assert(index_sum == 0 + 1 + 2);
+}
+
+int main() {
+    test_parse_cpu_list();
+    test_numa_queries();
+    test_place_current_thread();
+    test_pool_start_hook();
+    return 0;
+}
@@ -0,0 +1,130 @@
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/internal/thread_pool.hpp"
+
+using namespace xconn;
+
+// Keeps the pool's only worker busy until released, so tasks pile up in their lanes.
+class Gate {
+   public:
+    void hold(ThreadPool& pool) {
+        pool.post(HandlerPriority::Normal, [this] { released_.get_future().wait(); });
+        while (pool.pending() != 0) std::this_thread::yield();
+    }
+    void release() { released_.set_value(); }
+
+   private:
+    std::promise<void> released_;
+};
+
+class Recorder {
+   public:
+    std::function<void()> task(char tag) {
+        return [this, tag] {
+            std::lock_guard<std::mutex> lock(mutex_);
+            order_ += tag;
+        };
+    }
+    std::string order() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return order_;
+    }
+
+   private:
+    std::mutex mutex_;
+    std::string order_;
+};
+
+void test_strict_lanes() {
+    Recorder recorder;
+    {
+        ThreadPool pool(1);
+        Gate gate;
+        gate.hold(pool);
+
+        pool.post(HandlerPriority::Low, recorder.task('l'));
+        pool.post(HandlerPriority::Normal, recorder.task('n'));
+        pool.post(HandlerPriority::Low, recorder.task('L'));
+        pool.post(HandlerPriority::High, recorder.task('h'));
+        pool.post(HandlerPriority::Normal, recorder.task('N'));
+        pool.post(HandlerPriority::High, recorder.task('H'));
+        assert(pool.pending() == 6);
+
+        gate.release();
+    }
+    // Highest lane first, arrival order within a lane; the destructor drains every lane.
+    assert(recorder.order() == "hHnNlL");
+}
+
+void test_weighted_lanes() {
+    Recorder recorder;
+    {
+        PoolLanes lanes;
+        lanes.scheduling = LaneScheduling::Weighted;
+        lanes.weights = {2, 1, 1};
+        ThreadPool pool(1, nullptr, lanes);
+        Gate gate;
+        gate.hold(pool);
+
+        for (int i = 0; i < 4; ++i) pool.post(HandlerPriority::High, recorder.task('h'));
+        for (int i = 0; i < 2; ++i) pool.post(HandlerPriority::Normal, recorder.task('n'));
+        for (int i = 0; i < 2; ++i) pool.post(HandlerPriority::Low, recorder.task('l'));
+
+        gate.release();
+    }
+    // Turns of two High, one Normal and one Low. The gate used up the first Normal credit.
+    assert(recorder.order() == "hhlhhnln");
+}
+
+void test_dedicated_high_workers() {
+    PoolLanes lanes;
+    lanes.high_priority_workers = 1;
+    ThreadPool pool(1, nullptr, lanes);
+
+    // With the only general worker stuck, High work still runs and lower lanes wait.
+    Gate gate;
+    gate.hold(pool);
+
+    std::atomic<bool> low_ran{false};
+    pool.post(HandlerPriority::Low, [&] { low_ran = true; });
+    std::promise<void> high_ran;
+    pool.post(HandlerPriority::High, [&] { high_ran.set_value(); });
+
+    assert(high_ran.get_future().wait_for(std::chrono::seconds(5)) == std::future_status::ready);
+    assert(!low_ran);
+
+    gate.release();
+    while (!low_ran) std::this_thread::yield();
+}
+
+void test_throwing_task_keeps_worker() {
+    ThreadPool pool(1);
+    pool.post(HandlerPriority::Normal, [] { throw std::runtime_error("handler failed"); });
+    pool.post(HandlerPriority::Normal, [] { throw 42; });
+
+    // The only worker survives both and runs what comes next.
+    auto future = pool.enqueue([] { return 7; });
+    assert(future.get() == 7);
+}
+
+void test_enqueue_future() {
+    ThreadPool pool(2);
+    auto future = pool.enqueue([](int a, int b) { return a + b; }, 2, 3);
+    assert(future.get() == 5);
+}
+
+int main() {
+    test_strict_lanes();
+    test_weighted_lanes();
+    test_dedicated_high_workers();
+    test_throwing_task_keeps_worker();
+    test_enqueue_future();
+    return 0;
+}
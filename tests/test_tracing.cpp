@@ -0,0 +1,86 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "xconn_cpp/tracing.hpp"
+
+using namespace xconn;
+
+void test_drain_in_order() {
+    RingBufferTraceSink sink(8);
+    assert(sink.drain().empty());
+
+    for (uint64_t i = 0; i < 5; ++i) sink.record(TraceEvent{i, 100 + i, TraceStage::CallWritten});
+
+    auto events = sink.drain();
+    assert(events.size() == 5);
+    for (uint64_t i = 0; i < 5; ++i) {
+        assert(events[i].request_id == i);
+        assert(events[i].timestamp_ns == 100 + i);
+        assert(events[i].stage == TraceStage::CallWritten);
+    }
+
+    // Drained events are not handed out twice.
+    assert(sink.drain().empty());
+    assert(sink.dropped() == 0);
+}
+
+void test_overwrites_oldest() {
+    RingBufferTraceSink sink(5);  // rounded up to 8
+
+    for (uint64_t i = 0; i < 20; ++i) sink.record(TraceEvent{i, i, TraceStage::HandlerStarted});
+
+    auto events = sink.drain();
+    assert(events.size() == 8);
+    assert(events.front().request_id == 12);
+    assert(events.back().request_id == 19);
+    assert(sink.dropped() == 12);
+}
+
+void test_concurrent_producers() {
+    RingBufferTraceSink sink(1 << 10);
+    constexpr int THREADS = 4;
+    constexpr uint64_t PER_THREAD = 20000;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < THREADS; ++t) {
+        threads.emplace_back([&sink, t] {
+            for (uint64_t i = 0; i < PER_THREAD; ++i) {
+                sink.record(TraceEvent{uint64_t(t) << 32 | i, trace_now_ns(), TraceStage::YieldWritten});
+            }
+        });
+    }
+
+    uint64_t drained = 0;
+    std::vector<uint64_t> last(THREADS, 0);
+    auto consume = [&] {
+        for (const TraceEvent& event : sink.drain()) {
+            // Events of one producer come out in the order it recorded them.
+            uint64_t producer = event.request_id >> 32;
+            uint64_t index = (event.request_id & 0xffffffff) + 1;
+            assert(index > last[producer]);
+            last[producer] = index;
+            ++drained;
+        }
+    };
+    for (int i = 0; i < 100; ++i) consume();
+    for (auto& thread : threads) thread.join();
+    consume();
+
+    assert(drained + sink.dropped() == THREADS * PER_THREAD);
+}
+
+void test_stage_names() {
+    assert(std::string(trace_stage_name(TraceStage::CallStarted)) == "call_started");
+    assert(std::string(trace_stage_name(TraceStage::YieldWritten)) == "yield_written");
+}
+
+int main() {
+    test_drain_in_order();
+    test_overwrites_oldest();
+    test_concurrent_producers();
+    test_stage_names();
+    return 0;
+}
@@ -0,0 +1,179 @@
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "xconn_cpp/internal/encode_buffer.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/typed_handler.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+using namespace xconn;
+
+static const SerializerType FORMATS[] = {SerializerType::JSON, SerializerType::MSGPACK, SerializerType::CBOR};
+
+static std::shared_ptr<const WireFrame> encode(SerializerType type, const Value& message) {
+    std::vector<uint8_t> out;
+    WireWriter(type, out).write_value(message);
+    return std::make_shared<WireFrame>(type, std::move(out));
+}
+
+// Runs `handler` on [INVOCATION, 7, 1, {}, args] and returns the decoded reply.
+static Value invoke(SerializerType type, const RawProcedureHandler& handler, const Value& args) {
+    InvocationView invocation(encode(type, make_list({int64_t(68), int64_t(7), int64_t(1), make_dict({}), args})));
+
+    std::vector<uint8_t> out;
+    WireWriter writer(type, out);
+    handler(invocation, writer);
+    return WireFrame(type, std::move(out)).root().toValue();
+}
+
+static const List& list_of(const Value& value) { return *value.getList(); }
+
+void test_typed_procedure() {
+    auto sum = TypedProcedure<int64_t(int64_t, int64_t)>::wrap([](int64_t a, int64_t b) { return a + b; });
+
+    for (SerializerType type : FORMATS) {
+        Value reply = invoke(type, sum, make_list({int64_t(2), int64_t(-5)}));
+        const List& fields = list_of(reply);
+        assert(fields.size() == 4);
+        assert(fields[0].getInt64() == int64_t(WAMP_MESSAGE_YIELD));
+        assert(fields[1].getInt64() == int64_t(7));
+        assert(list_of(fields[3]).size() == 1);
+        assert(list_of(fields[3])[0].getInt64() == -3);
+    }
+}
+
+void test_nested_request_in_typed_procedure() {
+    for (SerializerType type : FORMATS) {
+        // The handler encodes a PUBLISH of its own, the way Session::Publish() does, while the
+        // session holds the buffer the YIELD goes into.
+        std::vector<uint8_t> published;
+        auto relay = TypedProcedure<int64_t(int64_t)>::wrap([&](int64_t value) {
+            EncodeBuffer lease;
+            WireWriter(type, lease.bytes()).write_value(make_list({int64_t(16), int64_t(3), make_dict({}), "audit"}));
+            published = lease.bytes();
+            return value + 1;
+        });
+
+        InvocationView invocation(encode(type, make_list({int64_t(68), int64_t(7), int64_t(1), make_dict({}),
+                                                          make_list({int64_t(41)})})));
+        EncodeBuffer reply;
+        WireWriter writer(type, reply.bytes());
+        relay(invocation, writer);
+
+        const List& fields = list_of(WireFrame(type, reply.bytes()).root().toValue());
+        assert(fields.size() == 4);
+        assert(fields[0].getInt64() == int64_t(WAMP_MESSAGE_YIELD));
+        assert(list_of(fields[3])[0].getInt64() == 42);
+
+        const List& publish = list_of(WireFrame(type, std::move(published)).root().toValue());
+        assert(publish[0].getInt64() == int64_t(16) && publish.size() == 4);
+    }
+}
+
+void test_argument_mismatch() {
+    auto sum = TypedProcedure<int64_t(int64_t, int64_t)>::wrap([](int64_t a, int64_t b) { return a + b; });
+
+    auto expect_invalid = [&](SerializerType type, const Value& args, const std::string& message) {
+        Value reply = invoke(type, sum, args);
+        const List& fields = list_of(reply);
+        assert(fields[0].getInt64() == int64_t(WAMP_MESSAGE_ERROR));
+        assert(fields[1].getInt64() == int64_t(WAMP_MESSAGE_INVOCATION));
+        assert(fields[2].getInt64() == int64_t(7));
+        assert(fields[4].getString() == ERROR_INVALID_ARGUMENT);
+        assert(list_of(fields[5])[0].getString() == message);
+    };
+
+    for (SerializerType type : FORMATS) {
+        expect_invalid(type, make_list({int64_t(1), "two"}), "argument 2: expected integer");
+        expect_invalid(type, make_list({int64_t(1)}), "missing argument 2, expected integer");
+        expect_invalid(type, make_list({int64_t(1), int64_t(2), int64_t(3)}), "expected at most 2 arguments, got 3");
+    }
+}
+
+void test_conversions() {
+    auto describe = TypedProcedure<std::tuple<std::string, double, bool>(
+        std::string_view, double, std::vector<int32_t>, std::optional<bool>)>::wrap([](std::string_view name,
+                                                                                      double scale,
+                                                                                      std::vector<int32_t> values,
+                                                                                      std::optional<bool> flag) {
+        double total = 0;
+        for (int32_t value : values) total += value;
+        return std::make_tuple(std::string(name), total * scale, flag.value_or(false));
+    });
+
+    for (SerializerType type : FORMATS) {
+        // Integers are accepted for double parameters and a trailing optional may be left out.
+        Value reply =
+            invoke(type, describe, make_list({"xconn", int64_t(2), make_list({int64_t(1), int64_t(2), int64_t(3)})}));
+        const List& fields = list_of(reply);
+        assert(fields[0].getInt64() == int64_t(WAMP_MESSAGE_YIELD));
+        const List& results = list_of(fields[3]);
+        assert(results.size() == 3);
+        assert(results[0].getString() == "xconn");
+        assert(results[1].getDouble() == 12.0);
+        assert(results[2].getBool() == false);
+
+        // Out of range for int32_t.
+        Value rejected = invoke(type, describe, make_list({"xconn", 1.5, make_list({int64_t(1) << 40}), true}));
+        const List& error = list_of(rejected);
+        assert(error[0].getInt64() == int64_t(WAMP_MESSAGE_ERROR));
+        assert(list_of(error[5])[0].getString() == "argument 3: expected list");
+    }
+}
+
+void test_void_procedure() {
+    int64_t seen = 0;
+    auto store = TypedProcedure<void(int64_t)>::wrap([&](int64_t value) { seen = value; });
+
+    for (SerializerType type : FORMATS) {
+        Value reply = invoke(type, store, make_list({int64_t(42)}));
+        const List& fields = list_of(reply);
+        assert(fields[0].getInt64() == int64_t(WAMP_MESSAGE_YIELD));
+        assert(seen == 42);
+    }
+}
+
+void test_typed_event() {
+    std::string topic;
+    double price = 0;
+    auto handler = typed_event_handler<std::string, double>([&](std::string name, double value) {
+        topic = std::move(name);
+        price = value;
+    });
+
+    for (SerializerType type : FORMATS) {
+        EventView event(encode(type, make_list({int64_t(36), int64_t(3), int64_t(4), make_dict({}),
+                                                make_list({"ticks", 9.5})})));
+        handler(event);
+        assert(topic == "ticks");
+        assert(price == 9.5);
+
+        EventView mismatched(
+            encode(type, make_list({int64_t(36), int64_t(3), int64_t(4), make_dict({}), make_list({int64_t(1)})})));
+        bool threw = false;
+        try {
+            handler(mismatched);
+        } catch (const std::invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+}
+
+int main() {
+    test_typed_procedure();
+    test_nested_request_in_typed_procedure();
+    test_argument_mismatch();
+    test_conversions();
+    test_void_procedure();
+    test_typed_event();
+    return 0;
+}
@@ -0,0 +1,273 @@
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/arena.hpp"
+#include "xconn_cpp/compact_value.hpp"
+#include "xconn_cpp/expected.hpp"
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/internal/wire_frame.hpp"
+#include "xconn_cpp/types.hpp"
+#include "xconn_cpp/value_view.hpp"
+
+using namespace xconn;
+
+static const SerializerType FORMATS[] = {SerializerType::JSON, SerializerType::MSGPACK, SerializerType::CBOR};
+
+static std::shared_ptr<const WireFrame> encode(SerializerType type, const Value& message) {
+    std::vector<uint8_t> out;
+    WireWriter writer(type, out);
+    writer.write_value(message);
+    return std::make_shared<WireFrame>(type, std::move(out));
+}
+
+static std::shared_ptr<const WireFrame> raw(SerializerType type, std::vector<uint8_t> bytes) {
+    return std::make_shared<WireFrame>(type, std::move(bytes));
+}
+
+static std::shared_ptr<const WireFrame> json(const std::string& text) {
+    return raw(SerializerType::JSON, std::vector<uint8_t>(text.begin(), text.end()));
+}
+
+void test_invocation_view() {
+    for (SerializerType type : FORMATS) {
+        auto frame = encode(type, make_list({int64_t(68), int64_t(7), int64_t(99), make_dict({{"caller", int64_t(5)}}),
+                                             make_list({"hello", int64_t(-3), 2.5, true, Bytes{1, 2, 3}, Value()}),
+                                             make_dict({{"name", "xconn"}, {"nested", make_list({int64_t(1)})}})}));
+        assert(wire_message_type(*frame) == WAMP_MESSAGE_INVOCATION);
+
+        InvocationView invocation(frame);
+        assert(invocation.request_id == 7);
+        assert(invocation.registration_id == 99);
+        assert(invocation.details().get("caller").getInt64() == 5);
+
+        assert(invocation.args().size() == 6);
+        assert(invocation.argString(0) == "hello");
+        assert(invocation.argInt64(1) == -3);
+        assert(invocation.argDouble(2) == 2.5);
+        assert(invocation.argBool(3) == true);
+        auto bytes = invocation.argBytes(4);
+        assert(bytes && std::vector<uint8_t>(bytes->begin(), bytes->end()) == (Bytes{1, 2, 3}));
+        assert(invocation.arg(5).isNull());
+        assert(!invocation.arg(6).isValid());
+        assert(!invocation.argString(1));
+
+        assert(invocation.kwargString("name") == "xconn");
+        assert(invocation.kwarg("nested").at(0).getInt64() == 1);
+        assert(!invocation.kwarg("missing").isValid());
+
+        Invocation eager = invocation.toInvocation();
+        assert(eager.args.size() == 6);
+        assert(eager.args[0].getString() == "hello");
+        assert(eager.kwargs.getString("name") == "xconn");
+        assert(eager.details.get("caller")->getInt64() == 5);
+    }
+}
+
+void test_event_and_result_views() {
+    for (SerializerType type : FORMATS) {
+        EventView event(encode(type, make_list({int64_t(36), int64_t(11), int64_t(12), make_dict({}),
+                                                make_list({"payload"})})));
+        assert(event.subscription_id == 11);
+        assert(event.publication_id == 12);
+        assert(event.argString(0) == "payload");
+        assert(event.kwargs().size() == 0);
+        assert(event.toEvent().argString(0) == "payload");
+
+        ResultView result(encode(type, make_list({int64_t(50), int64_t(3), make_dict({})})));
+        assert(result.request_id == 3);
+        assert(!result.args().isValid());
+        assert(result.toResult().args.empty());
+    }
+}
+
+void test_malformed_message() {
+    for (SerializerType type : FORMATS) {
+        bool thrown = false;
+        try {
+            InvocationView invocation(encode(type, make_list({int64_t(68), "not-an-id"})));
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    // Truncated input never reads past the buffer.
+    auto frame = raw(SerializerType::CBOR, {0x83, 0x18, 0x32, 0x7a, 0x00, 0x00, 0xff, 0xff});
+    assert(frame->root().at(2).kind() == ValueKind::Invalid);
+    assert(frame->root().size() == 3);
+    assert(!frame->root().at(1).getString());
+}
+
+// `levels` single-element lists around the integer 1.
+static std::shared_ptr<const WireFrame> nested(SerializerType type, size_t levels) {
+    if (type == SerializerType::JSON) return json(std::string(levels, '[') + "1" + std::string(levels, ']'));
+    std::vector<uint8_t> bytes(levels, type == SerializerType::CBOR ? 0x81 : 0x91);
+    bytes.push_back(0x01);
+    return raw(type, std::move(bytes));
+}
+
+// Lists above the innermost value, and whether that value is the 1 at the bottom.
+static size_t depth_of(Value value, bool& complete) {
+    size_t levels = 0;
+    while (auto list = value.getList()) {
+        ++levels;
+        if (list->empty()) break;
+        Value inner = (*list)[0];
+        value = std::move(inner);
+    }
+    complete = value.getInt64() == 1;
+    return levels;
+}
+
+void test_nesting_depth_limit() {
+    for (SerializerType type : FORMATS) {
+        bool complete = false;
+        assert(depth_of(nested(type, 100)->root().toValue(), complete) == 100 && complete);
+
+        // Far past the limit: decoding stops at it instead of exhausting the stack.
+        auto deep = nested(type, 20000);
+        size_t levels = depth_of(deep->root().toValue(), complete);
+        assert(levels > 100 && levels <= 130 && !complete);
+
+        Arena arena;
+        CompactValue compact = deep->root().toCompact(arena);
+        size_t compact_levels = 0;
+        for (const CompactValue* value = &compact; value && value->getList(); value = value->at(0)) ++compact_levels;
+        assert(compact_levels > 100 && compact_levels <= 130);
+    }
+}
+
+void test_json_syntax() {
+    auto frame = json(" [ 50 , 1 , { } , [ \"a\\\"b\\u00e9\\ud83d\\ude00\" , -1.5e2 , 18446744073709551615 ] , "
+                      "{ \"k\\/ey\" : [ [ ] , { \"x\" : \"]}\" } ] } ] ");
+    ResultView result(frame);
+    assert(result.request_id == 1);
+    assert(result.argString(0) == "a\"b\xc3\xa9\xf0\x9f\x98\x80");
+    assert(result.argDouble(1) == -150.0);
+    assert(result.argUInt64(2) == UINT64_MAX);
+    assert(!result.argInt64(2));
+
+    ValueView value = result.kwarg("k/ey");
+    assert(value.size() == 2);
+    assert(value.at(0).size() == 0);
+    assert(value.at(1).get("x").getString() == "]}");
+}
+
+void test_cbor_encodings() {
+    // Indefinite length array and map, half precision float, tagged integer.
+    auto frame = raw(SerializerType::CBOR, {0x9f, 0x18, 0x32, 0x01, 0xa0, 0x9f, 0xf9, 0x3e, 0x00, 0xc1, 0x1a, 0x00, 0x01,
+                                            0x00, 0x00, 0xff, 0xbf, 0x61, 'k', 0xf4, 0xff, 0xff});
+    ResultView result(frame);
+    assert(result.request_id == 1);
+    assert(result.args().size() == 2);
+    assert(result.argDouble(0) == 1.5);
+    assert(result.argInt64(1) == 65536);
+    assert(result.kwargBool("k") == false);
+    assert(result.kwargs().size() == 1);
+}
+
+void test_msgpack_encodings() {
+    // int8, uint16, int32, float32, str8 and a map16.
+    auto frame = raw(SerializerType::MSGPACK, {0x95, 0x32, 0x01, 0x80, 0x94, 0xd0, 0x80, 0xcd, 0x01, 0x00, 0xd2, 0xff,
+                                               0xff, 0xff, 0xfe, 0xca, 0x3f, 0xc0, 0x00, 0x00, 0xde, 0x00, 0x01, 0xd9,
+                                               0x01, 'k', 0xc3});
+    ResultView result(frame);
+    assert(result.argInt64(0) == -128);
+    assert(result.argInt64(1) == 256);
+    assert(result.argInt64(2) == -2);
+    assert(result.argDouble(3) == 1.5);
+    assert(result.kwargBool("k") == true);
+}
+
+void test_passthru() {
+    Bytes payload{0x0a, 0x03, 'x', 'y', 'z', 0x00, 0xff};
+
+    for (SerializerType type : FORMATS) {
+        auto frame = encode(type, make_list({int64_t(36), int64_t(3), int64_t(4),
+                                             make_dict({{"ppt_scheme", "x_protobuf"}, {"ppt_serializer", "native"}}),
+                                             make_list({payload})}));
+        EventView event(frame);
+
+        auto passthru = event.passThru();
+        assert(passthru);
+        assert(passthru->scheme == "x_protobuf");
+        assert(passthru->serializer == "native");
+        assert(Bytes(passthru->payload.begin(), passthru->payload.end()) == payload);
+
+        // Binary formats hand out the payload in place.
+        if (type != SerializerType::JSON) {
+            assert(passthru->payload.data() >= frame->begin() && passthru->payload.data() < frame->end());
+        }
+
+        auto plain =
+            encode(type, make_list({int64_t(36), int64_t(3), int64_t(4), make_dict({}), make_list({payload})}));
+        assert(!EventView(plain).passThru());
+    }
+
+    Result result = passthru_result("x_flatbuffers", payload);
+    assert(result.details.at("ppt_scheme").getString() == "x_flatbuffers");
+    assert(result.details.at("ppt_serializer").getString() == PPT_SERIALIZER_NATIVE);
+    assert(result.args.size() == 1 && result.args[0].getBytes() == payload);
+}
+
+void test_error_view() {
+    for (SerializerType type : FORMATS) {
+        auto frame = encode(type, make_list({int64_t(8), int64_t(48), int64_t(9), make_dict({}),
+                                             "wamp.error.no_such_procedure", make_list({"missing"}),
+                                             make_dict({{"procedure", "foo.bar"}})}));
+        ErrorView error(frame);
+        assert(error.request_type == 48);
+        assert(error.request_id == 9);
+        assert(error.uri == "wamp.error.no_such_procedure");
+
+        ApplicationError converted = error.toError();
+        assert(converted.uri() == "wamp.error.no_such_procedure");
+        assert(converted.list().size() == 1 && converted.list()[0].getString() == "missing");
+        assert(converted.dict().at("procedure").getString() == "foo.bar");
+
+        // Arguments are optional on the wire.
+        auto bare = encode(type, make_list({int64_t(8), int64_t(48), int64_t(10), make_dict({}), "app.error"}));
+        ApplicationError plain = ErrorView(bare).toError();
+        assert(plain.uri() == "app.error" && plain.list().empty() && plain.dict().empty());
+
+        bool thrown = false;
+        try {
+            ErrorView(encode(type, make_list({int64_t(8), int64_t(48), int64_t(10), make_dict({})})));
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+
+    Expected<int64_t, ApplicationError> value = int64_t(5);
+    assert(value && *value == 5 && value.value_or(0) == 5);
+
+    Expected<int64_t, ApplicationError> failed = Unexpected(ApplicationError("app.error"));
+    assert(!failed.has_value() && failed.value_or(7) == 7);
+    assert(failed.error().uri() == "app.error");
+
+    // value() on an error throws the same exception with or without std::expected.
+    bool thrown = false;
+    try {
+        failed.value();
+    } catch (const BadExpectedAccess<ApplicationError>& e) {
+        thrown = e.error().uri() == "app.error";
+    }
+    assert(thrown);
+}
+
+int main() {
+    test_invocation_view();
+    test_event_and_result_views();
+    test_malformed_message();
+    test_nesting_depth_limit();
+    test_json_syntax();
+    test_cbor_encodings();
+    test_msgpack_encodings();
+    test_passthru();
+    test_error_view();
+    return 0;
+}
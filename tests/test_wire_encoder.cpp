@@ -0,0 +1,125 @@
+#include <cassert>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "xconn_cpp/internal/wire_encoder.hpp"
+#include "xconn_cpp/types.hpp"
+
+using namespace xconn;
+
+static std::vector<uint8_t> encode(SerializerType type, const Value& value) {
+    std::vector<uint8_t> out;
+    WireWriter writer(type, out);
+    writer.write_value(value);
+    return out;
+}
+
+static std::string encode_json(const Value& value) {
+    auto out = encode(SerializerType::JSON, value);
+    return std::string(out.begin(), out.end());
+}
+
+void test_cbor_scalars() {
+    assert(encode(SerializerType::CBOR, Value()) == std::vector<uint8_t>({0xf6}));
+    assert(encode(SerializerType::CBOR, true) == std::vector<uint8_t>({0xf5}));
+    assert(encode(SerializerType::CBOR, int64_t(10)) == std::vector<uint8_t>({0x0a}));
+    assert(encode(SerializerType::CBOR, int64_t(500)) == std::vector<uint8_t>({0x19, 0x01, 0xf4}));
+    assert(encode(SerializerType::CBOR, int64_t(-1)) == std::vector<uint8_t>({0x20}));
+    assert(encode(SerializerType::CBOR, int64_t(-1000)) == std::vector<uint8_t>({0x39, 0x03, 0xe7}));
+    assert(encode(SerializerType::CBOR, 1.5) ==
+           std::vector<uint8_t>({0xfb, 0x3f, 0xf8, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}));
+    assert(encode(SerializerType::CBOR, "abc") == std::vector<uint8_t>({0x63, 'a', 'b', 'c'}));
+    assert(encode(SerializerType::CBOR, Bytes{1, 2}) == std::vector<uint8_t>({0x42, 1, 2}));
+}
+
+void test_msgpack_scalars() {
+    assert(encode(SerializerType::MSGPACK, Value()) == std::vector<uint8_t>({0xc0}));
+    assert(encode(SerializerType::MSGPACK, false) == std::vector<uint8_t>({0xc2}));
+    assert(encode(SerializerType::MSGPACK, int64_t(127)) == std::vector<uint8_t>({0x7f}));
+    assert(encode(SerializerType::MSGPACK, int64_t(300)) == std::vector<uint8_t>({0xcd, 0x01, 0x2c}));
+    assert(encode(SerializerType::MSGPACK, int64_t(-5)) == std::vector<uint8_t>({0xfb}));
+    assert(encode(SerializerType::MSGPACK, int64_t(-200)) == std::vector<uint8_t>({0xd1, 0xff, 0x38}));
+    assert(encode(SerializerType::MSGPACK, uint64_t(1) << 40) ==
+           std::vector<uint8_t>({0xcf, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00}));
+    assert(encode(SerializerType::MSGPACK, "hi") == std::vector<uint8_t>({0xa2, 'h', 'i'}));
+    assert(encode(SerializerType::MSGPACK, Bytes{7}) == std::vector<uint8_t>({0xc4, 0x01, 7}));
+}
+
+void test_json_scalars() {
+    assert(encode_json(Value()) == "null");
+    assert(encode_json(int64_t(-42)) == "-42");
+    assert(encode_json(2.0) == "2.0");
+    assert(encode_json(0.25) == "0.25");
+    assert(encode_json("a\"b\\c\n\x01") == "\"a\\\"b\\\\c\\n\\u0001\"");
+    assert(encode_json(Bytes{'h', 'i', '!'}) == "\"\\u0000aGkh\"");
+    assert(encode_json(Bytes{'h', 'i'}) == "\"\\u0000aGk=\"");
+    assert(encode_json(make_list({1, "x", make_dict({{"k", true}})})) == "[1,\"x\",{\"k\":true}]");
+}
+
+void test_call_message() {
+    std::vector<uint8_t> out;
+    WireWriter cbor(SerializerType::CBOR, out);
+    encode_call(cbor, 1, Dict(), "a.b", List{1, "x"}, Dict());
+    assert(out == std::vector<uint8_t>({0x85, 0x18, 0x30, 0x01, 0xa0, 0x63, 'a', '.', 'b', 0x82, 0x01, 0x61, 'x'}));
+
+    out.clear();
+    WireWriter msgpack(SerializerType::MSGPACK, out);
+    encode_call(msgpack, 1, Dict(), "a.b", List{1, "x"}, Dict());
+    assert(out == std::vector<uint8_t>({0x95, 0x30, 0x01, 0x80, 0xa3, 'a', '.', 'b', 0x92, 0x01, 0xa1, 'x'}));
+
+    out.clear();
+    WireWriter json(SerializerType::JSON, out);
+    encode_call(json, 1, Dict(), "a.b", List{1, "x"}, Dict());
+    assert(std::string(out.begin(), out.end()) == "[48,1,{},\"a.b\",[1,\"x\"]]");
+}
+
+void test_payload_omission() {
+    std::vector<uint8_t> out;
+    WireWriter json(SerializerType::JSON, out);
+
+    encode_yield(json, 5, Dict(), List(), Dict());
+    assert(std::string(out.begin(), out.end()) == "[70,5,{}]");
+
+    out.clear();
+    encode_publish(json, 7, Dict{{"acknowledge", true}}, "t", List(), Dict{{"age", 25}});
+    assert(std::string(out.begin(), out.end()) == "[16,7,{\"acknowledge\":true},\"t\",[],{\"age\":25}]");
+
+    out.clear();
+    encode_error(json, 68, 9, Dict(), "wamp.error.runtime_error", List{"boom"}, Dict());
+    assert(std::string(out.begin(), out.end()) == "[8,68,9,{},\"wamp.error.runtime_error\",[\"boom\"]]");
+}
+
+void test_prepared_message() {
+    Dict options{{"acknowledge", true}, {"exclude_me", false}};
+    List args{1, "x"};
+    Dict kwargs{{"k", 2.5}};
+
+    for (SerializerType type : {SerializerType::JSON, SerializerType::MSGPACK, SerializerType::CBOR}) {
+        std::vector<uint8_t> constant = encode_constant_fields(type, options, "a.b");
+
+        std::vector<uint8_t> expected, out;
+        WireWriter expected_writer(type, expected), writer(type, out);
+
+        encode_publish(expected_writer, 300, options, "a.b", args, kwargs);
+        encode_prepared(writer, WAMP_MESSAGE_PUBLISH, 300, constant, args, kwargs);
+        assert(out == expected);
+
+        expected.clear();
+        out.clear();
+        encode_call(expected_writer, 1, options, "a.b", List(), Dict());
+        encode_prepared(writer, WAMP_MESSAGE_CALL, 1, constant, List(), Dict());
+        assert(out == expected);
+    }
+}
+
+int main() {
+    test_cbor_scalars();
+    test_msgpack_scalars();
+    test_json_scalars();
+    test_call_message();
+    test_payload_omission();
+    test_prepared_message();
+
+    return 0;
+}